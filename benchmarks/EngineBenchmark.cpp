@@ -0,0 +1,412 @@
+/*
+ * Engine benchmarks : drives the Engine directly (no widgets) on synthetic scores
+ * and prints one JSON object per measure, to compare performances between versions.
+ *
+ * usage : i-score-benchmark [--boxes N] [--duration ms] [--output file] [--jamoma path]
+ *
+ * Each line looks like :
+ * {"benchmark": "addBox", "count": 1000, "total_ms": 12.3, "per_op_us": 12.3}
+ * or, for a value measured during a benchmark (a count, a delay) :
+ * {"metric": "outputQueueMaxDepth", "value": 12, "unit": "messages"}
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QUdpSocket>
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "Engine.h"
+
+// The local OSC sink receiving the messages sent during playback
+static const unsigned int SINK_PORT = 13590;
+static const std::string SINK_DEVICE = "benchmark";
+
+// How long (in ms) before their date the bundles are sent to the sink in the lookahead measure
+static const unsigned int LOOKAHEAD = 20;
+
+// The messages by second the sink accepts, and how long its curve samples are coalesced, in the budget measure
+static const unsigned int SINK_BUDGET = 1000;
+static const unsigned int SINK_TICK = 10;
+
+static void triggerPointIsActiveCallback(ConditionedTimeBoxId, bool) {}
+static void boxIsRunningCallback(TimeBoxId, bool) {}
+static void transportCallback(TTSymbol &, const TTValue &) {}
+static void deviceCallback(TTSymbol &) {}
+static void deviceConnectionErrorCallback(TTSymbol &deviceName, TTSymbol &errorInfo)
+{
+  std::cerr << "Can't connect to " << deviceName.c_str() << " : " << errorInfo.c_str() << std::endl;
+}
+
+class BenchmarkReport
+{
+  public:
+    BenchmarkReport(QTextStream &stream) : _stream(stream) {}
+
+    void
+    add(const QString &name, unsigned int count, qint64 elapsedNs)
+    {
+      double totalMs = elapsedNs / 1e6;
+      double perOpUs = count ? elapsedNs / 1e3 / count : 0.;
+
+      _stream << QString("{\"benchmark\": \"%1\", \"count\": %2, \"total_ms\": %3, \"per_op_us\": %4}")
+                 .arg(name).arg(count).arg(totalMs, 0, 'f', 3).arg(perOpUs, 0, 'f', 3) << endl;
+    }
+
+    void
+    addRate(const QString &name, unsigned int count, qint64 elapsedNs)
+    {
+      double perSecond = elapsedNs ? count * 1e9 / elapsedNs : 0.;
+
+      _stream << QString("{\"benchmark\": \"%1\", \"count\": %2, \"total_ms\": %3, \"per_second\": %4}")
+                 .arg(name).arg(count).arg(elapsedNs / 1e6, 0, 'f', 3).arg(perSecond, 0, 'f', 1) << endl;
+    }
+
+    void
+    addMetric(const QString &name, double value, const QString &unit)
+    {
+      _stream << QString("{\"metric\": \"%1\", \"value\": %2, \"unit\": \"%3\"}")
+                 .arg(name).arg(value, 0, 'f', 3).arg(unit) << endl;
+    }
+
+  private:
+    QTextStream &_stream;
+};
+
+static std::string
+sinkAddress(unsigned int i)
+{
+  return SINK_DEVICE + "/value." + std::to_string(i);
+}
+
+int
+main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("i-score-benchmark");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Benchmarks of the i-score Engine editing and execution functions.");
+  parser.addHelpOption();
+  QCommandLineOption boxesOption("boxes", "Number of boxes of the synthetic score.", "N", "500");
+  QCommandLineOption durationOption("duration", "Duration (in ms) of the playback measure.", "ms", "5000");
+  QCommandLineOption outputOption("output", "Write the results into a file instead of the standard output.", "file");
+  QCommandLineOption jamomaOption("jamoma", "The folder where the jamoma framework is.", "path");
+  parser.addOption(boxesOption);
+  parser.addOption(durationOption);
+  parser.addOption(outputOption);
+  parser.addOption(jamomaOption);
+  parser.process(app);
+
+  bool boxesOk = false, durationOk = false;
+  const unsigned int nbBoxes = parser.value(boxesOption).toUInt(&boxesOk);
+  const unsigned int playDuration = parser.value(durationOption).toUInt(&durationOk);
+  if (!boxesOk || nbBoxes == 0) {
+      std::cerr << "--boxes expects a number of boxes greater than 0" << std::endl;
+      return 1;
+    }
+  if (!durationOk) {
+      std::cerr << "--duration expects a duration in ms" << std::endl;
+      return 1;
+    }
+
+  QFile outputFile;
+  QTextStream stream(stdout);
+  if (parser.isSet(outputOption)) {
+      outputFile.setFileName(parser.value(outputOption));
+      if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+          std::cerr << "Can't open " << outputFile.fileName().toStdString() << std::endl;
+          return 1;
+        }
+      stream.setDevice(&outputFile);
+    }
+  BenchmarkReport report(stream);
+
+  QString jamomaFolder = parser.value(jamomaOption);
+  if (jamomaFolder.isEmpty()) {
+      jamomaFolder = QCoreApplication::applicationDirPath() + "/../Frameworks/jamoma";
+      if (!QDir(jamomaFolder).exists())
+        jamomaFolder = "";
+    }
+
+  Engine *engine = new Engine(&triggerPointIsActiveCallback, &boxIsRunningCallback, &transportCallback,
+                              &deviceCallback, &deviceConnectionErrorCallback, NULL, jamomaFolder.toStdString());
+
+  // Local OSC sink
+  QUdpSocket sink;
+  sink.bind(QHostAddress::LocalHost, SINK_PORT);
+  engine->addNetworkDevice(SINK_DEVICE, "OSC", "127.0.0.1", SINK_PORT);
+  for (unsigned int i = 0; i < nbBoxes; i++)
+    engine->appendToNetWorkNamespace(sinkAddress(i), "parameter", "decimal", "0", "", "0. 100.", "none", "");
+
+  QElapsedTimer timer;
+  std::vector<TimeBoxId> boxesId, movedBoxes;
+  std::vector<IntervalId> relationsId;
+  std::vector<ConditionedTimeBoxId> triggersId;
+
+  /************ addBox ************/
+  timer.start();
+  for (unsigned int i = 0; i < nbBoxes; i++)
+    boxesId.push_back(engine->addBox(i * 1000, 2000, "box" + std::to_string(i)));
+  report.add("addBox", nbBoxes, timer.nsecsElapsed());
+
+  /************ messages and curves (not measured : setup of the playback) ************/
+  for (unsigned int i = 0; i < nbBoxes; i++) {
+      engine->setCtrlPointMessagesToSend(boxesId[i], BEGIN_CONTROL_POINT_INDEX, std::vector<std::string>(1, sinkAddress(i) + " 0."));
+      engine->setCtrlPointMessagesToSend(boxesId[i], END_CONTROL_POINT_INDEX, std::vector<std::string>(1, sinkAddress(i) + " 100."));
+      engine->addCurve(boxesId[i], sinkAddress(i));
+      engine->setCurveSampleRate(boxesId[i], sinkAddress(i), 40);
+    }
+
+  /************ addTemporalRelation ************/
+  timer.start();
+  for (unsigned int i = 0; i + 1 < nbBoxes; i += 2) {
+      movedBoxes.clear();
+      IntervalId relationId = engine->addTemporalRelation(boxesId[i], END_CONTROL_POINT_INDEX, boxesId[i + 1], BEGIN_CONTROL_POINT_INDEX, movedBoxes);
+      if (relationId != NO_ID)
+        relationsId.push_back(relationId);
+    }
+  report.add("addTemporalRelation", relationsId.size(), timer.nsecsElapsed());
+
+  /************ addTriggerPoint ************/
+  timer.start();
+  for (unsigned int i = 0; i < nbBoxes; i += 10) {
+      ConditionedTimeBoxId triggerId = engine->addTriggerPoint(boxesId[i], BEGIN_CONTROL_POINT_INDEX);
+      if (triggerId != NO_ID)
+        triggersId.push_back(triggerId);
+    }
+  report.add("addTriggerPoint", triggersId.size(), timer.nsecsElapsed());
+
+  /************ performBoxEditing ************/
+  timer.start();
+  for (unsigned int i = 0; i < nbBoxes; i++) {
+      movedBoxes.clear();
+      engine->performBoxEditing(boxesId[i], i * 1000 + 100, i * 1000 + 2100, movedBoxes);
+    }
+  report.add("performBoxEditing", nbBoxes, timer.nsecsElapsed());
+
+  /************ performBoxEditing in one edit transaction ************/
+  timer.start();
+  movedBoxes.clear();
+  engine->beginEditing();
+  for (unsigned int i = 0; i < nbBoxes; i++)
+    engine->performBoxEditing(boxesId[i], i * 1000, i * 1000 + 2000, movedBoxes);
+  engine->commitEditing(movedBoxes);
+  report.add("performBoxEditing_transaction", nbBoxes, timer.nsecsElapsed());
+
+  /************ getCurveValues ************/
+  std::vector<float> values;
+  timer.start();
+  for (unsigned int i = 0; i < nbBoxes; i++) {
+      values.clear();
+      engine->getCurveValues(boxesId[i], sinkAddress(i), 0, values);
+    }
+  report.add("getCurveValues", nbBoxes, timer.nsecsElapsed());
+
+  /************ toTTAddress (without and with the address cache) ************/
+  const unsigned int nbConversions = 100 * nbBoxes;
+  std::vector<std::string> addresses;
+  for (unsigned int i = 0; i < nbBoxes; i++)
+    addresses.push_back(sinkAddress(i));
+
+  engine->setAddressCacheSize(0);
+  timer.start();
+  for (unsigned int i = 0; i < nbConversions; i++)
+    engine->toTTAddress(addresses[i % nbBoxes]);
+  report.add("toTTAddress_uncached", nbConversions, timer.nsecsElapsed());
+
+  engine->setAddressCacheSize(ADDRESS_CACHE_SIZE);
+  timer.start();
+  for (unsigned int i = 0; i < nbConversions; i++)
+    engine->toTTAddress(addresses[i % nbBoxes]);
+  report.add("toTTAddress_cached", nbConversions, timer.nsecsElapsed());
+
+  /************ toTTAddress past the cache capacity (a used set of addresses among a stream of others) ************/
+  const unsigned int nbHotAddresses = ADDRESS_CACHE_SIZE / 2;
+  const unsigned int nbColdAddresses = 4 * ADDRESS_CACHE_SIZE;
+  std::vector<std::string> hotAddresses, coldAddresses;
+  for (unsigned int i = 0; i < nbHotAddresses; i++)
+    hotAddresses.push_back(SINK_DEVICE + "/hot." + std::to_string(i));
+  for (unsigned int i = 0; i < nbColdAddresses; i++)
+    coldAddresses.push_back(SINK_DEVICE + "/cold." + std::to_string(i));
+
+  // whatever the score size, the cold stream passes several times through the cache
+  const unsigned int nbOverConversions = 100 * ADDRESS_CACHE_SIZE;
+  engine->setAddressCacheSize(ADDRESS_CACHE_SIZE);
+  timer.start();
+  for (unsigned int i = 0; i < nbOverConversions; i++) {
+      if (i % 10)
+        engine->toTTAddress(hotAddresses[i % nbHotAddresses]);
+      else
+        engine->toTTAddress(coldAddresses[(i / 10) % nbColdAddresses]);
+    }
+  report.add("toTTAddress_overCapacity", nbOverConversions, timer.nsecsElapsed());
+
+  /************ removeTriggerPoint (the stored score and the playback measures are fixed scores) ************/
+  timer.start();
+  for (unsigned int i = 0; i < triggersId.size(); i++)
+    engine->removeTriggerPoint(triggersId[i]);
+  report.add("removeTriggerPoint", triggersId.size(), timer.nsecsElapsed());
+
+  /************ store / load ************/
+  QString filePath = QDir::temp().filePath("i-score-benchmark.score");
+
+  timer.start();
+  engine->store(filePath.toStdString());
+  report.add("store", nbBoxes, timer.nsecsElapsed());
+
+  /************ compilePlaybackPlan (once the trigger points are removed, the whole score is fixed) ************/
+  TimeValue planEnd = 0;
+  timer.start();
+  unsigned int nbPlanned = engine->compilePlaybackPlan(0, planEnd);
+  report.add("compilePlaybackPlan", nbPlanned, timer.nsecsElapsed());
+
+  /************ remove all (load needs empty caches) ************/
+  timer.start();
+  for (unsigned int i = 0; i < relationsId.size(); i++)
+    engine->removeTemporalRelation(relationsId[i]);
+  report.add("removeTemporalRelation", relationsId.size(), timer.nsecsElapsed());
+
+  timer.start();
+  for (unsigned int i = 0; i < nbBoxes; i++)
+    engine->removeBox(boxesId[i]);
+  report.add("removeBox", nbBoxes, timer.nsecsElapsed());
+
+  // the playback below uses the loaded score
+  timer.start();
+  engine->load(filePath.toStdString());
+  report.add("load", nbBoxes, timer.nsecsElapsed());
+  QFile::remove(filePath);
+
+  /************ sendNetworkMessage ************/
+  const unsigned int nbMessages = 10 * nbBoxes;
+  timer.start();
+  for (unsigned int i = 0; i < nbMessages; i++)
+    engine->sendNetworkMessage(sinkAddress(i % nbBoxes) + " " + std::to_string(i % 100));
+  report.addRate("sendNetworkMessage", nbMessages, timer.nsecsElapsed());
+
+  // the same without the output threads
+  engine->setOutputQueueCapacity(0);
+  timer.start();
+  for (unsigned int i = 0; i < nbMessages; i++)
+    engine->sendNetworkMessage(sinkAddress(i % nbBoxes) + " " + std::to_string(i % 100));
+  report.addRate("sendNetworkMessageInline", nbMessages, timer.nsecsElapsed());
+  engine->setOutputQueueCapacity(OUTPUT_QUEUE_CAPACITY);
+
+  // drain what was received until now
+  QCoreApplication::processEvents();
+  while (sink.hasPendingDatagrams())
+    sink.readDatagram(nullptr, 0);
+
+  /************ playback throughput ************/
+  unsigned int nbReceived = 0;
+  engine->setTimeOffset(0);
+  engine->play();
+  timer.start();
+  while (timer.elapsed() < playDuration) {
+      sink.waitForReadyRead(10);
+      while (sink.hasPendingDatagrams()) {
+          sink.readDatagram(nullptr, 0);
+          nbReceived++;
+        }
+    }
+  qint64 elapsed = timer.nsecsElapsed();
+  engine->stop();
+  report.addRate("playbackMessages", nbReceived, elapsed);
+
+  // drain what was received until now
+  QCoreApplication::processEvents();
+  while (sink.hasPendingDatagrams())
+    sink.readDatagram(nullptr, 0);
+
+  /************ compiled playback plan throughput and lateness ************/
+  nbReceived = 0;
+  engine->playPlaybackPlan();
+  timer.start();
+  while (timer.elapsed() < playDuration && engine->isPlayingPlaybackPlan()) {
+      sink.waitForReadyRead(10);
+      while (sink.hasPendingDatagrams()) {
+          sink.readDatagram(nullptr, 0);
+          nbReceived++;
+        }
+    }
+  elapsed = timer.nsecsElapsed();
+  engine->stopPlaybackPlan();
+  report.addRate("planPlaybackMessages", nbReceived, elapsed);
+
+  // the mean and max delays of the messages
+  EnginePlanStatistics statistics = engine->getPlaybackPlanStatistics();
+  report.addMetric("planPlaybackLateness", statistics.sentMessages ? double(statistics.totalLateness) / statistics.sentMessages : 0., "us");
+  report.addMetric("planPlaybackMaxLateness", statistics.maxLateness, "us");
+
+  // the plan messages of the sink went through the OSC output queue
+  EngineOutputMetrics output = engine->getOutputMetrics()["OSC"];
+  report.addMetric("outputQueueMaxDepth", output.maxDepth, "messages");
+  report.addMetric("outputDroppedSamples", output.droppedSamples, "messages");
+  report.addMetric("outputMaxOverflowDepth", output.maxOverflowDepth, "messages");
+
+  // drain what was received until now
+  QCoreApplication::processEvents();
+  while (sink.hasPendingDatagrams())
+    sink.readDatagram(nullptr, 0);
+
+  /************ compiled playback plan with lookahead bundles ************/
+  nbReceived = 0;
+  engine->setPlaybackLookahead(LOOKAHEAD);
+  engine->setDeviceBundles(SINK_DEVICE, true);
+  engine->playPlaybackPlan();
+  timer.start();
+  while (timer.elapsed() < playDuration && engine->isPlayingPlaybackPlan()) {
+      sink.waitForReadyRead(10);
+      while (sink.hasPendingDatagrams()) {
+          sink.readDatagram(nullptr, 0);
+          nbReceived++;
+        }
+    }
+  elapsed = timer.nsecsElapsed();
+  engine->stopPlaybackPlan();
+  report.addRate("lookaheadBundles", nbReceived, elapsed);
+
+  // the mean and min advances of the bundles on their time tag
+  EngineLookaheadStatistics lookahead = engine->getPlaybackLookaheadStatistics()[SINK_DEVICE];
+  report.addMetric("lookaheadAdvance", lookahead.sentBundles ? double(lookahead.totalAdvance) / lookahead.sentBundles : 0., "us");
+  report.addMetric("lookaheadMinAdvance", lookahead.minAdvance, "us");
+
+  // drain what was received until now
+  QCoreApplication::processEvents();
+  while (sink.hasPendingDatagrams())
+    sink.readDatagram(nullptr, 0);
+
+  /************ compiled playback plan within a message budget ************/
+  engine->setPlaybackLookahead(0);
+  engine->setDeviceMessageBudget(SINK_DEVICE, SINK_BUDGET);
+  engine->setOutputTick(SINK_TICK);
+  planEnd = 0;
+  timer.start();
+  nbPlanned = engine->compilePlaybackPlan(0, planEnd);
+  report.add("budgetCompilePlaybackPlan", nbPlanned, timer.nsecsElapsed());
+
+  nbReceived = 0;
+  engine->playPlaybackPlan();
+  timer.start();
+  while (timer.elapsed() < playDuration && engine->isPlayingPlaybackPlan()) {
+      sink.waitForReadyRead(10);
+      while (sink.hasPendingDatagrams()) {
+          sink.readDatagram(nullptr, 0);
+          nbReceived++;
+        }
+    }
+  elapsed = timer.nsecsElapsed();
+  engine->stopPlaybackPlan();
+  report.addRate("budgetPlaybackMessages", nbReceived, elapsed);
+  report.addMetric("budgetDrops", engine->getOutputMetrics()["OSC"].budgetDrops, "messages");
+
+  delete engine;
+  return 0;
+}
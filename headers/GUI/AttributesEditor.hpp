@@ -63,6 +63,8 @@ class QTabWidget;
 class QScrollArea;
 class QDoubleSpinBox;
 class QLineEdit;
+class QCompleter;
+class QStringListModel;
 class QTreeWidget;
 class QTreeWidgetItem;
 
@@ -202,11 +204,26 @@ class AttributesEditor : public QDockWidget
      */
     void endMessagesChanged(bool forceUpdate = false);
 
+    /*!
+     * \brief Updates the curves display once the box messages have been computed in background.
+     */
+    void boxMessagesComputed(unsigned int boxID);
+
     /*!
      * \brief Called when the name of the box is changed.
      */
     void nameChanged();
     void removeForbiddenChar(QString);
+
+    /*!
+     * \brief Proposes the addresses containing the text of the search field.
+     */
+    void searchAddresses(const QString &text);
+
+    /*!
+     * \brief Selects the address found in the NetworkTree.
+     */
+    void showAddress(const QString &address);
 	void currentColorSelectionChanged(const QColor& );
 	void revertColor();
 
@@ -217,6 +234,9 @@ class AttributesEditor : public QDockWidget
 
     QGridLayout *_boxSettingsLayout; //!< Layout handling box settings (name, color, assignation...).
     NetworkTree *_networkTree; //!< NetworkTree (inspector).
+    QLineEdit *_addressSearch; //!< Search field of the NetworkTree addresses.
+    QCompleter *_addressCompleter; //!< Proposes the addresses found.
+    QStringListModel *_addressesFound; //!< The addresses found.
 
     /// \todo Old TODO updated (by jC)
     QDoubleSpinBox * _boxStartValue;
@@ -232,6 +252,7 @@ class AttributesEditor : public QDockWidget
     QPushButton *_snapshotAssignEnd; //!< End assignation button.
 
     unsigned int _boxEdited;    //!< ID of box being edited
+    bool _forceCurvesUpdate = false; //!< The curves display has to be forced once the messages are computed.
     MaquetteScene * _scene; //!< The maquetteScene related with.
 
 	QColorDialog _colorDialog{this};
@@ -580,6 +580,12 @@ class BasicBox : public QGraphicsObject
     static const QString SCENARIO_MODE_TEXT;
     static const QString DEFAULT_MODE_TEXT;
 
+    //! \brief Zoom factor under which boxes may be drawn without details.
+    static const float LOW_DETAIL_ZOOM_THRESHOLD;
+
+    //! \brief Width (in pixels) under which a box is considered small on screen.
+    static const float LOW_DETAIL_MAX_WIDTH;
+
     /*!
      * \brief Painting method, redefinition of QGraphicsItem::paint().
      *
@@ -606,6 +612,28 @@ class BasicBox : public QGraphicsObject
     void drawHoverShape(QPainter *painter);
     void drawSelectShape(QPainter *painter);
 
+    /*!
+     * \brief Draws the box as a flat colored rect, from a cached pixmap.
+     * Used at low zoom levels instead of the full rendering.
+     *
+     * \param painter : the painter used to draw
+     */
+    void drawLowDetail(QPainter *painter);
+
+    /*!
+     * \brief Determines if the box has to be drawn without details,
+     * i.e. if the zoom is under LOW_DETAIL_ZOOM_THRESHOLD and the box is small on screen.
+     *
+     * \return true if the box is drawn as a flat rect
+     */
+    bool lowDetail() const;
+
+    /*!
+     * \brief Updates the level of detail of the box, hiding its widgets if not drawn.
+     * Called by the scene when zoom changes.
+     */
+    void updateLevelOfDetail();
+
     void updateBoxSize();
     MaquetteScene * maquetteScene(){ return _scene; }
     bool hasCurve(string address){ return _curvesAddresses.contains(address); }
@@ -759,6 +787,7 @@ class BasicBox : public QGraphicsObject
 
     bool _low;
     bool _hover;
+    bool _lowDetail;                                                            //!< State of low detail rendering.
 
     QAction *_jumpToStartCue{};
     QAction *_jumpToEndCue{};
@@ -61,6 +61,7 @@ class AttributesEditor;
 class BasicBox;
 class QActionGroup;
 class Help;
+class ProjectWriter;
 
 /*!
  * \class MainWindow
@@ -182,6 +183,14 @@ class MainWindow : public QMainWindow
      */
     void help();
 
+    /*!
+     * \brief Informs the user when a project has been written in background.
+     *
+     * \param fileName : the project file
+     * \param success : false if the project could not be written
+     */
+    void projectWritten(const QString &fileName, bool success);
+
     /*!
      * \brief Updates the palette view state.
      */
@@ -250,7 +259,7 @@ class MainWindow : public QMainWindow
      *
      * \param fileName : the file to save
      *
-     * \return true if the file was saved successfully
+     * \return true if the file is being written (see projectWritten)
      */
     bool saveFile(const QString &fileName);
 
@@ -276,6 +285,7 @@ class MainWindow : public QMainWindow
     QWidget *_centralWidget;
 
     QString _curFile;                       //!< The current file name.
+    ProjectWriter *_projectWriter;          //!< Writes saved projects in background.
 
     QMenuBar *_menuBar;                     //!< Main menu bar.
     QMenu *_fileMenu;                       //!< File menu.
@@ -303,6 +313,8 @@ class MainWindow : public QMainWindow
     QAction *_PBModeAct;                    //!< Selecting parent boxes creation mode action.
     QAction *_commentModeAct;               //!< Selecting comment creation action.
     QAction *_selectAllAct;                 //!< Selecting the whole set of boxes action.
+    QAction *_undoAct;                      //!< Undoing the last edit action.
+    QAction *_redoAct;                      //!< Redoing the last undone edit action.
 
     QActionGroup * _modeAct;                //!< Containing various interaction modes.
 
@@ -481,11 +481,13 @@ class MaquetteScene : public QGraphicsScene
     void setModified(bool modified);
 
     /*!
-     * \brief Saves the current composition into a file.
+     * \brief Saves the current composition into memory, as it would be saved into a file.
      *
-     * \param fileName : the file to save current composition into
+     * \param fileName : the file the composition will be written to
+     * \param content : filled with the content of the file
+     * \return true if the composition has been saved
      */
-    void save(const std::string &fileName);
+    bool save(const std::string &fileName, std::string &content);
 
     /*!
      * \brief Loads a file into a new composition.
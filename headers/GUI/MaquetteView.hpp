@@ -81,7 +81,7 @@ class MaquetteView : public QGraphicsView
     inline MainWindow *
     mainWindow(){ return _mainWindow; }
     void triggerShortcut(int shortcut);
-    void emitPlayModeChanged();
+    Q_INVOKABLE void emitPlayModeChanged();
     const QColor BACKGROUND_COLOR{60, 60, 60};
 
     // To allow a key event when pressing space on another window
@@ -134,6 +134,11 @@ signals:
   protected:
     void resizeEvent(QResizeEvent *);
 
+    /*!
+     * \brief Redefinition of QGraphicsView::scrollContentsBy() : lays out the boxes scrolled into view after a zoom.
+     */
+    void scrollContentsBy(int dx, int dy);
+
     /*!
      * \brief Draws the indicator of a start cue (as a linearGradient for example)
      */
@@ -0,0 +1,143 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef NAMESPACE_EXPLORER_HPP
+#define NAMESPACE_EXPLORER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief A node of a device namespace, as explored by the NamespaceExplorer.
+ */
+struct NamespaceNode
+{
+  std::string name;                     //!< The node name (relative to its parent).
+  bool isData;                          //!< The node is a Data (a leaf of the NetworkTree).
+  std::vector<NamespaceNode> children;  //!< The children nodes.
+};
+
+/*!
+ * \class NamespaceExplorer
+ *
+ * \brief Explores the namespace of several devices without blocking the interface.
+ *
+ * Each device is explored by its own worker thread (the namespace is rebuilt first if asked) :
+ * a device which doesn't answer doesn't delay the others. The Engine locks its namespaces for each access only.
+ * Each result is delivered in the main thread with explored().
+ * A device which doesn't answer within EXPLORATION_TIMEOUT from the request is reported with timedOut() :
+ * its exploration is cancelled and its late result is dropped.
+ */
+class NamespaceExplorer : public QObject
+{
+  Q_OBJECT
+
+  public:
+    NamespaceExplorer(QObject *parent = nullptr);
+
+    /*!
+     * \brief Cancels the explorations and waits for their worker threads, which use the Engine.
+     * A device rebuilding its namespace can delay this until its protocol gives up.
+     */
+    virtual ~NamespaceExplorer();
+
+    /*!
+     * \brief Starts the exploration of a device namespace.
+     * If the device is still being explored, the exploration is restarted once the current one ends.
+     *
+     * \param deviceName : the device to explore.
+     * \param rebuild : ask the device for its namespace before exploring it.
+     */
+    void explore(const QString &deviceName, bool rebuild);
+
+    /*!
+     * \brief Tells if a device exploration is pending.
+     */
+    bool isExploring(const QString &deviceName) const;
+
+    static const int EXPLORATION_TIMEOUT = 10000; //!< In ms.
+
+  signals:
+    void explored(const QString &deviceName, const NamespaceNode &root);
+    void timedOut(const QString &deviceName);
+
+  private slots:
+    void deliver(const QString &deviceName);
+
+  private:
+    /*!
+     * \brief The state shared with the worker thread of an exploration.
+     */
+    struct Job
+    {
+      std::atomic<bool> cancelled{false};  //!< The exploration must stop.
+      std::mutex mutex;                   //!< Protects the members below.
+      bool explored = false;              //!< The exploration reached its end.
+      NamespaceNode root;                 //!< The explored namespace.
+    };
+
+    struct Exploration
+    {
+      QTimer *timer = nullptr;        //!< Fires when the device didn't answer in time.
+      bool running = false;           //!< The worker thread is running.
+      bool waited = false;            //!< The result is still expected (not timed out).
+      bool restart = false;           //!< An exploration was asked while running.
+      bool restartRebuild = false;    //!< The restarted exploration rebuilds the namespace.
+      std::shared_ptr<Job> job;       //!< Shared with the worker thread.
+      std::thread thread;             //!< The worker thread, joined once it delivered.
+    };
+
+    void start(const QString &deviceName, bool rebuild);
+    void timeout(const QString &deviceName);
+    static void work(NamespaceExplorer *explorer, QString deviceName, bool rebuild, std::shared_ptr<Job> job);
+    static bool exploreNode(const Job &job, const std::string &address, NamespaceNode &node);
+
+    std::map<QString, Exploration> _explorations; //!< Explorations by device name (main thread only).
+};
+
+#endif // NAMESPACE_EXPLORER_HPP
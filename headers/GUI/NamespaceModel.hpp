@@ -0,0 +1,200 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef NAMESPACE_MODEL_HPP
+#define NAMESPACE_MODEL_HPP
+
+/*!
+ * \file NamespaceModel.hpp
+ */
+
+#include <QAbstractItemModel>
+#include <QCache>
+#include <QString>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AddressTrie.hpp"
+#include "NamespaceExplorer.hpp"
+
+/*!
+ * \class NamespaceModel
+ *
+ * \brief A read-only model over the explored namespace of a device, for namespaces too big for the NetworkTree items.
+ *
+ * The namespace is kept as a flat array of nodes, the children of a node being contiguous,
+ * each node holding its interned address and a few indices : no string nor item is stored per node.
+ * The attributes shown in the columns are asked to the Maquette when a row is displayed,
+ * and only the ones of the last displayed rows are cached. A row is painted with placeholders first :
+ * its attributes are read by a worker thread, and its value is taken from the value cache,
+ * without waiting for the devices. The row is updated as they arrive.
+ */
+class NamespaceModel : public QAbstractItemModel
+{
+  Q_OBJECT
+
+  public:
+    enum Column { NAME_COLUMN, VALUE_COLUMN, TYPE_COLUMN, MIN_COLUMN, MAX_COLUMN, PRIORITY_COLUMN, COLUMN_COUNT };
+
+    NamespaceModel(const QString &deviceName, QObject *parent = nullptr);
+
+    /*!
+     * \brief Stops the attributes reader thread, which uses the Engine.
+     */
+    virtual ~NamespaceModel();
+
+    /*!
+     * \brief Replaces the namespace shown by the model.
+     *
+     * \param root : the device namespace, as explored by the NamespaceExplorer.
+     */
+    void setNamespace(const NamespaceNode &root);
+
+    /*!
+     * \brief Forgets the cached attributes, to ask them again to the Maquette.
+     */
+    void invalidate();
+
+    /*!
+     * \brief Gets the number of nodes of the namespace (the device excluded).
+     */
+    int nodeCount() const;
+
+    /*!
+     * \brief Gets the full address of an index, as "device/node/leaf".
+     */
+    std::string address(const QModelIndex &index) const;
+
+    /*!
+     * \brief Tells if an index is a Data (a leaf of the NetworkTree).
+     */
+    bool isData(const QModelIndex &index) const;
+
+    /*!
+     * \brief Gets the index of an address, invalid if it isn't in the namespace.
+     */
+    QModelIndex indexOf(AddressHandle handle) const;
+
+    /*!
+     * \brief Gets the addresses of the namespace (the device excluded).
+     */
+    std::vector<AddressHandle> addresses() const;
+
+    /*!
+     * \brief Rebuilds the namespace below an index, to build NetworkTree items for a part of the namespace.
+     *
+     * \param maxNodes : gives up (and returns false) if the subtree has more nodes.
+     */
+    bool subtree(const QModelIndex &index, NamespaceNode &node, int maxNodes) const;
+
+    /*!
+     * \brief Counts the nodes of a namespace, the root excluded.
+     */
+    static int countNodes(const NamespaceNode &root);
+
+    QString deviceName() const { return _deviceName; }
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &index) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+
+    static const int ATTRIBUTES_CACHE_SIZE = 1024; //!< Number of rows whose attributes are cached.
+
+  private slots:
+    void valueRead(const QString &address, const QString &value);
+    void deliverAttributes();
+
+  private:
+    struct Node
+    {
+      AddressHandle address;  //!< The interned address of the node.
+      int parent;             //!< The index of the parent node (-1 for the device).
+      int row;                //!< The row of the node under its parent.
+      int firstChild;         //!< The index of the first child, the other ones follow.
+      int childCount;         //!< The number of children.
+      bool isData;            //!< The node is a Data.
+    };
+
+    struct Attributes
+    {
+      QString columns[COLUMN_COUNT];
+    };
+
+    /*!
+     * \brief The attributes of a node to read, or read, by the reader thread.
+     */
+    struct AttributesRead
+    {
+      int node;                   //!< The node whose attributes are read.
+      unsigned int generation;    //!< The namespace of the node (see _generation).
+      std::string address;        //!< The node address.
+      bool isData;                //!< The node is a Data.
+      Attributes attributes;      //!< The attributes read.
+    };
+
+    int nodeIndex(const QModelIndex &index) const;
+    bool fillSubtree(int node, NamespaceNode &out, int &remaining) const;
+    const Attributes *attributes(int node) const;
+    void dropReads();
+    void readAttributes();
+    static void readAttributes(AttributesRead &read);
+
+    QString _deviceName;                                  //!< The device shown.
+    std::vector<Node> _nodes;                             //!< The nodes, the first one is the device.
+    mutable QCache<int, Attributes> _attributes;          //!< The attributes of the last displayed rows (placeholders while they are read).
+    unsigned int _generation = 0;                         //!< Changes with the namespace or invalidate : older reads are dropped.
+
+    std::thread _reader;                                  //!< Reads the attributes of the displayed rows.
+    mutable std::mutex _readsMutex;                       //!< Protects the members below.
+    mutable std::condition_variable _readsCondition;      //!< Wakes the reader up when a row is queued.
+    mutable std::deque<AttributesRead> _reads;            //!< The rows to read.
+    std::vector<AttributesRead> _readsDone;               //!< The rows read, to deliver in the main thread.
+    bool _readerStop = false;                             //!< Asks the reader to stop.
+};
+
+#endif // NAMESPACE_MODEL_HPP
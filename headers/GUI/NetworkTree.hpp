@@ -51,8 +51,14 @@
 #include "NetworkMessages.hpp"
 #include "AbstractBox.hpp"
 #include "DeviceEdit.hpp"
+#include "NamespaceExplorer.hpp"
+#include "NamespaceModel.hpp"
+#include "AddressTrie.hpp"
+#include "AddressIndex.hpp"
 #include <QPair>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 
 using std::vector;
 using std::string;
@@ -62,7 +68,8 @@ using std::map;
 enum { DeviceNode = QTreeWidgetItem::UserType + 1, NodeNoNamespaceType = QTreeWidgetItem::UserType + 2,
        LeaveType = QTreeWidgetItem::UserType + 3, AttributeType = QTreeWidgetItem::UserType + 4,
        OSCNamespace = QTreeWidgetItem::UserType + 5, OSCNode = QTreeWidgetItem::UserType + 6, addOSCNode = QTreeWidgetItem::UserType + 7,
-       MessageType = QTreeWidgetItem::UserType + 8, addDeviceNode = QTreeWidgetItem::UserType + 9};
+       MessageType = QTreeWidgetItem::UserType + 8, addDeviceNode = QTreeWidgetItem::UserType + 9,
+       LargeNamespaceNode = QTreeWidgetItem::UserType + 10};
 
 class NetworkTreeItem;
 class NetworkTree : public QTreeWidget
@@ -96,7 +103,22 @@ class NetworkTree : public QTreeWidget
     QString getDeviceName(QTreeWidgetItem *item) const;
     QString getAbsoluteAddressWithValue(QTreeWidgetItem *item, int column) const;
 
+    /*!
+     * \brief Gets the sort key of the priority of an item, kept with its properties :
+     * its priority, UINT_MAX if it has none (the messages without priority are sent last).
+     */
+    unsigned int priorityKey(QTreeWidgetItem *item) const;
+
+    /*!
+     * \brief Changes each time the priority of an item changes.
+     */
+    unsigned int prioritiesRevision() const { return _prioritiesRevision; }
 
+
+    /*!
+     * \brief Gets the addresses of the parameters, messages and returns of the tree.
+     * The list is computed in one pass over these items, and cached until the tree items change.
+     */
     QList<std::string> getAddressList();
     /*!
      * \brief Gets the absolute address of an item in the snapshot tree.
@@ -105,6 +127,24 @@ class NetworkTree : public QTreeWidget
      */
     QTreeWidgetItem *getItemFromAddress(string address) const;
 
+    /*!
+     * \brief Finds the addresses of the devices containing a text (case insensitive), with the AddressIndex.
+     * The addresses of the large namespaces are found too, even if they have no item.
+     *
+     * \param text : the text searched.
+     * \param prefix : only finds the addresses beginning with the text.
+     * \param maxResults : the maximum number of addresses returned.
+     * \return the addresses found, sorted.
+     */
+    QStringList findAddresses(const QString &text, bool prefix = false, unsigned int maxResults = SEARCH_RESULTS_MAX) const;
+
+    /*!
+     * \brief Selects the item of an address, after building its branch if it is in a large namespace.
+     *
+     * \return false if the address isn't in the tree.
+     */
+    bool showAddress(const string &address);
+
     /*!
      * \brief Used for loading. To get tree items, and parsed messages from a string name (given by the engine).
      */
@@ -305,29 +345,28 @@ class NetworkTree : public QTreeWidget
 
     /*!
      * \brief Getter
-     * \return The partially assigned items list (nodes with some children assigned).
+     * \return The partially assigned items list (nodes with some children assigned), in tree order.
      */
-    inline QList<QTreeWidgetItem*> nodesPartiallyAssigned() { return _nodesWithSomeChildrenAssigned; }
+    QList<QTreeWidgetItem*> nodesPartiallyAssigned();
 
     /*!
      * \brief Getter
-     * \return The full assigned items list (nodes with all children assigned).
+     * \return The full assigned items list (nodes with all children assigned), in tree order.
      */
-    inline QList<QTreeWidgetItem*> nodesTotallyAssigned() { return _nodesWithAllChildrenAssigned; }
+    QList<QTreeWidgetItem*> nodesTotallyAssigned();
 
     /*!
      * \brief Sets the assigned items list.
      * \param The assigned items list.
      */
-    inline void
-    setAssignedItems(QMap<QTreeWidgetItem*, Data> items){ _assignedItems.clear(); _assignedItems = items; }
+    void setAssignedItems(QMap<QTreeWidgetItem*, Data> items);
 
     /*!
      * \brief Adds an item to the assigned items list.
      * \param The assigned item to add.
      */
     inline void
-    addAssignedItem(QTreeWidgetItem* item, Data data){ _assignedItems.insert(item, data); }
+    addAssignedItem(QTreeWidgetItem* item, Data data){ _assignedItems.insert(item, data); updateAssignedCounter(item); }
 
     /*!
      * \brief Return true if item is already assigned.
@@ -341,7 +380,7 @@ class NetworkTree : public QTreeWidget
      * \param The item to remove.
      */
     inline void
-    removeAssignItem(QTreeWidgetItem* item){ _assignedItems.remove(item); }
+    removeAssignItem(QTreeWidgetItem* item){ _assignedItems.remove(item); updateAssignedCounter(item); }
 
     void removeCurrentNode();
 
@@ -397,6 +436,8 @@ class NetworkTree : public QTreeWidget
     static unsigned int TEXT_POINT_SIZE;
     static const QColor TEXT_COLOR;
     static const QColor TEXT_DISABLED_COLOR;
+    static const unsigned int SEARCH_RESULTS_MAX = 100; //!< Default maximum number of addresses found by findAddresses.
+    static const int LARGE_NAMESPACE_SIZE = 20000; //!< Above this number of addresses, a device namespace is browsed with a NamespaceModel.
 
     bool VALUE_MODIFIED;
     bool SR_MODIFIED;
@@ -432,6 +473,32 @@ class NetworkTree : public QTreeWidget
 
   private:
     void treeRecursiveExploration(QTreeWidgetItem *curItem, bool conflict);
+
+    /*!
+      * \brief Builds the items under curItem from an explored namespace (see NamespaceExplorer).
+      */
+    void treeBuild(QTreeWidgetItem *curItem, const NamespaceNode &node);
+
+    /*!
+      * \brief Opens a view on the NamespaceModel of a device too big to be built as items.
+      */
+    void browseNamespace(const QString &deviceName);
+
+    /*!
+      * \brief Builds the items of a branch chosen in a NamespaceModel, with its ancestors, to assign its addresses.
+      */
+    void buildNamespaceBranch(const QString &deviceName, const QModelIndex &index);
+
+    /*!
+      * \brief Deletes the NamespaceModel of a device, if any.
+      */
+    void forgetNamespaceModel(const QString &deviceName);
+
+    /*!
+      * \brief Adds (or removes) the addresses of a NamespaceModel to the AddressIndex.
+      */
+    void indexNamespaceModel(NamespaceModel *model, bool add);
+    QTreeWidgetItem *getDeviceItem(const QString &deviceName);
     void createOSCBranch(QTreeWidgetItem *curItem);
     QTreeWidgetItem *addADeviceNode();
 
@@ -478,16 +545,14 @@ class NetworkTree : public QTreeWidget
 
     void addNodePartiallyAssigned(QTreeWidgetItem *item)
     {
-      if (!_nodesWithSomeChildrenAssigned.contains(item)) {
-          _nodesWithSomeChildrenAssigned << item;
-        }
+      _nodesWithSomeChildrenAssigned.insert(item);
+      updateAssignedCounter(item);
     }
 
     void removeNodePartiallyAssigned(QTreeWidgetItem *item)
     {
-      if (_nodesWithSomeChildrenAssigned.contains(item)) {
-          _nodesWithSomeChildrenAssigned.removeAll(item);
-        }
+      _nodesWithSomeChildrenAssigned.remove(item);
+      updateAssignedCounter(item);
     }
 
     void setPartiallyAssign(QTreeWidgetItem *item);
@@ -497,16 +562,12 @@ class NetworkTree : public QTreeWidget
 
     void addNodeTotallyAssigned(QTreeWidgetItem *item)
     {
-      if (!_nodesWithAllChildrenAssigned.contains(item)) {
-          _nodesWithAllChildrenAssigned << item;
-        }
+      _nodesWithAllChildrenAssigned.insert(item);
     }
 
     void removeNodeTotallyAssigned(QTreeWidgetItem *item)
     {
-      if (_nodesWithAllChildrenAssigned.contains(item)) {
-          _nodesWithAllChildrenAssigned.removeAll(item);
-        }
+      _nodesWithAllChildrenAssigned.remove(item);
     }
 
     void setTotallyAssignedStyle(QTreeWidgetItem *item);
@@ -517,11 +578,62 @@ class NetworkTree : public QTreeWidget
     void execClickAction(QTreeWidgetItem *curItem, QList<QTreeWidgetItem *> items, int column);
     void unselectAll();
 
-    QMap<QTreeWidgetItem *, string> _addressMap;
+    /*!
+      * \brief Indexes an item by its address (an address has one item).
+      */
+    void setItemAddress(QTreeWidgetItem *item, const string &address);
+
+    /*!
+      * \brief Removes an item and its children from the addresses index, before they are deleted.
+      */
+    void forgetItemAddresses(QTreeWidgetItem *item);
+
+    /*!
+      * \brief What an item counts of its children, to know the state of the item without scanning them,
+      * and what it counts for its father.
+      */
+    struct AssignationCounters
+    {
+      int assignedChildren = 0;                       //!< Children assigned (partially for nodes).
+      int checkedChildren[2] = {0, 0};                //!< Children checked in the start and end assignation columns.
+      int markedChildren[2] = {0, 0};                 //!< Children checked or partially checked in these columns.
+      bool assigned = false;                          //!< The item counts as assigned for its father.
+      Qt::CheckState checkStates[2] = {Qt::Unchecked, Qt::Unchecked}; //!< The item state in these columns.
+    };
+
+    /*!
+      * \brief Counts or uncounts an item in the assigned children of its father, after its assignation changed.
+      */
+    void updateAssignedCounter(QTreeWidgetItem *item);
+
+    /*!
+      * \brief Uncounts an item from its father and forgets the counters of the item and its children, before they are deleted.
+      */
+    void forgetItemCounters(QTreeWidgetItem *item);
+
+    /*!
+      * \brief The index of an assignation column in AssignationCounters (-1 for the other columns).
+      */
+    static int assignationColumnIndex(int column);
+
+    /*!
+      * \brief The items of a set in the order they are displayed in the tree (depth first).
+      */
+    static QList<QTreeWidgetItem *> inTreeOrder(const QSet<QTreeWidgetItem *> &items);
+
+    QHash<QTreeWidgetItem *, AddressHandle> _itemsAddress;   //!< The interned address of each item.
+    QHash<AddressHandle, QTreeWidgetItem *> _addressesItem;  //!< The item of each interned address.
+    QHash<QTreeWidgetItem *, unsigned int> _itemsPriorityKey;  //!< The priority of the items which have one (see priorityKey).
+    unsigned int _prioritiesRevision = 0;                    //!< Changes with _itemsPriorityKey.
+    AddressIndex _addressIndex;                              //!< The addresses of the items and of the NamespaceModels, to search them.
+    QSet<QTreeWidgetItem *> _directedItems;                  //!< The parameters (bi-directional), messages (receivers) and returns (senders) items.
+    QList<std::string> _addressList;                         //!< The cached getAddressList.
+    bool _addressListValid = false;                          //!< _addressList is up to date.
     QList<QTreeWidgetItem*> _nodesWithSelectedChildren;
     QMap<QTreeWidgetItem *, Data> _assignedItems;    
-    QList<QTreeWidgetItem*> _nodesWithSomeChildrenAssigned;
-    QList<QTreeWidgetItem*> _nodesWithAllChildrenAssigned;
+    QSet<QTreeWidgetItem*> _nodesWithSomeChildrenAssigned;
+    QSet<QTreeWidgetItem*> _nodesWithAllChildrenAssigned;
+    QHash<QTreeWidgetItem *, AssignationCounters> _assignationCounters;  //!< Kept up to date on assignation and check changes.
 
     NetworkMessages *_startMessages;
     NetworkMessages *_endMessages;
@@ -540,6 +652,21 @@ class NetworkTree : public QTreeWidget
 
     DeviceEdit *_deviceEdit;  
 
+    /*!
+      * \brief What refreshItemNamespace has to restore once a device namespace has been explored.
+      */
+    struct PendingExploration
+    {
+      bool updateBoxes = false;
+      bool isLearning = false;
+      std::vector<std::string> expandedAddresses;
+      QSet<AddressHandle> previousAddresses;
+    };
+
+    NamespaceExplorer *_namespaceExplorer;                    //!< Explores the devices namespaces in worker threads.
+    QMap<QString, PendingExploration> _pendingExplorations;   //!< Refreshes waiting for their device namespace.
+    QMap<QString, NamespaceModel *> _namespaceModels;         //!< The namespaces of the devices too big to be built as items.
+
     void disableLearningForEveryDevice();
     void removeOSCMessage(QTreeWidgetItem* item);
     void setNewItemProperties(NetworkTreeItem* curItem);
@@ -553,6 +680,11 @@ public slots:
     void deleteCurrentItemNamespace();
     void clickInNetworkTree(QTreeWidgetItem *item, int column);
     void valueChanged(QTreeWidgetItem* item, int column);
+
+    /*!
+      * \brief Updates the checked children counters of the father of an item.
+      */
+    void checkStateChanged(QTreeWidgetItem* item, int column);
     void changeStartValue(QTreeWidgetItem* item, QString newValue);    
     void changeEndValue(QTreeWidgetItem* item, QString newValue);
     void changeNameValue(QTreeWidgetItem* item, QString newValue);
@@ -563,6 +695,12 @@ public slots:
     void setRecMode(std::string address);
     void setRecMode(QList<std::string> items);
 
+    /*!
+      * \brief Merges the explored namespace of a device into the tree.
+      */
+    void deviceExplored(const QString &deviceName, const NamespaceNode &root);
+    void deviceExplorationTimedOut(const QString &deviceName);
+
     virtual void clear();
 	
 	void enable();
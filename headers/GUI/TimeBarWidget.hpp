@@ -25,15 +25,18 @@ class TimeBarWidget : public QWidget {
     virtual void moveEvent(QMoveEvent*); // Called when a scrollbar is moved
 
   private:    
-    void redrawPixmap();
+    // Returns the ruler tile of index tileIndex for the current zoom, rendering it only if not cached
+    QPixmap tile(int tileIndex);
+    void renderTile(QPixmap &pixmap, int tileIndex);
     MaquetteScene *_scene;
     QRect _rect;
-    QPixmap _pixmap;
     QFont _font{"helvetica", 9};
 
     QPainter _painter;
 
     static const float TIME_BAR_HEIGHT;
     static const float LEFT_MARGIN;
+    static const int TILE_WIDTH; // Width (in pixels) of a cached ruler tile
+    static const int LABEL_WIDTH; // Max width of a graduation text, to draw labels overlapping tiles
 };
 #endif // TIMEBARWIDGET_HPP
@@ -0,0 +1,91 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <thread>
+
+#include "Engine.h"
+
+/*!
+ * \class HeadlessRunner
+ *
+ * \brief Loads a project into an Engine and plays it without any graphics item.
+ * Transport is controlled remotly through i-score:/Transport (Play, Stop, Pause, Rewind, StartPoint, Speed).
+ *
+ * Engine callbacks are called from the network and scheduler threads :
+ * they are forwarded to the main thread using queued signals, as the Maquette does.
+ */
+class HeadlessRunner : public QObject
+{
+  Q_OBJECT
+
+  public:
+    HeadlessRunner(const QString &jamomaFolder, bool quitAtEnd, bool printExecution, bool compiled = false);
+    virtual ~HeadlessRunner();
+
+    /*!
+     * \brief Loads a project file.
+     *
+     * \param fileName : the project to load
+     * \return true if the project was loaded
+     */
+    bool load(const QString &fileName);
+
+    /*!
+     * \brief Sends the compiled messages of the OSC devices in time tagged bundles, ahead of their date.
+     *
+     * \param lookahead : in ms, 0 to send every message at its date.
+     */
+    void setLookahead(unsigned int lookahead);
+
+    /*!
+     * \brief Limits the messages sent to each device of the project.
+     *
+     * \param messagesBySecond : the budget of each device, 0 for no limit.
+     * \param tick : how long (in ms) the outputs coalesce the curve samples, 0 to send them at once.
+     */
+    void setMessageBudget(unsigned int messagesBySecond, unsigned int tick);
+
+    static HeadlessRunner *getInstance(){ return _instance; }
+
+    static void triggerPointIsActiveCallback(ConditionedTimeBoxId triggerId, bool active);
+    static void boxIsRunningCallback(TimeBoxId boxId, bool running);
+    static void transportCallback(TTSymbol &transport, const TTValue &value);
+    static void deviceCallback(TTSymbol &deviceName);
+    static void deviceConnectionErrorCallback(TTSymbol &deviceName, TTSymbol &errorInfo);
+
+  signals:
+    void playSignal();
+    void stopSignal();
+    void pauseSignal();
+    void rewindSignal();
+    void startPointSignal(unsigned int timeOffset);
+    void speedSignal(double speed);
+    void scenarioEndedSignal();
+
+  public slots:
+    void play();
+    void stop();
+    void pause();
+    void rewind();
+    void setStartPoint(unsigned int timeOffset);
+    void setSpeed(double speed);
+    void scenarioEnded();
+
+  private slots:
+    void checkPlaybackPlan();
+
+  private:
+    void joinPrintThread();
+
+    static HeadlessRunner *_instance;
+
+    Engine *_engines;
+    bool _quitAtEnd;          //!< Quit the application when the main scenario ends.
+    bool _printExecution;     //!< Print the running boxes in the console during execution.
+    bool _compiled;           //!< Play the compiled playback plan of the score instead of the scenario.
+    QTimer *_planTimer;       //!< Checks if the playback plan is over.
+    unsigned int _lookahead;  //!< How long (in ms) before their date the compiled messages of the OSC devices are sent.
+    unsigned int _startPoint; //!< Date from where the main scenario starts on the next play.
+    std::thread _printThread; //!< Runs Engine::printExecutionInLinuxConsole during execution.
+};
@@ -184,14 +184,41 @@ class AbstractBox : public Abstract
      * \param topLeft : the top left coordinates of the box
      */
     inline void
-    setTopLeft(const QPointF &topLeft) { _topLeft = topLeft; }
+    setTopLeft(const QPointF &topLeft) { _topLeft = topLeft; _hasDates = false; }
 
     /*!
      * \brief Sets the width of the box.
      * \param width : the new width of the box
      */
     inline void
-    setWidth(const float &width) {_width = width; }
+    setWidth(const float &width) {_width = width; _hasDates = false; }
+
+    /*!
+     * \brief Gets the date of the box (in ms, relative to its mother) when it is known.
+     */
+    inline TimeValue
+    date() const { return _date; }
+
+    /*!
+     * \brief Gets the duration of the box (in ms) when it is known.
+     */
+    inline TimeValue
+    duration() const { return _duration; }
+
+    /*!
+     * \brief Tells if date and duration match the current coordinates of the box.
+     * Moving or resizing the box forgets them.
+     */
+    inline bool
+    hasDates() const { return _hasDates; }
+
+    /*!
+     * \brief Sets the date and duration matching the current coordinates of the box.
+     * \param date : the date of the box (in ms, relative to its mother)
+     * \param duration : the duration of the box (in ms)
+     */
+    inline void
+    setDates(TimeValue date, TimeValue duration) { _date = date; _duration = duration; _hasDates = true; }
 
     /*!
      * \brief Sets the height of the box.
@@ -331,5 +358,8 @@ class AbstractBox : public Abstract
     QList<QTreeWidgetItem *> _networkTreeSelectedItems;
     QList<std::string> _messagesToRecord;
     bool _justCreated;                                  //!< Used just for expanded items. Special case if the box is just created. We set the tree current state.
+    TimeValue _date;                                    //!< The date of the box (in ms), used to compute coordinates when zooming.
+    TimeValue _duration;                                //!< The duration of the box (in ms), used to compute coordinates when zooming.
+    bool _hasDates;                                     //!< Handling if _date and _duration match the current coordinates.
 };
 #endif
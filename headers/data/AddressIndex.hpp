@@ -0,0 +1,138 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef ADDRESSINDEX_HPP
+#define ADDRESSINDEX_HPP
+
+/*!
+ * \file AddressIndex.hpp
+ */
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AddressTrie.hpp"
+
+/*!
+ * \class AddressIndex
+ *
+ * \brief A search index over interned addresses, by prefix and by substring (case insensitive).
+ *
+ * Addresses are kept sorted for prefix searches, and every 3 characters sequence (trigram)
+ * of an address lists it : a substring search only checks the addresses listed by the rarest
+ * trigram of the searched text.
+ * An address may be added several times (by several owners), it stays indexed until it is removed
+ * as many times. Since the address of a handle never changes, its trigrams are listed once and for all.
+ */
+class AddressIndex
+{
+  public:
+    AddressIndex();
+    AddressIndex(const AddressIndex &) = delete;
+    AddressIndex &operator=(const AddressIndex &) = delete;
+
+    /*!
+     * \brief Indexes an address (once more).
+     */
+    void add(AddressHandle handle);
+
+    /*!
+     * \brief Unindexes an address (once), it is not found anymore once removed as many times as added.
+     */
+    void remove(AddressHandle handle);
+
+    /*!
+     * \brief Unindexes every address.
+     */
+    void clear();
+
+    /*!
+     * \brief Tells if an address is indexed.
+     */
+    bool contains(AddressHandle handle) const;
+
+    /*!
+     * \brief Gets the number of indexed addresses.
+     */
+    unsigned int size() const;
+
+    /*!
+     * \brief Finds the addresses beginning with a text, sorted.
+     *
+     * \param maxResults : the maximum number of addresses returned.
+     */
+    std::vector<AddressHandle> findPrefix(const std::string &prefix, unsigned int maxResults) const;
+
+    /*!
+     * \brief Finds the addresses containing a text, sorted.
+     *
+     * \param maxResults : the maximum number of addresses returned.
+     */
+    std::vector<AddressHandle> find(const std::string &text, unsigned int maxResults) const;
+
+  private:
+    typedef unsigned int Trigram;
+
+    struct Entry
+    {
+      std::string address;        //!< The lowered address (empty until the handle is indexed once).
+      unsigned int count = 0;     //!< The number of times the address is indexed.
+    };
+
+    struct ByAddress
+    {
+      const AddressIndex *index;
+      bool operator()(AddressHandle a, AddressHandle b) const;
+    };
+
+    const std::string &key(AddressHandle handle) const;
+    static std::string lowered(const std::string &text);
+    static std::vector<Trigram> trigrams(const std::string &text);
+
+    std::vector<Entry> _entries;                                     //!< The entries by handle.
+    std::unordered_map<Trigram, std::vector<AddressHandle> > _postings; //!< The addresses (ever indexed) of each trigram.
+    std::set<AddressHandle, ByAddress> _sorted;                      //!< The indexed addresses, sorted.
+    mutable std::string _probe;                                      //!< The key of NO_ADDRESS, to search _sorted by prefix.
+    unsigned int _size;                                              //!< The number of indexed addresses.
+};
+
+#endif // ADDRESSINDEX_HPP
@@ -0,0 +1,183 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef ADDRESSTRIE_HPP
+#define ADDRESSTRIE_HPP
+
+/*!
+ * \file AddressTrie.hpp
+ */
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*!
+ * \brief A handle on an interned address. Equal addresses have equal handles.
+ */
+typedef unsigned int AddressHandle;
+
+/*!
+ * \brief The handle of the empty address, returned when an address is unknown.
+ */
+#define NO_ADDRESS 0
+
+/*!
+ * \class AddressTrie
+ *
+ * \brief Interns the addresses of the devices namespaces, as "device/node/leaf".
+ *
+ * Each address is stored once, as a node of a trie : an address is identified by an integer
+ * handle, which can be used as a key instead of the address string, and which gives its parent,
+ * its last segment and its children without parsing any string.
+ * The segment names are shared by all the nodes, and the nodes only hold integers.
+ * The addresses of a removed device are forgotten (see releaseDevice), except those still retained
+ * by their users (see retain), which are forgotten at their last release : a handle stays valid as
+ * long as its device is known or as it is retained. The handles of forgotten addresses are reused.
+ * The trie is shared by all threads.
+ */
+class AddressTrie
+{
+  public:
+    static AddressTrie *getInstance();
+
+    /*!
+     * \brief Gets the handle of an address, interning it if needed.
+     *
+     * \param address : the address, as "device/node/leaf" (empty segments are ignored).
+     * \return the address handle, NO_ADDRESS for an empty address.
+     */
+    AddressHandle intern(const std::string &address);
+
+    /*!
+     * \brief Gets the handle of a child address, interning it if needed.
+     *
+     * \param parent : the parent address handle (NO_ADDRESS for a device).
+     * \param segment : the child name.
+     * \return the child address handle.
+     */
+    AddressHandle intern(AddressHandle parent, const std::string &segment);
+
+    /*!
+     * \brief Gets the handle of an address without interning it.
+     *
+     * \return the address handle, NO_ADDRESS if the address was never interned.
+     */
+    AddressHandle find(const std::string &address) const;
+
+    /*!
+     * \brief Gets the full address of a handle, as "device/node/leaf".
+     */
+    std::string address(AddressHandle handle) const;
+
+    /*!
+     * \brief Gets the last segment of an address.
+     */
+    std::string segment(AddressHandle handle) const;
+
+    /*!
+     * \brief Gets the parent of an address, NO_ADDRESS for a device.
+     */
+    AddressHandle parent(AddressHandle handle) const;
+
+    /*!
+     * \brief Gets the interned children of an address, sorted by name.
+     */
+    std::vector<AddressHandle> children(AddressHandle handle) const;
+
+    /*!
+     * \brief Tells if an address is below another one (or is the same).
+     */
+    bool isBelow(AddressHandle handle, AddressHandle ancestor) const;
+
+    /*!
+     * \brief Gets the number of interned addresses.
+     */
+    unsigned int size() const;
+
+    /*!
+     * \brief Keeps an address (and its parents) interned after its device is released.
+     * Each retain has to be balanced by a release.
+     */
+    void retain(AddressHandle handle);
+
+    /*!
+     * \brief Balances a retain : the address is forgotten if its device was released meanwhile.
+     */
+    void release(AddressHandle handle);
+
+    /*!
+     * \brief Forgets the addresses of a removed device, once they are not retained anymore.
+     * Interning one of them again before (the device is added back) keeps it.
+     *
+     * \param deviceName : the name of the device, the first segment of its addresses.
+     */
+    void releaseDevice(const std::string &deviceName);
+
+  private:
+    AddressTrie();
+
+    struct Node
+    {
+      AddressHandle parent;         //!< The parent node.
+      unsigned int segment;         //!< The name of the node, in _segments.
+      AddressHandle firstChild;     //!< The last interned child, NO_ADDRESS if none.
+      AddressHandle nextSibling;    //!< The child of the parent interned before this one.
+      unsigned int references;      //!< The number of retains not released yet.
+      bool released;                //!< The device was released : the node is forgotten when it is not used anymore.
+    };
+
+    AddressHandle internChild(AddressHandle parent, const std::string &segment);
+    AddressHandle findChild(AddressHandle parent, const std::string &segment) const;
+    static unsigned long long childKey(AddressHandle parent, unsigned int segment);
+    bool forget(AddressHandle handle);
+
+    static AddressTrie *_instance;   //!< The shared trie.
+
+    std::vector<Node> _nodes;                                           //!< The nodes by handle, the first one is the empty address.
+    std::vector<std::string> _segments;                                 //!< The segment names, each one stored once.
+    std::unordered_map<std::string, unsigned int> _segmentsIds;         //!< The index of the segment names in _segments.
+    std::unordered_map<unsigned long long, AddressHandle> _children;    //!< The nodes by parent and segment (see childKey).
+    std::vector<AddressHandle> _freeNodes;                              //!< The handles of the forgotten nodes, reused first.
+    mutable std::mutex _mutex;       //!< Protects the members above (addresses are interned from the network threads too).
+};
+
+#endif // ADDRESSTRIE_HPP
@@ -0,0 +1,179 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+/*!
+ * \file BoundedQueue.hpp
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/*!
+ * \class BoundedQueue
+ *
+ * \brief A lock-free first in first out queue of a fixed capacity, for several producer and consumer threads.
+ *
+ * Each cell has a sequence number telling if it is free for the next push or filled for the next pop,
+ * so a thread only reserves a position with a compare and swap and never waits for another one.
+ * The capacity is rounded up to a power of 2.
+ */
+template <typename T>
+class BoundedQueue
+{
+  public:
+    BoundedQueue(unsigned int capacity);
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /*!
+     * \brief Appends a value.
+     *
+     * \return false if the queue is full.
+     */
+    bool push(const T &value);
+
+    /*!
+     * \brief Takes the oldest value.
+     *
+     * \return false if the queue is empty.
+     */
+    bool pop(T &value);
+
+    unsigned int capacity() const;
+
+  private:
+    struct Cell
+    {
+      std::atomic<size_t> sequence;
+      T value;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask;                         //!< The capacity minus 1.
+    std::atomic<size_t> _pushPosition;    //!< The position of the next push.
+    char _padding[64];                    //!< Keeps the positions on different cache lines.
+    std::atomic<size_t> _popPosition;     //!< The position of the next pop.
+};
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(unsigned int capacity)
+  : _pushPosition(0), _popPosition(0)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size *= 2;
+
+  _cells.reset(new Cell[size]);
+  _mask = size - 1;
+
+  for (size_t i = 0; i < size; i++)
+    _cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool
+BoundedQueue<T>::push(const T &value)
+{
+  size_t position = _pushPosition.load(std::memory_order_relaxed);
+
+  while (true) {
+      Cell &cell = _cells[position & _mask];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      long difference = (long)sequence - (long)position;
+
+      if (difference == 0) {
+          // the cell is free : reserve it
+          if (_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+              cell.value = value;
+              cell.sequence.store(position + 1, std::memory_order_release);
+              return true;
+            }
+        }
+      else if (difference < 0) {
+          // the cell is not popped yet : full
+          return false;
+        }
+      else {
+          position = _pushPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool
+BoundedQueue<T>::pop(T &value)
+{
+  size_t position = _popPosition.load(std::memory_order_relaxed);
+
+  while (true) {
+      Cell &cell = _cells[position & _mask];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      long difference = (long)sequence - (long)(position + 1);
+
+      if (difference == 0) {
+          // the cell is filled : take it
+          if (_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+              value = cell.value;
+              cell.sequence.store(position + _mask + 1, std::memory_order_release);
+              return true;
+            }
+        }
+      else if (difference < 0) {
+          // the cell is not pushed yet : empty
+          return false;
+        }
+      else {
+          position = _popPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+unsigned int
+BoundedQueue<T>::capacity() const
+{
+  return _mask + 1;
+}
+
+#endif // BOUNDEDQUEUE_HPP
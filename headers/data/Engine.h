@@ -23,11 +23,24 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
 
 #include <QColor>
 #include <QPointF>
 
+#include "AddressTrie.hpp"
+#include "BoundedQueue.hpp"
+#include "TemporalSolver.hpp"
+
 /** a type dedicated to pass time value (date, duration, ...) */
 typedef unsigned int TimeValue;
 
@@ -84,6 +97,229 @@ typedef std::map<unsigned int, std::list<unsigned int>> EngineConditionsMap;
 /** a map used to remember the namespace file path for each device */
 typedef std::map<std::string, std::string> EngineFilesMap;
 
+/** a hash map to retreive the time box and the control point owning a time event */
+typedef std::unordered_map<TTObjectBasePtr, std::pair<TimeBoxId, TimeEventIndex>> EngineTimeEventsMap;
+
+/** a hash map to retreive an interval from its start and end time events */
+typedef std::pair<TTObjectBasePtr, TTObjectBasePtr> EngineTimeEventsPair;
+
+struct EngineTimeEventsPairHash {
+    size_t operator()(const EngineTimeEventsPair& events) const
+    {
+        std::hash<TTObjectBasePtr> h;
+        return h(events.first) ^ (h(events.second) << 1);
+    }
+};
+
+typedef std::unordered_map<EngineTimeEventsPair, IntervalId, EngineTimeEventsPairHash> EngineIntervalsMap;
+
+/** a class used to cache the value of a device parameter and the observer which keeps it up to date */
+class EngineCachedValue {
+    
+public:
+    TTObject        object;                                 /// the parameter (or its mirror)
+    TTObject        callback;                               /// the observer of its value attribute
+    std::string     value;                                  /// the last value received or read
+    std::chrono::steady_clock::time_point date;             /// when the value was received or read
+    bool            listening = false;                      /// true if the mirror asked its device to notify the value
+    
+    /** is the value younger than maxAge milliseconds (NO_MAX_AGE : always) ? */
+    bool isFresh(unsigned int maxAge) const;
+};
+typedef std::shared_ptr<EngineCachedValue> EngineCachedValuePtr;
+
+/** a hash map to store the cached values of a device by address (retained while cached) */
+typedef std::unordered_map<AddressHandle, EngineCachedValuePtr> EngineValuesMap;
+
+/** a map to store the cached values by device */
+typedef std::map<std::string, EngineValuesMap> EngineDevicesValuesMap;
+
+/** a class used to remember a converted address (see Engine::toTTAddress) */
+class EngineCachedAddress {
+    
+public:
+    AddressHandle   networktreeAddress;                     /// the i-score address (retained while cached)
+    TTAddress       address;                                /// the jamoma address
+    bool            referenced;                             /// used since the clock hand last passed : kept one more turn
+};
+typedef std::vector<EngineCachedAddress> EngineCachedAddresses;
+
+/** a hash map to retreive the cached address of an i-score address by its index in the cache */
+typedef std::unordered_map<AddressHandle, unsigned int> EngineAddressesMap;
+
+/** a map to store the begin and end dates of the boxes edited in a transaction (see Engine::beginEditing) */
+typedef std::map<TimeBoxId, std::pair<TimeValue, TimeValue> > EngineBoxesDatesMap;
+
+/** a map to store the min and max bounds of the relations edited in a transaction (see Engine::beginEditing) */
+typedef std::map<IntervalId, std::pair<BoundValue, BoundValue> > EngineRelationsBoundsMap;
+
+/** a class used to store a message of a compiled playback plan, parsed once (see Engine::compilePlaybackPlan) */
+class EnginePlannedMessage {
+    
+public:
+    TimeValue       date;                                   /// when to send the message (in ms, from the start of the main scenario)
+    TTAddress       address;                                /// the jamoma address
+    AddressHandle   networktreeAddress = NO_ADDRESS;        /// the i-score address (retained by the plan, see m_playbackPlanAddresses)
+    TTValue         value;                                  /// the value to send
+    bool            sample = false;                         /// a curve sample, which a newer sample of its address can replace in an output queue
+};
+
+/** a list to store the messages of a playback plan sorted by date */
+typedef std::vector<EnginePlannedMessage> EnginePlaybackPlan;
+
+/** a class used to measure how late the messages of a playback plan were sent */
+class EnginePlanStatistics {
+    
+public:
+    unsigned int        sentMessages = 0;                   /// the number of messages sent
+    unsigned long long  totalLateness = 0;                  /// the sum of the delays (in µs) between the messages dates and their sending
+    unsigned int        maxLateness = 0;                    /// the longest of these delays (in µs)
+};
+
+/** a class used to measure how far ahead of their time tag the bundles of a device were sent (see Engine::setPlaybackLookahead) */
+class EngineLookaheadStatistics {
+    
+public:
+    unsigned int        sentBundles = 0;                    /// the number of bundles sent
+    unsigned int        sentMessages = 0;                   /// the number of messages of these bundles
+    long long           totalAdvance = 0;                   /// the sum of the delays (in µs) between the sending of the bundles and their time tag
+    long long           minAdvance = 0;                     /// the shortest of these delays (in µs), negative when a bundle was sent too late
+};
+
+/** a map to store the lookahead statistics by device name */
+typedef std::map<std::string, EngineLookaheadStatistics> EngineLookaheadStatisticsMap;
+
+/** a class used to store where the playback plan thread sends the bundles of a device */
+class EngineBundleDestination {
+    
+public:
+    std::string         device;                             /// the device name
+    std::string         ip;                                 /// the ip of the device
+    unsigned short      port;                               /// the port where the device receives OSC messages
+};
+
+#define OUTPUT_QUEUE_CAPACITY 1024      // the number of messages an output queue holds (see setOutputQueueCapacity)
+#define OUTPUT_CURVES_MAX 4096          // the number of curves an output coalesces, the samples of the next curves are sent as cues
+#define OUTPUT_DEVICES_MAX 256          // the number of devices an output applies a budget to (see setDeviceMessageBudget)
+#define OUTPUT_BUDGET_BURST 100         // in ms : a device budget lets the messages of this duration go at once
+#define OUTPUT_MESSAGE_VALUES 16        // the arguments a cue or curve slot holds without allocating
+
+class EngineOutput;
+
+/** a class used to store where the playback plan thread sends each message of the plan (see Engine::playPlaybackPlan) */
+class EnginePlanRouting {
+    
+public:
+    std::vector<EngineBundleDestination> destinations;      /// where to send the bundles
+    std::vector<int>                destinationOf;          /// the destination of each message, -1 if it isn't bundled
+    std::vector<EngineOutput*>      outputOf;               /// the output of each message, NULL to send it from the playback plan thread
+    std::vector<unsigned int>       curveOf;                /// the curve slot of each message in its output, OUTPUT_CURVES_MAX for a cue
+};
+
+/** a class used to store a message waiting in an output queue : the cue slot, or the curve slot holding the last sample of a curve */
+class EngineOutputMessage {
+    
+public:
+    unsigned int    curve = OUTPUT_CURVES_MAX;              /// the curve slot, OUTPUT_CURVES_MAX for a cue
+    unsigned int    cue = 0;                                /// the cue slot of a cue
+};
+
+/** a class used to store a message queued after the queue of its output was full : a cue, or the curve slot of a sample following such a cue */
+class EngineOverflowMessage {
+    
+public:
+    unsigned int    curve = OUTPUT_CURVES_MAX;              /// the curve slot, OUTPUT_CURVES_MAX for a cue
+    TTAddress       address;                                /// the jamoma address of a cue
+    TTValue         value;                                  /// the value of a cue
+};
+
+/** a class used to store a cue waiting in an output : the slots are allocated with the output and reused */
+class EngineCueSlot {
+    
+public:
+    TTAddress           address;                            /// the jamoma address of the cue
+    TTValue             value;                              /// the value of the cue
+    
+    EngineCueSlot() { value.reserve(OUTPUT_MESSAGE_VALUES); }
+};
+
+/** a class used to store the last sample of a curve waiting in an output : a newer sample replaces it */
+class EngineCurveSlot {
+    
+public:
+    std::atomic<bool>   locked;                             /// a spin lock protecting the members below
+    bool                pending;                            /// the slot is in the queue of its output
+    TTAddress           address;                            /// the jamoma address of the curve
+    TTValue             value;                              /// the last sample to send
+    unsigned int        device;                             /// the device budget of the curve, OUTPUT_DEVICES_MAX for none
+    
+    EngineCurveSlot() : locked(false), pending(false), device(OUTPUT_DEVICES_MAX) { value.reserve(OUTPUT_MESSAGE_VALUES); }
+};
+
+/** a class used to limit the messages an output sends to a device by second (a token bucket) */
+class EngineDeviceBudget {
+    
+public:
+    std::atomic<unsigned int> messagesBySecond;             /// the budget, 0 for no limit
+    double              tokens;                             /// the messages which can be sent now (output thread only)
+    std::chrono::steady_clock::time_point refill;           /// when the tokens were last refilled (output thread only)
+    
+    EngineDeviceBudget() : messagesBySecond(0), tokens(0) {}
+};
+
+/** a class used to measure the queue of an output */
+class EngineOutputMetrics {
+    
+public:
+    unsigned int        depth = 0;                          /// the number of messages waiting to be sent
+    unsigned int        maxDepth = 0;                       /// the highest depth reached
+    unsigned long long  sentMessages = 0;                   /// the number of messages sent
+    unsigned long long  droppedSamples = 0;                 /// the curve samples replaced by a newer one before being sent
+    unsigned int        overflowDepth = 0;                  /// the messages waiting in the overflow of the full queue
+    unsigned int        maxOverflowDepth = 0;               /// the highest overflow depth reached
+    unsigned long long  budgetDrops = 0;                    /// the curve samples dropped because their device was over its budget
+};
+
+/** a map to store the metrics of the outputs by protocol name */
+typedef std::map<std::string, EngineOutputMetrics> EngineOutputMetricsMap;
+
+/** a class used to send the messages of a protocol from a dedicated thread (see Engine::sendOutputMessages) */
+class EngineOutput {
+    
+public:
+    std::string         protocol;                           /// the protocol name
+    TTObject            sender;                             /// #TTSender used by the output thread only
+    std::thread         thread;                             /// sends the messages of the queues
+    BoundedQueue<EngineOutputMessage> queue;                /// the messages to send, in their order (a curve slot is queued once at most)
+    std::unique_ptr<EngineCueSlot[]> cues;                  /// the cue slots, one by message of the queue
+    BoundedQueue<unsigned int> freeCues;                    /// the cue slots which are not queued
+    std::deque<EngineOverflowMessage> overflow;             /// the messages queued after the queue was full, in their order (protected by overflowMutex)
+    std::mutex          overflowMutex;                      /// protects overflow
+    std::unique_ptr<EngineCurveSlot[]> curves;              /// the curve slots
+    std::unordered_map<AddressHandle, unsigned int> curvesIndex; /// the slot of each curve address, retained by the output (protected by Engine::m_outputsMutex)
+    std::unique_ptr<EngineDeviceBudget[]> budgets;          /// the budgets of the devices
+    std::map<std::string, unsigned int> budgetsIndex;       /// the budget of each device name (protected by Engine::m_outputsMutex)
+    std::mutex          mutex;                              /// protects stop, and the sleep of the thread
+    std::condition_variable condition;                      /// wakes the output thread up when a message is queued
+    std::atomic<bool>   sleeping;                           /// the output thread waits for a message
+    bool                stop;                               /// asks the output thread to stop once the queues are empty
+    std::atomic<int>    depth;                              /// the number of messages waiting
+    std::atomic<unsigned int> maxDepth;                     /// the highest depth reached
+    std::atomic<unsigned long long> sentMessages;           /// the number of messages sent
+    std::atomic<unsigned long long> droppedSamples;         /// the curve samples replaced before being sent
+    std::atomic<unsigned int> overflowDepth;                /// the number of messages in overflow
+    std::atomic<unsigned int> maxOverflowDepth;             /// the highest overflow depth reached
+    std::atomic<unsigned long long> budgetDrops;            /// the curve samples dropped for the budget of their device
+    
+    EngineOutput(unsigned int capacity) : queue(capacity), cues(new EngineCueSlot[capacity]), freeCues(capacity),
+        curves(new EngineCurveSlot[OUTPUT_CURVES_MAX]), budgets(new EngineDeviceBudget[OUTPUT_DEVICES_MAX]),
+        sleeping(false), stop(false), depth(0), maxDepth(0), sentMessages(0), droppedSamples(0), overflowDepth(0), maxOverflowDepth(0), budgetDrops(0)
+    {
+        for (unsigned int cue = 0; cue < capacity; cue++)
+            freeCues.push(cue);
+    }
+};
+
 #define NO_BOUND -1
 
 #define NO_ID 0
@@ -91,7 +327,14 @@ typedef std::map<std::string, std::string> EngineFilesMap;
 
 #define NO_MAX_MODIFICATION 0
 
+#define EDITING_PASSES 2                // Jamoma moves one box at a time : the boxes of a transaction are moved again if another move shifted them
+#define NO_MAX_AGE 0
+#define VALUE_CACHE_MAX_AGE 500         // in ms : a cached value older than this is read again from the device
+
+#define ADDRESS_CACHE_SIZE 4096         // the number of converted addresses to remember (see toTTAddress)
+
 #define CURVE_POW 1
+#define CURVE_SAMPLE_RATE 40            // the samples by second of a new curve
 
 /// define part dedicated for debugging
 #define iscoreEngineDebug if (accessApplicationLocalDebug)
@@ -130,6 +373,59 @@ private:
     
     EngineConditionsMap m_conditionsMap;                                /// All conditions Ids (in i-score point of view) mapped to corresponding triggers id
 
+    EngineTimeEventsMap m_timeEventMap;                                 /// The time box id and control point of each time event (kept in sync with m_timeBoxMap)
+    EngineIntervalsMap  m_intervalEventsMap;                            /// The interval id of each pair of start and end time events (kept in sync with m_intervalMap)
+
+    EngineDevicesValuesMap m_valueCacheMap;                             /// The last known value of the device parameters already requested, by device and address
+    std::mutex          m_valueCacheMutex;                              /// m_valueCacheMap values are updated by the network threads
+    std::deque<std::string> m_valueReads;                               /// the addresses whose value the value reader has to read (protected by m_valueCacheMutex)
+    std::set<std::string> m_valueReadsPending;                          /// the addresses of m_valueReads, to queue each one once (protected by m_valueCacheMutex)
+    std::thread         m_valueReader;                                  /// reads the values asked by peekCachedValue and prefetchCachedValues
+    std::condition_variable m_valueReaderCondition;                     /// wakes the value reader up when a read is queued
+    bool                m_valueReaderStop;                              /// asks the value reader to stop (protected by m_valueCacheMutex)
+
+    AddressTrie*        m_addresses;                                    /// the interned i-score addresses, shared with the gui : the maps below are keyed by their handle
+    EngineCachedAddresses m_addressCache;                               /// The jamoma address of the last converted i-score addresses (see toTTAddress)
+    EngineAddressesMap  m_addressCacheIndex;                            /// The index of the cached addresses in m_addressCache
+    unsigned int        m_addressCacheHand;                             /// The next cached address to evict if it is not referenced
+    unsigned int        m_addressCacheSize;                             /// The maximal size of m_addressCache (0 to disable it)
+    std::mutex          m_addressCacheMutex;                            /// addresses are converted from the network and scheduler threads too
+    std::recursive_mutex m_namespaceMutex;                              /// locked for each access to the devices namespaces, explored from the NamespaceExplorer threads too
+    std::multiset<std::string> m_namespacesRebuilding;                  /// the devices whose namespace is being rebuilt : it is not read meanwhile (see accessNamespaceDirectory)
+    
+    unsigned int        m_editingDepth;                                 /// the number of beginEditing not committed yet
+    TemporalSolver      m_editingSolver;                                /// mirrors the boxes and relations, as the transaction leaves them
+    bool                m_editingSolverLoaded;                          /// false when m_editingSolver must be read from the engine again (see loadEditingSolver)
+    EngineBoxesDatesMap m_editedBoxes;                                  /// the last dates given to each box moved in the transaction
+    EngineRelationsBoundsMap m_editedRelations;                         /// the last bounds given to each relation changed in the transaction
+    std::set<TimeBoxId> m_editingMovedBoxes;                            /// the boxes shifted by the solver during the transaction
+    bool                m_editingSolved;                                /// false if boxes were moved since the last solve of the transaction
+    bool                m_editingRefused;                               /// true if a relation change of the transaction was refused
+    
+    EnginePlaybackPlan  m_playbackPlan;                                 /// the compiled messages sorted by date (see compilePlaybackPlan)
+    TimeValue           m_playbackPlanBegin;                            /// the date where the compiled portion starts
+    TimeValue           m_playbackPlanEnd;                              /// the date where the compiled portion ends
+    std::set<AddressHandle> m_playbackPlanAddresses;                    /// the addresses of the planned messages, retained until the plan is cleared
+    TTObject            m_planSender;                                   /// #TTSender used by the playback plan thread only
+    std::thread         m_planThread;                                   /// plays the playback plan
+    std::mutex          m_planMutex;                                    /// protects m_planStop, m_planStatistics and m_lookaheadStatistics
+    std::condition_variable m_planCondition;                            /// wakes the playback plan thread up when it has to stop
+    bool                m_planStop;                                     /// asks the playback plan thread to stop
+    std::atomic<bool>   m_planRunning;                                  /// the playback plan thread is sending messages
+    std::atomic<TimeValue> m_planDate;                                  /// the date of the last message sent by the playback plan thread
+    EnginePlanStatistics m_planStatistics;                              /// how late the playback plan messages were sent
+    std::atomic<unsigned int> m_planLookahead;                          /// how long (in ms) before their date the messages to m_bundleDevices are sent (0 to send them at their date)
+    std::set<std::string> m_bundleDevices;                              /// the OSC devices which honor the time tag of the bundles
+    EngineLookaheadStatisticsMap m_lookaheadStatistics;                 /// how far ahead the bundles were sent, by device
+    
+    std::map<std::string, EngineOutput*> m_outputs;                     /// the output of each protocol, created on first use
+    std::map<std::string, EngineOutput*> m_outputsByDevice;             /// the output of each device, to avoid asking jamoma for each message
+    unsigned int        m_outputQueueCapacity;                          /// the number of messages an output queue holds (0 to send them inline)
+    std::map<std::string, unsigned int> m_deviceBudgets;                /// the messages by second each device accepts (see setDeviceMessageBudget)
+    std::mutex          m_outputsMutex;                                 /// protects the members above and the curvesIndex and budgetsIndex of the outputs
+    std::atomic<unsigned int> m_outputTick;                             /// how long (in ms) the outputs coalesce the curve samples between two sendings (0 to send them at once)
+    std::map<std::pair<TimeBoxId, AddressHandle>, unsigned int> m_nominalSampleRates; /// the sample rate of the curves lowered for the budget of their device, by retained address (see adaptCurveSampleRates)
+
     EngineCacheMap      m_startCallbackMap;                             /// All callback to observe when a time process starts stored using a time process id
     EngineCacheMap      m_endCallbackMap;                               /// All callback to observe when a time process ends stored using a time process id
     
@@ -140,12 +436,14 @@ private:
     TTObject            m_iscore;                                       /// #TTApplication dedicated to i-score
     TTObject            m_sender;                                       /// #TTSender to send message to any application
     TTObject            m_namespaceObserver;                            /// #TTCallback to be notified when a node is created in learn mode
+    std::vector<TTObject> m_transportDataList;                          /// #TTData exposing transport features under i-score:/Transport (to control i-score remotly)
     
 	void (*m_TimeEventStatusAttributeCallback)(ConditionedTimeBoxId, bool);         // allow to notify the Maquette if a triggerpoint is pending
     void (*m_TimeProcessSchedulerRunningAttributeCallback)(TimeBoxId, bool);        // allow to notify the Maquette if a box is running or not
     void (*m_TransportDataValueCallback)(TTSymbol&, const TTValue&);                // allow to notify the Maquette if the transport features have been used remotly (via OSC messages for example)
     void (*m_NetworkDeviceNamespaceCallback)(TTSymbol&);                            // allow to notify the Maquette if a device's namespace have changed (see in setDeviceLearn)
     void (*m_NetworkDeviceConnectionError)(TTSymbol&, TTSymbol&);                   // allow to notify the Maquette if a device connection failed
+    void (*m_CachedValueReadCallback)(const std::string&, const std::string&);      // allow to notify the Maquette when a value asked by peekCachedValue has been read
 
 public:
 
@@ -163,6 +461,7 @@ public:
            void(*transportDataValueCallback)(TTSymbol&, const TTValue&),
            void (*networkDeviceNamespaceCallback)(TTSymbol&),
            void (*m_NetworkDeviceConnectionError)(TTSymbol&, TTSymbol&),
+           void (*cachedValueReadCallback)(const std::string&, const std::string&),
            std::string pathToTheJamomaFolder);
     
     void initModular(const char* pathToTheJamomaFolder = NULL);
@@ -170,8 +469,29 @@ public:
     
     void registerIscoreToProtocols();
     
+    /*!
+     * Exposes Play, Stop, Pause, Rewind, StartPoint and Speed messages under i-score:/Transport
+     * so that the transport features can be used remotly (via OSC messages for example)
+     */
+    void registerIscoreTransportData();
+    
     void dumpAddressBelow(TTNodePtr aNode);
     
+    /*!
+     * Gets the directory of the device of an address, m_namespaceMutex being locked by the caller.
+     * A device rebuilding its namespace has no directory : its nodes change without the lock,
+     * which is never held across the network exchanges.
+     *
+     * \param anAddress : an address of the device
+     * \return the directory, or NULL if the device is unknown or being rebuilt
+     */
+    TTNodeDirectoryPtr accessNamespaceDirectory(TTAddress& anAddress);
+    
+    /*!
+     * Marks the namespace of a device as being rebuilt, or rebuilt.
+     */
+    void setNamespaceRebuilding(const std::string & deviceName, bool rebuilding);
+    
     ~Engine();
 	const std::vector<std::string>& workingProtocols() 
 	{ return m_workingProtocols; }
@@ -187,6 +507,10 @@ public:
     void                uncacheTimeBox(TimeBoxId boxId);
     void                clearTimeBox();
     
+    void                cacheTimeEvents(TimeBoxId boxId);
+    void                uncacheTimeEvents(TimeBoxId boxId);
+    TimeBoxId           getTimeEventBoxId(TTObject& timeEvent, TimeEventIndex& controlPointId);
+    
     TimeBoxId           getParentId(TimeBoxId boxId);
     void                getChildrenId(TimeBoxId boxId, std::vector<TimeBoxId>& childrenId);
     
@@ -283,6 +607,70 @@ public:
 	 */
 	void changeTemporalRelationBounds(IntervalId relationId, BoundValue minBound, BoundValue maxBound, std::vector<TimeBoxId>& movedBoxes);
     
+    /*!
+	 * Starts an edit transaction : box moves (performBoxEditing) are only remembered, and relation bounds changes
+	 * (changeTemporalRelationBounds) are checked with them by a TemporalSolver, their movedBoxes staying empty
+	 * until commitEditing. Meanwhile the dates and bounds read from the engine are the ones before the transaction.
+	 * The solver mirrors the boxes and relations between the transactions : it is only read from the engine again
+	 * after the editions made outside of a transaction.
+	 * Transactions can be nested : the editions are applied by the outermost commitEditing.
+	 */
+	void beginEditing();
+    
+    /*!
+	 * Applies the editions remembered since beginEditing, the last one of each box or relation only :
+	 * the constraints of all the moved boxes are solved once, then the edited boxes are moved where the solver
+	 * put them together, with the boxes shifted by their relations.
+	 * Nothing is changed if an edition was refused or if the engine doesn't reach these dates.
+	 *
+	 * \param movedBoxes : empty vector, will be filled with the ID of the edited boxes and of the boxes moved by the editions.
+	 *
+	 * \return false if the editions were refused (true for a nested commit)
+	 */
+	bool commitEditing(std::vector<TimeBoxId>& movedBoxes);
+    
+    /*!
+	 * \return true between beginEditing and commitEditing
+	 */
+	bool isEditing();
+    
+    /*!
+	 * Moves a box during an edit transaction and solves its relations at once, to show the move while dragging :
+	 * the box is pinned at these dates with the other edited boxes, and commitEditing applies the dates found
+	 * without solving them again. Outside of a transaction, it is performBoxEditing.
+	 *
+	 * \param boxId : the ID of the box edited
+	 * \param start : new begin value of the box
+	 * \param end : new end value of the box
+	 * \param movedBoxes : empty vector, will be filled with the ID of the boxes shifted by the move (the edited boxes excepted)
+	 *
+	 * \return false if the move breaks the relations : the transaction forgets it then
+	 */
+	bool previewBoxEditing(TimeBoxId boxId, TimeValue start, TimeValue end, std::vector<TimeBoxId>& movedBoxes);
+    
+    /*!
+	 * Changes the bounds of a relation during an edit transaction as changeTemporalRelationBounds, to show the change
+	 * while dragging : a refused change is forgotten instead of refusing the whole transaction.
+	 *
+	 * \param relationId : the relation to change the bounds.
+	 * \param minBound : the min bound for the box relation in ms.
+	 * \param maxBound : the max bound for the box relation in ms. NO_BOUND if the max bound is not used (+infinity).
+	 * \param movedBoxes : empty vector, will be filled with the ID of the boxes shifted by the change.
+	 *
+	 * \return false if the change is refused (or outside of a transaction)
+	 */
+	bool previewTemporalRelationBounds(IntervalId relationId, BoundValue minBound, BoundValue maxBound, std::vector<TimeBoxId>& movedBoxes);
+    
+    /*!
+	 * Gets the dates of a box as the edit transaction leaves them.
+	 * Outside of a transaction, these are the dates of the engine.
+	 *
+	 * \param boxId : the box
+	 * \param begin : will be filled with its begin date (in ms)
+	 * \param end : will be filled with its end date (in ms)
+	 */
+	void getEditedBoxDates(TimeBoxId boxId, TimeValue& begin, TimeValue& end);
+    
 	/*!
 	 * Checks if a relation exists between the two given control points.
 	 *
@@ -345,7 +733,7 @@ public:
 	 * \param maxSceneWidth : the max scene width
 	 * \param movedBoxes : empty vector, will be filled with the ID of the boxes moved by this resolution
 	 *
-	 * \return true if the move is allowed or false if the move is forbidden
+	 * \return true if the move is allowed or false if the move is forbidden (during an edit transaction, a move breaking the relations is refused by commitEditing)
 	 */
 	bool performBoxEditing(TimeBoxId boxId, TimeValue start, TimeValue end, std::vector<TimeBoxId>& movedBoxes);
     
@@ -617,7 +1005,7 @@ public:
 	 * \param boxId : the Id of the box.
 	 * \param address : curve address.
 	 *
-	 * \return the sample rate (0 if this address is not present as a curve).
+	 * \return the sample rate (0 if this address is not present as a curve), as set even if it is lowered during the execution.
 	 */
 	unsigned int getCurveSampleRate(TimeBoxId boxId, const std::string & address);
     
@@ -989,6 +1377,140 @@ public:
 	 */
 	float getExecutionSpeedFactor(TimeBoxId boxId = ROOT_BOX_ID);
     
+    /*!
+     * Compiles a fixed portion of the main scenario into a playback plan : the messages of the control points
+     * and the samples of the curves of the boxes, sorted by date, with their addresses and values parsed once.
+     * The portion stops at the first trigger point or loop, whose dates depend on the execution.
+     * Muted boxes, control points and curves are left out, like curve samples equal to the previous one without redundancy.
+     *
+     * \param begin : the date (in ms) where the portion starts.
+     * \param end : the date where the portion should end (0 for the end of the main scenario), set to where it actually ends.
+     * \return the number of messages of the plan.
+     */
+    unsigned int compilePlaybackPlan(TimeValue begin, TimeValue & end);
+    
+    /*!
+     * Stops and forgets the playback plan.
+     */
+    void clearPlaybackPlan();
+    
+    /*!
+     * Plays the compiled playback plan in a dedicated thread, which sends each message at its date
+     * instead of walking the scenario.
+     *
+     * \return false if the plan is empty or already playing.
+     */
+    bool playPlaybackPlan();
+    
+    /*!
+     * Stops the playback plan and waits for its thread.
+     *
+     * \return true if the plan was playing.
+     */
+    bool stopPlaybackPlan();
+    
+    /*!
+     * Tests if the playback plan is still sending messages.
+     */
+    bool isPlayingPlaybackPlan();
+    
+    /*!
+     * Gets the date of the last message sent by the playback plan.
+     */
+    TimeValue getPlaybackPlanDate();
+    
+    /*!
+     * Gets how late the messages of the last playback plan execution were sent, to measure the jitter.
+     */
+    EnginePlanStatistics getPlaybackPlanStatistics();
+    
+    /*!
+     * Sets how long before their date the playback plan sends the messages of the devices with bundles
+     * (see setDeviceBundles), to absorb the scheduling hiccups : the messages are sent in OSC bundles
+     * time tagged with their date, and the device executes them on time.
+     * It is taken into account at the next playPlaybackPlan.
+     *
+     * \param lookahead : in ms, 0 to send every message at its date.
+     */
+    void setPlaybackLookahead(unsigned int lookahead);
+    
+    /*!
+     * Gets how long before their date the playback plan sends the messages of the devices with bundles.
+     */
+    unsigned int getPlaybackLookahead();
+    
+    /*!
+     * Sets if a device honors the time tag of OSC bundles, to receive the messages of the playback plan in advance.
+     *
+     * \param deviceName : the name of an OSC device.
+     * \param bundles : true to send bundles to the device when the lookahead is set.
+     * \return false if the device doesn't use the OSC protocol.
+     */
+    bool setDeviceBundles(const std::string & deviceName, bool bundles);
+    
+    /*!
+     * Tests if a device receives the messages of the playback plan in bundles.
+     */
+    bool getDeviceBundles(const std::string & deviceName);
+    
+    /*!
+     * Gets how far ahead of their time tag the bundles of the last playback plan execution were sent, by device.
+     */
+    EngineLookaheadStatisticsMap getPlaybackLookaheadStatistics();
+    
+    /*!
+     * Sets how many messages the output queue of each protocol holds.
+     * The messages sent by sendNetworkMessage and the playback plan are queued, and a dedicated thread
+     * by protocol sends them in their order, so a slow device doesn't delay the others or the scheduling.
+     * A curve sample waiting in the queue is replaced by a newer sample of its curve, and dropped when the queue is full.
+     * A cue is never dropped : when the queue is full, it waits in an overflow list with the messages following it
+     * rather than stalling the caller (see getOutputMetrics).
+     * The outputs are stopped, and created again on their next use.
+     *
+     * \param capacity : the number of messages, 0 to send the messages inline.
+     */
+    void setOutputQueueCapacity(unsigned int capacity);
+    
+    /*!
+     * Gets how many messages the output queue of each protocol holds (0 if the messages are sent inline).
+     */
+    unsigned int getOutputQueueCapacity();
+    
+    /*!
+     * Gets the depth of the output queues and their drops, by protocol.
+     */
+    EngineOutputMetricsMap getOutputMetrics();
+    
+    /*!
+     * Sets how many messages by second a device accepts, for the links which saturate.
+     * When the main scenario plays (or a playback plan is compiled), the sample rate of the curves of the device
+     * is lowered so that the curves running at the same time stay within the budget.
+     * The outputs also drop the curve samples of a device over its budget (the next sample carries a newer value).
+     * The cues are never dropped nor counted in the budget, so the curves can't delay them.
+     *
+     * \param deviceName : the device's name.
+     * \param messagesBySecond : the budget, 0 for no limit.
+     */
+    void setDeviceMessageBudget(const std::string & deviceName, unsigned int messagesBySecond);
+    
+    /*!
+     * Gets how many messages by second a device accepts (0 for no limit).
+     */
+    unsigned int getDeviceMessageBudget(const std::string & deviceName);
+    
+    /*!
+     * Sets how long the outputs wait between two sendings : the samples of a curve queued meanwhile
+     * are coalesced into the last one, and each sending only takes the messages queued before it.
+     *
+     * \param tick : in ms, 0 to send each message as soon as it is queued.
+     */
+    void setOutputTick(unsigned int tick);
+    
+    /*!
+     * Gets how long the outputs wait between two sendings (0 if they send each message as soon as it is queued).
+     */
+    unsigned int getOutputTick();
+    
     
 	//Network //////////////////////////////////////////////////////////////////////////////////////////////
     
@@ -1070,6 +1592,16 @@ public:
 	 */
 	std::vector<std::string> requestNetworkSnapShot(const std::string & address);
     
+	/*!
+	 * Sends a network snapshot request for several addresses at once.
+	 * The addresses are grouped by device so that each device directory is accessed once.
+	 *
+	 * \param addresses : the addresses to snapshot (see above).
+	 *
+	 * \return the snapshot message of each address having a value, by address.
+	 */
+	std::map<std::string, std::string> requestNetworkSnapShot(const std::vector<std::string> & addresses);
+    
 	/*!
 	 * Sends a network namespace request.
 	 * The address must look like this :
@@ -1104,6 +1636,47 @@ public:
      */
     int requestObjectAttributeValue(const std::string & address, const std::string & attribute, std::vector<std::string>& value);
     
+    /*!
+     * Gets the value of a parameter from the value cache.
+     * The first request reads the value from the device and observes it : then the cached value is updated
+     * each time the device notifies a new value (or a message is received for an OSC device),
+     * until the cache of the device is cleared. A value older than maxAge is read again from the device.
+     * This can wait for the network : the GUI uses peekCachedValue.
+     *
+     * \param address : the parameter's address. ex : /deviceName/address1/address2/
+     * \param value : will be filled with the parameter value.
+     * \param maxAge : the age (in ms) from which the cached value is read again. NO_MAX_AGE to never read it again.
+     *
+     * \return True(1) or false(0) if the request failed or not.
+     */
+    int getCachedValue(const std::string & address, std::string & value, unsigned int maxAge = VALUE_CACHE_MAX_AGE);
+    
+    /*!
+     * Gets the value of a parameter from the value cache, without ever reading the device.
+     * A missing or old value is read by the value reader thread, which then calls the cachedValueReadCallback.
+     *
+     * \param address : the parameter's address. ex : /deviceName/address1/address2/
+     * \param value : will be filled with the cached value, even old.
+     *
+     * \return True(1) if a value was cached, false(0) if it is being read.
+     */
+    int peekCachedValue(const std::string & address, std::string & value);
+    
+    /*!
+     * Asks the value reader thread to cache the values of parameters before they are requested.
+     *
+     * \param addresses : the parameters' addresses. ex : /deviceName/address1/address2/
+     */
+    void prefetchCachedValues(const std::vector<std::string> & addresses);
+    
+    /*!
+     * Forgets the cached values of a device and stops to observe its parameters.
+     * This is needed each time the device namespace is rebuilt or the device is removed.
+     *
+     * \param deviceName : the device name, all devices if empty.
+     */
+    void clearValueCache(const std::string & deviceName = "");
+    
     /*!
      * Set an attribute value.
      *
@@ -1288,6 +1861,16 @@ public:
      * \return 1 if the storage succeed
 	 */
 	int store(std::string filepath);
+
+	/*!
+	 * Store Engine into memory, as it would be stored into a file :
+	 * the file can then be written by another thread.
+	 *
+	 * \param filepath : the filepath the project will be written to.
+	 * \param xml : filled with the content of the project file.
+     * \return 1 if the storage succeed
+	 */
+	int store(std::string filepath, std::string &xml);
     
 	/*!
 	 * Load Engine.
@@ -1303,6 +1886,10 @@ public:
 	 * Prints on standard output both engines. Useful only for debug purpose.
 	 */
 	void print();
+    
+    /*!
+	 * Prints the progression of the running boxes on standard output until the main scenario stops.
+	 */
     void printExecutionInLinuxConsole();
     
     friend void TimeEventStatusAttributeCallback(const TTValue& baton, const TTValue& value);
@@ -1311,17 +1898,117 @@ public:
     friend void AutomationEndCallback(const TTValue& baton, const TTValue& value);
     friend void TriggerReceiverValueCallback(const TTValue& baton, const TTValue& value);
     friend void NamespaceCallback(const TTValue& baton, const TTValue& value);
-    
-private:
+    friend void TransportDataValueCallback(const TTValue& baton, const TTValue& value);
+    friend void CachedValueCallback(const TTValue& baton, const TTValue& value);
     
     /*!
      * Convert directory/address into directory:/address
+     * The last converted addresses are remembered (see setAddressCacheSize).
      *
      * \param networktreeAddress : an address managed by i-score
      * \return aTTAddress : an address managed by jamoma
      */
     TTAddress toTTAddress(std::string networktreeAddress);
     
+    /*!
+     * Convert an interned i-score address into a jamoma address, as toTTAddress does.
+     *
+     * \param networktreeAddress : the handle of an address managed by i-score (see AddressTrie)
+     * \return aTTAddress : an address managed by jamoma
+     */
+    TTAddress toTTAddress(AddressHandle networktreeAddress);
+    
+    /*!
+     * Sets how many converted addresses toTTAddress remembers.
+     * When the cache is full, an address not used since the last eviction is replaced (clock eviction).
+     *
+     * \param size : the number of addresses, 0 to disable the cache.
+     */
+    void setAddressCacheSize(unsigned int size);
+    
+private:
+    
+    /*!
+     * Gets the jamoma address of an interned address from the address cache, converting it on a miss.
+     *
+     * \param handle : the interned address
+     * \param networktreeAddress : the same address, as a string
+     */
+    TTAddress toTTAddress(AddressHandle handle, const std::string & networktreeAddress);
+    
+    /*!
+     * Removes the addresses of a device from the address cache, to release them with the device.
+     */
+    void forgetCachedAddresses(const std::string & deviceName);
+    
+    /*!
+     * Interns the address of a planned message, retained until the plan is cleared.
+     */
+    AddressHandle retainPlanAddress(const std::string & address);
+    
+    /*!
+     * Gives bounds to relations and dates to boxes, as computed by the solver of an edit transaction.
+     * Jamoma only moves one box at a time, propagating its relations : a box may only reach its date
+     * once the others have moved, so the misplaced boxes are moved again, EDITING_PASSES times at most.
+     *
+     * \param bounds : the min and max bounds of the relations to change (in ms)
+     * \param dates : the begin and end dates of the boxes to move (in ms)
+     *
+     * \return true if every box reached its dates
+     */
+    bool applyEditing(const EngineRelationsBoundsMap& bounds, const EngineBoxesDatesMap& dates);
+    
+    /*!
+     * Reads the dates of all the boxes and the bounds of all the relations into the solver of the edit transactions,
+     * if they were changed outside of a transaction since the last reading. The editions of the current transaction are kept.
+     */
+    void loadEditingSolver();
+    
+    /*!
+     * Changes the bounds of a relation in the solver of the edit transaction, solving them with the edited boxes.
+     *
+     * \param movedBoxes : will be filled with the boxes shifted by the change
+     *
+     * \return false if the change is refused : the solver is unchanged then
+     */
+    bool solveRelationBounds(IntervalId relationId, BoundValue minBound, BoundValue maxBound, std::vector<TimeBoxId>& movedBoxes);
+    
+    /*!
+     * Gets the value of a parameter object from the value cache (see getCachedValue).
+     *
+     * \param deviceName : the device of the parameter
+     * \param address : the handle of the parameter's address
+     * \param anObject : the parameter (or its mirror)
+     * \param value : will be filled with the parameter value.
+     * \param maxAge : the age (in ms) from which the cached value is read again.
+     *
+     * \return True(1) or false(0) if the request failed or not.
+     */
+    int getCachedValue(const std::string & deviceName, AddressHandle address, TTObject & anObject, std::string & value, unsigned int maxAge);
+    
+    /*!
+     * Queues the read of a value for the value reader thread, m_valueCacheMutex being locked by the caller.
+     */
+    void queueValueRead(const std::string & address);
+    
+    /*!
+     * Reads the queued values into the value cache : this is the value reader thread.
+     */
+    void readQueuedValues();
+    
+    /*!
+     * Stops the value reader thread, dropping the reads still queued.
+     */
+    void stopValueReader();
+    
+    /*!
+     * Convert directory/address into directory:/address without looking into the cache
+     *
+     * \param networktreeAddress : an address managed by i-score
+     * \return aTTAddress : an address managed by jamoma
+     */
+    TTAddress convertToTTAddress(const std::string & networktreeAddress);
+    
     /*!
      * Convert directory:/address into directory/address
      *
@@ -1329,6 +2016,112 @@ private:
      * \return networktreeAddress : an address managed by i-score
      */
     std::string toNetworkTreeAddress(TTAddress aTTAddress);
+    
+    /*!
+     * Appends the messages of a control point to the playback plan, parsed.
+     */
+    void planCtrlPointMessages(TimeBoxId boxId, TimeEventIndex controlPointIndex, TimeValue date);
+    
+    /*!
+     * Sends the messages of the playback plan at their date, and those of the devices with bundles
+     * in time tagged bundles m_planLookahead before their date (run by m_planThread).
+     *
+     * \param routing : where to send each message of the plan.
+     */
+    void playPlaybackPlanMessages(EnginePlanRouting routing);
+    
+    /*!
+     * Gets the output of the protocol of a device, and creates it if needed.
+     *
+     * \return NULL if the messages are sent inline or the device is unknown.
+     */
+    EngineOutput* accessOutput(const std::string & deviceName);
+    
+    /*!
+     * Gets the curve slot of an address in an output, and registers it if needed.
+     *
+     * \return OUTPUT_CURVES_MAX if the output has no slot left : the samples are sent as cues.
+     */
+    unsigned int accessOutputCurve(EngineOutput* output, const EnginePlannedMessage & message);
+    
+    /*!
+     * Gets the budget of a device in an output, and registers it if needed (m_outputsMutex has to be locked).
+     *
+     * \return OUTPUT_DEVICES_MAX if the output has no budget left : the messages of the device are not limited.
+     */
+    unsigned int accessOutputBudget(EngineOutput* output, const std::string & deviceName);
+    
+    /*!
+     * Takes a message from the budget of a device in an output (run by its thread).
+     *
+     * \return false if the device is over its budget.
+     */
+    bool spendOutputBudget(EngineOutput* output, unsigned int device);
+    
+    /*!
+     * Gets the absolute dates of the boxes (the dates of a sub box are relative to its parent).
+     */
+    void getBoxesAbsoluteDates(std::map<TimeBoxId, TimeValue> & boxesBegin, std::map<TimeBoxId, TimeValue> & boxesEnd);
+    
+    /*!
+     * Tests if a box or one of its parents is muted.
+     */
+    bool isBoxMutedInScore(TimeBoxId boxId);
+    
+    /*!
+     * Computes how much the sample rate of the curves of each device with a budget has to be lowered
+     * so that the curves running at the same time stay within the budget.
+     *
+     * \return the factor of each device over its budget.
+     */
+    std::map<std::string, float> getCurveSampleRateFactors();
+    
+    /*!
+     * Lowers the sample rate of the curves of the devices over their budget, until restoreCurveSampleRates.
+     */
+    void adaptCurveSampleRates();
+    
+    /*!
+     * Sets back the sample rate of the curves lowered by adaptCurveSampleRates.
+     */
+    void restoreCurveSampleRates();
+    
+    /*!
+     * Queues a cue in an output.
+     */
+    void outputCue(EngineOutput* output, const TTAddress & address, const TTValue & value);
+    
+    /*!
+     * Queues a curve sample in an output, replacing the previous sample of the curve if it is not sent yet.
+     */
+    void outputCurveSample(EngineOutput* output, unsigned int curve, const TTValue & value);
+    
+    /*!
+     * Queues a message in an output without waiting, and wakes the output thread up.
+     *
+     * \return false if the queue is full.
+     */
+    bool pushOutputMessage(EngineOutput* output, const EngineOutputMessage & message);
+    
+    /*!
+     * Appends a message to the overflow of an output, and wakes the output thread up.
+     */
+    void overflowOutputMessage(EngineOutput* output, const EngineOverflowMessage & message);
+    
+    /*!
+     * Counts a message queued in an output, and wakes the output thread up.
+     */
+    void notifyOutput(EngineOutput* output);
+    
+    /*!
+     * Sends the messages queued in an output (run by its thread).
+     */
+    void sendOutputMessages(EngineOutput* output);
+    
+    /*!
+     * Stops the output threads once their queues are empty, and deletes them.
+     */
+    void stopOutputs();
 };
 
 typedef Engine* EnginePtr;
@@ -1363,4 +2156,16 @@ void AutomationEndCallback(const TTValue& baton, const TTValue& value);
  @return                an error code */
 void NamespaceCallback(const TTValue& baton, const TTValue& value);
 
+/** Callback used each time a transport data is updated remotly
+ @param	baton			an EnginePtr and a transport feature name
+ @param	value			the value received
+ @return                an error code */
+void TransportDataValueCallback(const TTValue& baton, const TTValue& value);
+
+/** Callback used each time an observed parameter notifies a new value
+ @param	baton			an EnginePtr, a device name and an address
+ @param	value			the new value
+ @return                an error code */
+void CachedValueCallback(const TTValue& baton, const TTValue& value);
+
 #endif // __SCORE_ENGINE_H__
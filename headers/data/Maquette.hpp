@@ -50,6 +50,8 @@
 #include <QObject>
 #include <QPoint>
 #include <QTimer>
+#include <QUndoStack>
+#include <QVector>
 
 #include <vector>
 #include <map>
@@ -59,6 +61,7 @@
 #include <set>
 #include <sstream>
 #include "NetworkMessages.hpp"
+#include "MessagesComputer.hpp"
 #include "BasicBox.hpp"
 
 #include "Engine.h"
@@ -117,6 +120,38 @@ struct Coords {
   float sizeY;
 };
 
+/*!
+ * \struct BoxPlacement
+ * \brief Dates and vertical position of a box, as kept by the Engines : unlike pixels, the dates don't depend on the zoom.
+ */
+struct BoxPlacement {
+  TimeValue begin;    //!< Begin date (in ms, relative to the mother).
+  TimeValue end;      //!< End date (in ms, relative to the mother).
+  float topLeftY;
+  float sizeY;
+};
+
+/*!
+ * \struct BoxMoveRecord
+ * \brief Placement of a box before and after a move.
+ */
+struct BoxMoveRecord {
+  unsigned int boxID;
+  BoxPlacement before;
+  BoxPlacement after;
+};
+
+/*!
+ * \struct SortedMessages
+ * \brief Messages of a box extremity sorted by priority.
+ * Forgotten when the messages of the extremity change, and valid while the priorities are unchanged.
+ */
+struct SortedMessages {
+  std::vector<std::string> sorted;
+  unsigned int prioritiesRevision;  //!< The NetworkTree::prioritiesRevision the messages were sorted with.
+  bool isSorted;                    //!< False while the sort is computed in background.
+};
+
 /*!
  * \class MyDevice
  *
@@ -262,6 +297,14 @@ class Maquette : public QTimer
      */
     std::vector<std::string> requestNetworkSnapShot(const std::string &address);
 
+    /*!
+     * \brief Requests a snapshot of several addresses to the Engines.
+     *
+     * \param addresses : the addresses to be snapped.
+     * \return the snapshot message of each address, by address
+     */
+    std::map<std::string, std::string> requestNetworkSnapShot(const std::vector<std::string> &addresses);
+
     /*!
      * \brief Adds a curve at specified address.
      *
@@ -394,14 +437,21 @@ class Maquette : public QTimer
     QString getAbsoluteAddress(QTreeWidgetItem *item);
 
     /*!
-     * \brief Sorts messages by priority than alphabetical.
+     * \brief Sorts the messages of a box extremity by priority than alphabetical.
+     * The sorted messages are kept until the messages of the extremity or the priorities of the items change.
      *
+     * \param boxID : the box of the messages
+     * \param controlPoint : the extremity of the box
      * \param messages : message to sort
      *
-     * \return if itemsSelected could be set
+     * \return the sorted messages
      */
-    std::vector<std::string> sortByPriority(NetworkMessages *messages);
-    static int compareByPriority(const QPair<QTreeWidgetItem *, std::string> v1, const QPair<QTreeWidgetItem *, std::string> v2);
+    std::vector<std::string> sortByPriority(unsigned int boxID, unsigned int controlPoint, const QMap<QTreeWidgetItem *, Message> &messages);
+
+    /*!
+     * \brief Gets the priority keys of the items of messages, kept by the NetworkTree (see NetworkTree::priorityKey).
+     */
+    QMap<QTreeWidgetItem *, unsigned int> itemsPriorities(const QMap<QTreeWidgetItem *, Message> &messages) const;
 
 
     /*!
@@ -465,6 +515,19 @@ class Maquette : public QTimer
      */
     bool setEndMessagesToSend(unsigned int boxID, NetworkMessages *messages, bool sort = true);
 
+    /*!
+     * \brief Sets the messages of a box extremity, and computes the messages to send and the curves in background.
+     * The box messages are set (and the edit recorded) right away, the Engine is updated when the computation
+     * ends : then boxMessagesComputed() is emitted. A new call for the same box supersedes the pending one.
+     *
+     * \param boxID : the box to set messages to
+     * \param controlPoint : BEGIN_CONTROL_POINT_INDEX or END_CONTROL_POINT_INDEX
+     * \param messages : the new set of the messages
+     *
+     * \return if messages could be set
+     */
+    bool setMessagesToSendInBackground(unsigned int boxID, unsigned int controlPoint, NetworkMessages *messages);
+
     /*!
      * \brief Sends a specific message with current device.
      *
@@ -649,6 +712,71 @@ class Maquette : public QTimer
      */
     bool updateBox(unsigned int boxID, const Coords &coord);
 
+    /*!
+     * \brief Gets the undo stack of the score edits.
+     */
+    QUndoStack *undoStack(){ return _undoStack; }
+
+    /*!
+     * \brief Starts collecting the boxes moved by updateBox into a single undo command.
+     * The moves are sent to the Engines in one edit transaction, applied by endBoxesMove().
+     * Only the boxes edited or moved by the transaction are recorded.
+     */
+    void beginBoxesMove();
+
+    /*!
+     * \brief Commits the moves to the Engines, updates the boxes they moved once
+     * and pushes the boxes moved since beginBoxesMove() as a single undo command.
+     *
+     * \return false if one of the moves was refused by the Engines
+     */
+    bool endBoxesMove();
+
+    /*!
+     * \brief Starts previewing the editions while dragging, in an edit transaction of the Engines : until endBoxesPreview(),
+     * updateBox() and changeRelationBounds() only move the boxes where the solver of the transaction puts them.
+     * Does nothing if a preview is already started.
+     */
+    void beginBoxesPreview();
+
+    /*!
+     * \brief Commits the edit transaction of the preview : the Engines get the dates the preview showed, without solving them again.
+     * The boxes are put back where the Engines keep them if the transaction is refused.
+     *
+     * \return false if one of the moves was refused by the Engines
+     */
+    bool endBoxesPreview();
+
+    /*!
+     * \brief Checks if a preview is started (see beginBoxesPreview()).
+     */
+    inline bool isPreviewing() const { return _previewing; }
+
+    /*!
+     * \brief Puts boxes back to given placements in one boxes move, without recording an undo command.
+     *
+     * \param placements : the dates and vertical position of each box
+     */
+    void restoreBoxes(const QMap<unsigned int, BoxPlacement> &placements);
+
+    /*!
+     * \brief Puts back the bounds of a relation, without recording an undo command.
+     *
+     * \param relID : the relation to be changed
+     * \param minBoundMS : the minimal bound in ms (NO_BOUND if not used)
+     * \param maxBoundMS : the maximal bound in ms (NO_BOUND if not used)
+     */
+    void restoreRelationBounds(unsigned int relID, int minBoundMS, int maxBoundMS);
+
+    /*!
+     * \brief Puts back the start or end messages of a box, without recording an undo command.
+     *
+     * \param boxID : the box to be changed
+     * \param controlPoint : BEGIN_CONTROL_POINT_INDEX or END_CONTROL_POINT_INDEX
+     * \param messages : the messages to be set, by address (their items are found in the namespace tree)
+     */
+    void restoreMessages(unsigned int boxID, unsigned int controlPoint, const QMap<QString, Message> &messages);
+
     /*!
      * \brief Informs relations that boxes have been moved.
      */
@@ -707,11 +835,13 @@ class Maquette : public QTimer
     unsigned int nextBoxNumber();
 
     /*!
-     * \brief Saves the current composition into a file.
+     * \brief Saves the current composition into memory, as it would be saved into a file.
      *
-     * \param fileName : the file to save current composition into
+     * \param fileName : the file the composition will be written to
+     * \param content : filled with the content of the file
+     * \return true if the composition has been saved
      */
-    void save(const std::string &fileName);
+    bool save(const std::string &fileName, std::string &content);
 
     /*!
      * \brief Loads a file into a new composition.
@@ -763,6 +893,23 @@ class Maquette : public QTimer
      */
     int requestObjectAttribruteValue(const std::string &address, const std::string &attributeName, std::vector<std::string>& value);    
 
+    /*!
+     * \brief Gets the cached value of a parameter without waiting for the device.
+     * A missing or old value is read in the background : valueRead is emitted once it is.
+     *
+     * \param address : the parameter's address.
+     * \param value : will be filled with the cached value.
+     * \return true if a value was cached.
+     */
+    bool peekCachedValue(const std::string &address, std::string &value);
+
+    /*!
+     * \brief Reads the values of parameters in the background, before they are requested.
+     *
+     * \param addresses : the parameters' addresses.
+     */
+    void prefetchValues(const std::vector<std::string> &addresses);
+
     void setRangeBoundMin(unsigned int boxID, const string &address, float value);
     void setRangeBoundMax(unsigned int boxID, const string &address, float value);
 
@@ -770,6 +917,26 @@ class Maquette : public QTimer
      * \brief Update boxes from Engines.
      */
     void updateBoxesFromEngines();
+
+    /*!
+     * \brief Updates boxes coordinates after a zoom change.
+     *
+     * Coordinates are computed from the dates kept by the boxes :
+     * the Engine is only queried for boxes moved since the last zoom.
+     * Only the visible boxes are laid out at once, the others when they are scrolled into view
+     * or in small batches when the application is idle.
+     */
+    void rescaleBoxes();
+
+    /*!
+     * \brief Lays out the boxes visible in the view which are not laid out since the last zoom.
+     */
+    void rescaleVisibleBoxes();
+
+    /*!
+     * \brief Lays out all the boxes not laid out since the last zoom, before their coordinates are used.
+     */
+    void flushBoxesRescale();
     inline MaquetteScene *
     scene(){ return _scene; }
     static const unsigned int SIZE;
@@ -806,12 +973,18 @@ class Maquette : public QTimer
 	signals:
 		 void boxIsRunningSignal(unsigned int boxId, bool running);
 		 void deviceConnectionFailed(QString, QString);
+		 void valueRead(QString address, QString value);
 	
 		 void triggerPointIsActiveSignal(unsigned int trgID, bool active);
 		 void playOrResumeSignal();
 		 void stopOrPauseSignal();
 		 void changeTimeOffsetSignal(unsigned int);
 		 void changeSpeedSignal(double);
+
+		 /*!
+		  * \brief Emitted when the messages to send and the curves of a box have been computed in background.
+		  */
+		 void boxMessagesComputed(unsigned int boxID);
   
   public slots:
     /*
@@ -820,6 +993,16 @@ class Maquette : public QTimer
      */ 
 
     void boxIsRunningSlot(unsigned int boxId, bool running);
+
+    /*!
+     * \brief Sends the computed messages of a box to the Engine and updates its curves.
+     */
+    void messagesComputed(const MessagesResult &result);
+
+    /*!
+     * \brief Lays out a batch of the boxes not laid out since the last zoom, and asks for the next batch.
+     */
+    void rescalePendingBoxes();
     /*!
      * \brief Sets the time offset value in ms where the engine will start from at the nex execution. The boolean "mute" mutes or not the dump of all messages (the scene state at timeOffset).
      */
@@ -1015,6 +1198,57 @@ class Maquette : public QTimer
      */
     void updateCurves(unsigned int boxID, const std::vector<std::string> &startMsgs, const std::vector<std::string> &endMsgs);
 
+    /*!
+     * \brief Adds and removes curves of a box (see MessagesComputer::detectCurves).
+     */
+    void applyCurvesChanges(unsigned int boxID, const std::vector<std::string> &curvesToAdd, const std::vector<std::string> &curvesToRemove);
+
+    /*!
+     * \brief Abandons the background computation of a box messages (see setMessagesToSendInBackground).
+     * If one was pending, the messages of the other extremity are sent to the Engine now.
+     *
+     * \param controlPoint : the extremity which is going to be set.
+     */
+    void cancelMessagesComputation(unsigned int boxID, unsigned int controlPoint);
+
+    /*!
+     * \brief Moves a box in the preview (see beginBoxesPreview()).
+     *
+     * \return false if the solver of the Engines refuses the move
+     */
+    bool previewBox(unsigned int boxID, const Coords &coord);
+
+    /*!
+     * \brief Updates a set of boxes from the dates of the preview transaction.
+     *
+     * \param movedBoxes : boxes to be updated
+     */
+    void updateBoxesFromEditing(const std::vector<unsigned int> &movedBoxes);
+
+    /*!
+     * \brief Commits the edit transaction of the Engines begun by beginBoxesMove() and places the boxes it moved.
+     *
+     * \return false if the transaction was refused
+     */
+    bool commitBoxesMove();
+
+    /*!
+     * \brief Gets the sorted messages of a box extremity if they are still valid.
+     *
+     * \return false if the messages have to be sorted again
+     */
+    bool findSortedMessages(unsigned int boxID, unsigned int controlPoint, std::vector<std::string> &sorted);
+
+    /*!
+     * \brief Forgets the sorted messages of a box extremity, before its messages change.
+     */
+    void forgetSortedMessages(unsigned int boxID, unsigned int controlPoint);
+
+    /*!
+     * \brief Gets the current revision of the items priorities (see NetworkTree::prioritiesRevision).
+     */
+    unsigned int prioritiesRevision() const;
+
     /*!
      * \brief Updates a set of boxes from Engines coordinates.
      *
@@ -1022,6 +1256,52 @@ class Maquette : public QTimer
      */
     void updateBoxesFromEngines(const std::vector<unsigned int> &movedBoxes);
 
+    /*!
+     * \brief Sets the coordinates of a box from its dates. All the boxes are placed with this function,
+     * so that a box is at the same pixels whatever the edition or zoom which placed it.
+     *
+     * \param box : the box to place
+     * \param date : its date (in ms, relative to its mother)
+     * \param duration : its duration (in ms)
+     * \return false if the box was already there
+     */
+    bool placeBox(BasicBox *box, TimeValue date, TimeValue duration);
+
+    /*!
+     * \brief Places a box not laid out since the last zoom, from the dates it keeps or from the Engines.
+     */
+    void rescaleBox(unsigned int boxID);
+
+    /*!
+     * \brief Moves a box in the edit transaction begun by beginBoxesMove(), to exact dates.
+     * The box is placed by the caller if the move is accepted, and put back where the Engines keep it otherwise.
+     *
+     * \return false if the Engines can not perform the move
+     */
+    bool updateBox(unsigned int boxID, const BoxPlacement &placement);
+
+    /*!
+     * \brief Gets the placement of a box in the Engines : during an edit transaction, its placement before the transaction.
+     */
+    BoxPlacement enginesPlacement(unsigned int boxID);
+
+    /*!
+     * \brief Gets the placement of a box as displayed, from the dates it keeps or from its pixels.
+     */
+    BoxPlacement displayedPlacement(BasicBox *box) const;
+
+    /*!
+     * \brief Records the placement of a box before the current boxes move, if it is not recorded yet.
+     */
+    void recordBoxBefore(unsigned int boxID, const BoxPlacement &placement);
+
+    /*!
+     * \brief Pushes a single undo command for the recorded boxes whose placement changed, read back from the Engines.
+     *
+     * \param before : the placements of the boxes before the move (see recordBoxBefore())
+     */
+    void pushBoxesMove(const QMap<unsigned int, BoxPlacement> &before);
+
     //! The MaquetteScene managing display and interaction.
     MaquetteScene *_scene;
 
@@ -1063,6 +1343,22 @@ class Maquette : public QTimer
     bool _recording;    //!< Handling recording state.
     bool _paused;       //!< Handling paused state.
     bool _zooming = false;
+    static const unsigned int RESCALE_BATCH;    //!< The boxes laid out by rescalePendingBoxes() at once.
+    std::set<unsigned int> _boxesToRescale;     //!< The boxes not laid out since the last zoom (mothers have lower IDs).
+    bool _rescaleScheduled = false;             //!< True while rescalePendingBoxes() is waiting to be called.
+
+    static const int UNDO_LIMIT;                //!< Maximum number of commands kept in the undo stack.
+    QUndoStack *_undoStack = nullptr;           //!< The edits that can be undone.
+    bool _recordUndo = true;                    //!< False while an undo command is applied.
+    bool _collectBoxesMove = false;             //!< True between beginBoxesMove() and endBoxesMove() (an Engine edit transaction).
+    QMap<unsigned int, BoxPlacement> _boxesBeforeMove;   //!< The placements of the boxes touched by the move, before it (when recorded).
+    QMap<unsigned int, BoxPlacement> _collectedBoxes;    //!< The placements of the boxes moved in the transaction, applied vertically on success.
+
+    MessagesComputer *_messagesComputer;        //!< Computes the messages to send and the curves in background.
+
+    bool _previewing = false;                   //!< True between beginBoxesPreview() and endBoxesPreview().
+    QMap<unsigned int, QPair<int, int> > _previewBounds;   //!< The bounds (in ms) of the relations changed during the preview, before it.
+    std::map<std::pair<unsigned int, unsigned int>, SortedMessages> _sortedMessages; //!< Sorted messages by box and extremity.
 
     QDomDocument *_doc; //!< Handling document used for saving/loading.
 
@@ -1113,4 +1409,12 @@ void deviceCallback(TTSymbol& deviceName);
  * \param errorInfo : inforamtion about why it failed
  */
 void deviceConnectionErrorCallback(TTSymbol& deviceName, TTSymbol& errorInfo);
+
+/*!
+ * \brief Callback called from the Engine value reader when a value asked by peekCachedValue has been read
+ *
+ * \param address : the parameter's address
+ * \param value : its value
+ */
+void cachedValueReadCallback(const std::string& address, const std::string& value);
 #endif
@@ -0,0 +1,162 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef MESSAGESCOMPUTER_HPP
+#define MESSAGESCOMPUTER_HPP
+
+/*!
+ * \file MessagesComputer.hpp
+ */
+
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "NetworkMessages.hpp"
+
+class QTreeWidgetItem;
+
+/*!
+ * \brief What the MessagesComputer needs to compute the messages of a box, copied on the GUI thread.
+ */
+struct MessagesJob
+{
+  unsigned int boxID;
+  unsigned int generation;                          //!< Set by MessagesComputer::compute.
+  QMap<QTreeWidgetItem *, Message> startMessages;
+  QMap<QTreeWidgetItem *, Message> endMessages;
+  QMap<QTreeWidgetItem *, unsigned int> priorities; //!< The priority key of the items (never dereferenced by the thread, see NetworkTree::priorityKey).
+  bool startIsSorted = false;                       //!< The start messages are already sorted in sortedStartMessages.
+  bool endIsSorted = false;                         //!< The end messages are already sorted in sortedEndMessages.
+  std::vector<std::string> sortedStartMessages;
+  std::vector<std::string> sortedEndMessages;
+  std::vector<std::string> curvesAddresses;         //!< The curves of the box when the job was asked.
+};
+
+/*!
+ * \brief The messages of a box, sorted by priority, and the curves to add or remove.
+ */
+struct MessagesResult
+{
+  unsigned int boxID;
+  unsigned int generation;
+  std::vector<std::string> startMessages;
+  std::vector<std::string> endMessages;
+  std::vector<std::string> curvesToAdd;
+  std::vector<std::string> curvesToRemove;
+};
+
+/*!
+ * \class MessagesComputer
+ *
+ * \brief Computes the messages to send of boxes and detects their curves in a background thread.
+ *
+ * A new job for a box supersedes the previous one : a pending job is replaced, a running job
+ * is abandoned at its next step, and the result of a superseded job is never delivered.
+ * Results are delivered in the GUI thread with computed(), where they can be applied to the Engine.
+ */
+class MessagesComputer : public QObject
+{
+  Q_OBJECT
+
+  public:
+    MessagesComputer(QObject *parent = nullptr);
+
+    /*!
+     * \brief Abandons the pending jobs and waits for the running one.
+     */
+    ~MessagesComputer();
+
+    /*!
+     * \brief Asks the messages of a box to be computed, superseding the previous job of this box.
+     */
+    void compute(MessagesJob job);
+
+    /*!
+     * \brief Abandons the job of a box, if any.
+     *
+     * \return true if a job was pending, running or waiting for its delivery.
+     */
+    bool cancel(unsigned int boxID);
+
+    /*!
+     * \brief Computes messages and sorts them by priority (none last) then alphabetically.
+     *
+     * \param messages : the messages to compute
+     * \param priorities : the priority key of the items, an item without key has no priority
+     */
+    static std::vector<std::string> sortByPriority(const QMap<QTreeWidgetItem *, Message> &messages,
+                                                   const QMap<QTreeWidgetItem *, unsigned int> &priorities);
+
+    /*!
+     * \brief Detects the curves to add (addresses with different start and end values)
+     * and the curves to remove (addresses which are not both at start and end anymore).
+     */
+    static void detectCurves(const std::vector<std::string> &startMsgs, const std::vector<std::string> &endMsgs,
+                             const std::vector<std::string> &curvesAddresses,
+                             std::vector<std::string> &curvesToAdd, std::vector<std::string> &curvesToRemove);
+
+  signals:
+    void computed(const MessagesResult &result);
+
+  private slots:
+    void deliver();
+
+  private:
+    void run();
+    bool isSuperseded(const MessagesJob &job);
+
+    std::thread _thread;                                  //!< Runs the jobs.
+    std::mutex _mutex;                                    //!< Protects the members below.
+    std::condition_variable _condition;                   //!< Wakes the thread up when a job is asked.
+    std::map<unsigned int, MessagesJob> _jobs;            //!< The pending jobs by box.
+    std::map<unsigned int, unsigned int> _generations;    //!< The last job generation by box.
+    std::vector<MessagesResult> _results;                 //!< The results waiting to be delivered.
+    unsigned int _running;                                //!< The box of the running job (NO_ID if none).
+    bool _stop;                                           //!< Asks the thread to stop.
+};
+
+#endif // MESSAGESCOMPUTER_HPP
@@ -127,7 +127,7 @@ class NetworkMessages : public QObject {
 
     inline QList<QTreeWidgetItem *> getItems(){ return _messages.keys(); }
     inline Message getMessage(QTreeWidgetItem *item){return _messages.value(item); }
-    std::string computeMessage(const Message &msg);
+    static std::string computeMessage(const Message &msg);
     std::string computeMessageWithoutValue(const Message &msg);
     inline QList<Message> messages(){ return _messages.values(); }
     QMap<QString, QString> toMapAddressValue();
@@ -149,7 +149,7 @@ class NetworkMessages : public QObject {
     void messagesChanged();
 
   private:
-    bool messageToString(const Message &msg, string &device, string &message, string &value);
+    static bool messageToString(const Message &msg, string &device, string &message, string &value);
 
     QMap<QTreeWidgetItem *, Message> _messages; //!<Messages list.
 
@@ -0,0 +1,118 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef OSCBUNDLE_HPP
+#define OSCBUNDLE_HPP
+
+/*!
+ * \file OSCBundle.hpp
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * \class OSCMessage
+ *
+ * \brief An OSC message (address, type tags and arguments) encoded as it is sent.
+ */
+class OSCMessage
+{
+  public:
+    OSCMessage(const std::string &address);
+
+    void addInt(int32_t value);
+    void addFloat(float value);
+    void addString(const std::string &value);
+
+    /*!
+     * \brief Gets the encoded message.
+     */
+    std::vector<char> data() const;
+
+  private:
+    std::string _address;           //!< The OSC address, ex : /foo/bar.
+    std::string _types;             //!< The type tags, ex : ,ifs.
+    std::vector<char> _arguments;   //!< The encoded arguments.
+};
+
+/*!
+ * \class OSCBundle
+ *
+ * \brief An OSC bundle of messages with a time tag : a receiver honoring it executes the messages
+ * at that time instead of when it receives them.
+ */
+class OSCBundle
+{
+  public:
+    static const uint64_t IMMEDIATELY = 1; //!< The time tag of the messages to execute when received.
+
+    OSCBundle(uint64_t timeTag = IMMEDIATELY);
+
+    /*!
+     * \brief Converts a date into an OSC time tag (NTP format : seconds since 1900 and 32 bits fraction).
+     */
+    static uint64_t timeTag(std::chrono::system_clock::time_point date);
+
+    /*!
+     * \brief Empties the bundle and sets its time tag.
+     */
+    void clear(uint64_t timeTag);
+
+    void add(const OSCMessage &message);
+
+    /*!
+     * \brief Gets the number of messages of the bundle.
+     */
+    unsigned int size() const;
+
+    /*!
+     * \brief Gets the encoded bundle.
+     */
+    const std::vector<char> &data() const;
+
+  private:
+    std::vector<char> _data;    //!< "#bundle", the time tag and the sized messages.
+    unsigned int _size;         //!< The number of messages.
+};
+
+#endif // OSCBUNDLE_HPP
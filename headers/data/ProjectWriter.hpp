@@ -0,0 +1,111 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef PROJECTWRITER_HPP
+#define PROJECTWRITER_HPP
+
+/*!
+ * \file ProjectWriter.hpp
+ */
+
+#include <QObject>
+#include <QString>
+#include <thread>
+
+/*!
+ * \class ProjectWriter
+ *
+ * \brief Writes project files without blocking the interface.
+ *
+ * The Engine is not thread safe : the score is first stored by the Engine into memory
+ * on the GUI thread, then a background thread writes it into the project file.
+ * The project file is replaced atomically (a crash during the save never leaves a truncated project)
+ * and its previous version is kept in a "<project>.backups" folder.
+ * Backups are whole versions named after their content, so that identical versions are stored once.
+ */
+class ProjectWriter : public QObject
+{
+  Q_OBJECT
+
+  public:
+    ProjectWriter(QObject *parent = nullptr);
+
+    /*!
+     * \brief Waits for the last write to be finished.
+     */
+    ~ProjectWriter();
+
+    /*!
+     * \brief Writes the content of a project file in a background thread.
+     *
+     * \param content : the project as stored by the Engine
+     * \param fileName : the project file to write
+     */
+    void write(const QByteArray &content, const QString &fileName);
+
+    /*!
+     * \brief Blocks until the last write is finished.
+     *
+     * \return false if the last write failed
+     */
+    bool waitForFinished();
+
+    static const int MAX_BACKUPS;   //!< Number of distinct versions kept for each project.
+
+  signals:
+    /*!
+     * \brief Emitted from the background thread when a project has been written.
+     */
+    void written(const QString &fileName, bool success);
+
+  private:
+    void writeProject(const QByteArray &content, const QString &fileName);
+
+    /*!
+     * \brief Copies the current version of a project into its backups folder,
+     * unless an identical version is already there.
+     */
+    static void backupProject(const QString &fileName);
+
+    std::thread _thread;    //!< The thread writing the last saved project.
+    bool _success;          //!< Whether the last write succeeded, set by the thread before it ends.
+};
+
+#endif // PROJECTWRITER_HPP
@@ -0,0 +1,247 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef TEMPORALSOLVER_HPP
+#define TEMPORALSOLVER_HPP
+
+/*!
+ * \file TemporalSolver.hpp
+ */
+
+#include <map>
+#include <utility>
+#include <vector>
+
+/*!
+ * \class TemporalSolver
+ *
+ * \brief A simple temporal network mirroring the dates of the boxes and the bounds of the relations,
+ * to compute where an edition moves the boxes without asking the Engines.
+ *
+ * The dates of a box are relative to its mother, as in the Engines. An edition pins the edited boxes
+ * at their new dates : the other boxes keep their duration, can't go before 0, and the relations keep
+ * the distance between two control points within their bounds. These constraints are checked with
+ * Bellman-Ford, starting from the current dates so that only the edition is propagated : a negative cycle
+ * means they contradict each other, and the edition is refused. Only the boxes linked to the edited ones
+ * and their relations are part of the network.
+ * Then each box linked to the edited ones is put at the allowed date nearest to its current one,
+ * the allowed dates being given by the shortest paths of the network, and narrowed from each placed box.
+ */
+class TemporalSolver
+{
+  public:
+    /*!
+     * \brief Forgets all the boxes and relations.
+     */
+    void clear();
+
+    /*!
+     * \brief Checks if the network has no box.
+     */
+    bool isEmpty() const;
+
+    /*!
+     * \brief Adds a box or sets its dates, without checking the relations.
+     *
+     * \param boxID : the box
+     * \param begin : its begin date (in ms)
+     * \param end : its end date (in ms)
+     */
+    void setBox(unsigned int boxID, unsigned int begin, unsigned int end);
+
+    /*!
+     * \brief Adds a relation or sets its bounds, without checking them.
+     * Bounds are read as the Engines do : NO_BOUND or 0 for the max bound means no max bound.
+     *
+     * \param relID : the relation
+     * \param firstBoxID, firstControlPoint : the control point where the relation starts
+     * \param secondBoxID, secondControlPoint : the control point where the relation ends
+     * \param minBound, maxBound : the bounds of the distance between the control points (in ms)
+     */
+    void setRelation(unsigned int relID, unsigned int firstBoxID, unsigned int firstControlPoint,
+                     unsigned int secondBoxID, unsigned int secondControlPoint, int minBound, int maxBound);
+
+    /*!
+     * \brief Sets the bounds of a known relation, without checking them.
+     *
+     * \return false if the relation is unknown
+     */
+    bool setRelationBounds(unsigned int relID, int minBound, int maxBound);
+
+    /*!
+     * \brief Forgets a box and its relations.
+     */
+    void removeBox(unsigned int boxID);
+
+    /*!
+     * \brief Forgets a relation.
+     */
+    void removeRelation(unsigned int relID);
+
+    /*!
+     * \brief Moves a box and shifts the boxes constrained by its relations.
+     *
+     * \param boxID : the box to move
+     * \param begin : its new begin date (in ms)
+     * \param end : its new end date (in ms)
+     * \param movedBoxes : will be filled with the boxes shifted by the move (the box itself excepted)
+     *
+     * \return false if the move is refused : nothing is changed then
+     */
+    bool moveBox(unsigned int boxID, int begin, int end, std::vector<unsigned int> &movedBoxes);
+
+    /*!
+     * \brief Moves several boxes at once and shifts the boxes constrained by their relations.
+     *
+     * \param dates : the new begin and end dates of the boxes to move (in ms)
+     * \param movedBoxes : will be filled with the boxes shifted by the move (the moved boxes excepted)
+     *
+     * \return false if the move is refused : nothing is changed then
+     */
+    bool moveBoxes(const std::map<unsigned int, std::pair<int, int> > &dates, std::vector<unsigned int> &movedBoxes);
+
+    /*!
+     * \brief Changes the bounds of a relation and shifts the boxes linked to its first box if they are broken.
+     *
+     * \param movedBoxes : will be filled with the boxes shifted by the change
+     *
+     * \return false if the change is refused : nothing is changed then
+     */
+    bool changeRelationBounds(unsigned int relID, int minBound, int maxBound, std::vector<unsigned int> &movedBoxes);
+
+    /*!
+     * \brief Changes the bounds of a relation while some boxes stay at given dates.
+     *
+     * \param dates : the dates of the boxes which can't be shifted (in ms), its first box stays where it is if empty
+     * \param movedBoxes : will be filled with the boxes shifted by the change (the given boxes excepted)
+     *
+     * \return false if the change is refused : nothing is changed then
+     */
+    bool changeRelationBounds(unsigned int relID, int minBound, int maxBound,
+                              const std::map<unsigned int, std::pair<int, int> > &dates, std::vector<unsigned int> &movedBoxes);
+
+    /*!
+     * \brief Gets the dates of a box.
+     *
+     * \return false if the box is unknown
+     */
+    bool boxDates(unsigned int boxID, unsigned int &begin, unsigned int &end) const;
+
+    /*!
+     * \brief Gets the boxes of the network.
+     */
+    std::vector<unsigned int> boxes() const;
+
+  private:
+    static const long long UNBOUNDED;   //!< The max bound of a relation without max bound, or an unreachable distance.
+
+    struct Box {
+      long long begin;
+      long long end;
+      std::vector<unsigned int> relations;      //!< The relations starting or ending at this box.
+    };
+
+    struct Relation {
+      unsigned int firstBoxID;
+      unsigned int firstControlPoint;
+      unsigned int secondBoxID;
+      unsigned int secondControlPoint;
+      long long minBound;
+      long long maxBound;
+    };
+
+    /*!
+     * \brief An edge of the network : the date of its "to" node minus the date of its "from" node is at most its weight.
+     */
+    struct Edge {
+      unsigned int from;
+      unsigned int to;
+      long long weight;
+    };
+
+    typedef std::vector<std::vector<std::pair<unsigned int, long long> > > Adjacency;
+
+    /*!
+     * \brief Pins boxes at some dates and puts the boxes linked to them at the nearest allowed dates.
+     *
+     * \param pinnedBoxes : the boxes which can't be shifted, with their dates
+     * \param movedBoxes : will be filled with the boxes shifted (the pinned boxes excepted)
+     * \param linkedBoxes : other boxes whose relations must be kept, even if they aren't linked to the pinned ones
+     *
+     * \return false if the constraints can't be kept : nothing is changed then
+     */
+    bool solve(const std::map<unsigned int, std::pair<long long, long long> > &pinnedBoxes, std::vector<unsigned int> &movedBoxes,
+               const std::vector<unsigned int> &linkedBoxes = std::vector<unsigned int>());
+
+    /*!
+     * \brief Computes potentials making all the edges weights positive (Johnson).
+     *
+     * \param potential : the starting potentials, to be lowered where they break an edge
+     *
+     * \return false if the network has a negative cycle
+     */
+    static bool bellmanFord(unsigned int nbNodes, const std::vector<Edge> &edges, std::vector<long long> &potential);
+
+    /*!
+     * \brief Computes the shortest distances from a node (or to it, on the reversed adjacency) with Dijkstra.
+     *
+     * \param adjacency : the edges reweighted by the potentials
+     * \param reversed : true if adjacency is reversed, to get the distances to the source
+     *
+     * \return the distances in the network, UNBOUNDED for the unreachable nodes
+     */
+    static std::vector<long long> distances(const Adjacency &adjacency, const std::vector<long long> &potential,
+                                            unsigned int source, bool reversed);
+
+    /*!
+     * \brief Lowers the bounds of the nodes by the paths from a node pinned at a date (or to it, on the reversed adjacency),
+     * visiting only the nodes whose bound is narrowed.
+     *
+     * \param date : the date of the source (minus its date on the reversed adjacency)
+     * \param bounds : the upper bounds of the nodes (the lower bounds negated on the reversed adjacency)
+     */
+    static void narrow(const Adjacency &adjacency, const std::vector<long long> &potential, unsigned int source, long long date,
+                       bool reversed, std::vector<long long> &bounds);
+
+    std::map<unsigned int, Box> _boxes;             //!< The boxes by ID.
+    std::map<unsigned int, Relation> _relations;    //!< The relations by ID.
+};
+
+#endif // TEMPORALSOLVER_HPP
@@ -0,0 +1,139 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#ifndef UNDOCOMMANDS_HPP
+#define UNDOCOMMANDS_HPP
+
+/*!
+ * \file UndoCommands.hpp
+ *
+ * Undo commands pushed by the Maquette on its QUndoStack.
+ *
+ * Commands only hold what is needed to put the score back in a given state
+ * (ids, coordinates, bounds, messages maps) : the Engine stays the only owner of the score.
+ * An edit is applied before its command is pushed, so the first redo() does nothing.
+ */
+
+#include <QUndoCommand>
+#include <QVector>
+#include <QMap>
+#include <QTreeWidgetItem>
+
+#include "NetworkMessages.hpp"
+#include "Maquette.hpp"
+
+/*!
+ * \class BoxesMoveCommand
+ * \brief Moves or resizes a set of boxes.
+ *
+ * All the boxes moved by the edition are recorded, the ones moved by the constraints too,
+ * and are put back together in one edit transaction of the Engine.
+ */
+class BoxesMoveCommand : public QUndoCommand
+{
+  public:
+    BoxesMoveCommand(const QVector<BoxMoveRecord> &records, QUndoCommand *parent = nullptr);
+
+    void undo();
+    void redo();
+
+  private:
+    QVector<BoxMoveRecord> _records;
+    bool _firstRedo;
+};
+
+/*!
+ * \class RelationBoundsCommand
+ * \brief Changes the bounds of a temporal relation (in ms).
+ */
+class RelationBoundsCommand : public QUndoCommand
+{
+  public:
+    RelationBoundsCommand(unsigned int relID, int oldMin, int oldMax, int newMin, int newMax, QUndoCommand *parent = nullptr);
+
+    void undo();
+    void redo();
+
+    int id() const;
+
+    /*!
+     * \brief Successive changes of the same relation are merged into one command.
+     */
+    bool mergeWith(const QUndoCommand *other);
+
+  private:
+    unsigned int _relID;
+    int _oldMin, _oldMax;
+    int _newMin, _newMax;
+    bool _firstRedo;
+};
+
+/*!
+ * \class BoxMessagesCommand
+ * \brief Changes the start or end messages of a box.
+ *
+ * Messages are kept by address, not by item : the items of the namespace tree
+ * are deleted when it is refreshed.
+ */
+class BoxMessagesCommand : public QUndoCommand
+{
+  public:
+    BoxMessagesCommand(unsigned int boxID, unsigned int controlPoint,
+                       const QMap<QTreeWidgetItem *, Message> &oldMessages,
+                       const QMap<QTreeWidgetItem *, Message> &newMessages,
+                       QUndoCommand *parent = nullptr);
+
+    void undo();
+    void redo();
+
+    /*!
+     * \brief Gets messages by address (device and message, without value).
+     */
+    static QMap<QString, Message> messagesByAddress(const QMap<QTreeWidgetItem *, Message> &messages);
+
+  private:
+    unsigned int _boxID;
+    unsigned int _controlPoint;   //!< BEGIN_CONTROL_POINT_INDEX or END_CONTROL_POINT_INDEX
+    QMap<QString, Message> _oldMessages;
+    QMap<QString, Message> _newMessages;
+    bool _firstRedo;
+};
+
+#endif // UNDOCOMMANDS_HPP
@@ -68,9 +68,17 @@ headers/data/AbstractCurve.hpp \
 headers/data/AbstractRelation.hpp \
 headers/data/AbstractParentBox.hpp \
 headers/data/AbstractTriggerPoint.hpp \
+headers/data/AddressIndex.hpp \
+headers/data/AddressTrie.hpp \
+headers/data/BoundedQueue.hpp \
 headers/data/Engine.h \
 headers/data/Maquette.hpp \
+headers/data/MessagesComputer.hpp \
 headers/data/NetworkMessages.hpp \
+headers/data/OSCBundle.hpp \
+headers/data/ProjectWriter.hpp \
+headers/data/TemporalSolver.hpp \
+headers/data/UndoCommands.hpp \
 headers/GUI/AttributesEditor.hpp \
 headers/GUI/BasicBox.hpp \
 headers/GUI/Comment.hpp \
@@ -80,6 +88,7 @@ headers/GUI/LogarithmicSlider.hpp \
 headers/GUI/MainWindow.hpp \
 headers/GUI/MaquetteScene.hpp \
 headers/GUI/MaquetteView.hpp \
+headers/GUI/NamespaceModel.hpp \
 headers/GUI/NetworkTree.hpp \
 headers/GUI/ParentBox.hpp \
 headers/GUI/PlayingThread.hpp \
@@ -95,7 +104,8 @@ headers/IScoreApplication.hpp \
 headers/GUI/CurvesComboBox.hpp \
 headers/DelayedDelete.h \
 headers/GlobalEventFilter.h \
-headers/GUI/NetworkUpdater.h
+headers/GUI/NetworkUpdater.h \
+headers/GUI/NamespaceExplorer.hpp
 
 SOURCES += src/main.cpp \
 src/data/AbstractBox.cpp \
@@ -104,9 +114,16 @@ src/data/AbstractCurve.cpp \
 src/data/AbstractParentBox.cpp \
 src/data/AbstractRelation.cpp \
 src/data/AbstractTriggerPoint.cpp \
+src/data/AddressIndex.cpp \
+src/data/AddressTrie.cpp \
 src/data/Engine.cpp \
 src/data/Maquette.cpp \
+src/data/MessagesComputer.cpp \
 src/data/NetworkMessages.cpp \
+src/data/OSCBundle.cpp \
+src/data/ProjectWriter.cpp \
+src/data/TemporalSolver.cpp \
+src/data/UndoCommands.cpp \
 src/GUI/AttributesEditor.cpp \
 src/GUI/BasicBox.cpp \
 src/GUI/Comment.cpp \
@@ -116,6 +133,7 @@ src/GUI/LogarithmicSlider.cpp \
 src/GUI/MainWindow.cpp \
 src/GUI/MaquetteScene.cpp \
 src/GUI/MaquetteView.cpp \
+src/GUI/NamespaceModel.cpp \
 src/GUI/NetworkTree.cpp \
 src/GUI/ParentBox.cpp \
 src/GUI/PlayingThread.cpp \
@@ -129,4 +147,5 @@ src/GUI/ConditionalRelation.cpp \
 src/GUI/TriggerPointEdit.cpp \
 src/IScoreApplication.cpp \
 src/GUI/CurvesComboBox.cpp \
-src/GUI/NetworkUpdater.cpp
+src/GUI/NetworkUpdater.cpp \
+src/GUI/NamespaceExplorer.cpp
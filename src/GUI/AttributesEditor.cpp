@@ -46,6 +46,8 @@
 #include <QErrorMessage>
 #include "NetworkMessages.hpp"
 #include "NetworkTree.hpp"
+#include <QCompleter>
+#include <QStringListModel>
 
 static const float S_TO_MS = 1000.;
 
@@ -224,6 +226,14 @@ AttributesEditor::createWidgets()
   _networkTree = new NetworkTree(this);
   //_networkTree->load();
 
+  //Address search
+  _addressSearch = new QLineEdit;
+  _addressSearch->setPlaceholderText(tr("Search an address"));
+  _addressesFound = new QStringListModel(this);
+  _addressCompleter = new QCompleter(_addressesFound, this);
+  _addressCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  _addressSearch->setCompleter(_addressCompleter);
+
   //Start&End value
   _boxStartValue = new QDoubleSpinBox;
   _boxLengthValue = new QDoubleSpinBox;
@@ -253,7 +263,8 @@ AttributesEditor::addWidgetsToLayout()
 
   // Set Central Widget
   _centralLayout->addLayout(_boxSettingsLayout, 0, 1, Qt::AlignTop);
-  _centralLayout->addWidget(_networkTree, 1, 0, 1, 3);
+  _centralLayout->addWidget(_addressSearch, 1, 0, 1, 3);
+  _centralLayout->addWidget(_networkTree, 2, 0, 1, 3);
   _centralWidget->setLayout(_centralLayout);
   _centralLayout->setVerticalSpacing(verticalSpacing);
 
@@ -267,6 +278,8 @@ AttributesEditor::connectSlots()
   connect(_generalColorButton, SIGNAL(clicked()), this, SLOT(changeColor()));
   connect(_boxName, SIGNAL(returnPressed()), this, SLOT(nameChanged()));
   connect(_boxName, SIGNAL(textEdited(QString)), this, SLOT(removeForbiddenChar(QString)));
+  connect(_addressSearch, SIGNAL(textEdited(QString)), this, SLOT(searchAddresses(QString)));
+  connect(_addressCompleter, SIGNAL(activated(QString)), this, SLOT(showAddress(QString)));
 
   connect(_networkTree, SIGNAL(startMessageValueChanged(QTreeWidgetItem *)), this, SLOT(startMessageChanged(QTreeWidgetItem *)));
   connect(_networkTree, SIGNAL(endMessageValueChanged(QTreeWidgetItem *)), this, SLOT(endMessageChanged(QTreeWidgetItem *)));
@@ -289,6 +302,8 @@ AttributesEditor::connectSlots()
   connect(_networkTree, SIGNAL(rangeBoundMaxChanged(QTreeWidgetItem*,float)), this, SLOT(changeRangeBoundMax(QTreeWidgetItem*, float)));
   connect(_networkTree, SIGNAL(recModeChanged(QTreeWidgetItem*)), this, SLOT(changeRecMode(QTreeWidgetItem*)));
 
+  connect(Maquette::getInstance(), SIGNAL(boxMessagesComputed(unsigned int)), this, SLOT(boxMessagesComputed(unsigned int)));
+
 
   /// \todo Ajouter les spinBox ci-dessous. Attention problème : ces signaux sont automatiquement appelés lorsque l'on sélectionne simplement une boite (setAttributes (...) updateWidgets()). Une erreur d'arrondi (certainement) fait que la date de start de plusieurs boite est modifié au simple click...
   //  connect(_boxStartValue, SIGNAL(valueChanged(double)), this, SLOT(startChanged()));
@@ -391,6 +406,19 @@ void AttributesEditor::removeForbiddenChar(QString newName)
     }
 }
 
+void
+AttributesEditor::searchAddresses(const QString &text)
+{
+  _addressesFound->setStringList(_networkTree->findAddresses(text));
+  _addressCompleter->complete();
+}
+
+void
+AttributesEditor::showAddress(const QString &address)
+{
+  _networkTree->showAddress(address.toStdString());
+}
+
 void AttributesEditor::currentColorSelectionChanged(const QColor& color)
 {
 	if (_boxEdited != NO_ID)
@@ -431,8 +459,6 @@ AttributesEditor::changeColor()
 void
 AttributesEditor::startMessagesChanged(bool forceUpdate)
 {        
-  BasicBox * box = _scene->getBox(_boxEdited);
-
   if (_scene->paused()) {
         _scene->stopAndGoToCurrentTime();
     }
@@ -440,17 +466,16 @@ AttributesEditor::startMessagesChanged(bool forceUpdate)
   if (_boxEdited != NO_ID) {
       QMap<QTreeWidgetItem*, Data> items = _networkTree->assignedItems();
       Maquette::getInstance()->setSelectedItemsToSend(_boxEdited, items);
-      Maquette::getInstance()->setStartMessagesToSend(_boxEdited, _networkTree->startMessages());
+
+      // the curves are updated in boxMessagesComputed()
+      _forceCurvesUpdate = _forceCurvesUpdate || forceUpdate;
+      Maquette::getInstance()->setMessagesToSendInBackground(_boxEdited, BEGIN_CONTROL_POINT_INDEX, _networkTree->startMessages());
 
       _networkTree->updateStartMsgsDisplay();      
 
       //Case scenario start cue
       if(_boxEdited == ROOT_BOX_ID)
           _scene->view()->resetCachedContent();
-      else{
-          _networkTree->updateCurves(_boxEdited, forceUpdate);
-          box->updateCurves();
-      }
     }
   else{
       _scene->displayMessage("No box selected", INDICATION_LEVEL);
@@ -465,25 +490,42 @@ AttributesEditor::endMessagesChanged(bool forceUpdate)
       }
 
   if (_boxEdited != NO_ID) {
-
-      BasicBox * box = _scene->getBox(_boxEdited);
-
       QMap<QTreeWidgetItem*, Data> items = _networkTree->assignedItems();
       Maquette::getInstance()->setSelectedItemsToSend(_boxEdited, items);
-      Maquette::getInstance()->setEndMessagesToSend(_boxEdited, _networkTree->endMessages());
+
+      // the curves are updated in boxMessagesComputed()
+      _forceCurvesUpdate = _forceCurvesUpdate || forceUpdate;
+      Maquette::getInstance()->setMessagesToSendInBackground(_boxEdited, END_CONTROL_POINT_INDEX, _networkTree->endMessages());
+
       if(_boxEdited == ROOT_BOX_ID)
           _scene->view()->resetCachedContent();
-      else{
+      else
           _networkTree->updateEndMsgsDisplay();
-          _networkTree->updateCurves(_boxEdited, forceUpdate);
-          box->updateCurves();
-      }      
     }
   else {
       _scene->displayMessage("No box selected", INDICATION_LEVEL);
     }
 }
 
+void
+AttributesEditor::boxMessagesComputed(unsigned int boxID)
+{
+  if (boxID == ROOT_BOX_ID) {
+      return;
+    }
+
+  BasicBox * box = _scene->getBox(boxID);
+
+  if (boxID == _boxEdited) {
+      _networkTree->updateCurves(boxID, _forceCurvesUpdate);
+      _forceCurvesUpdate = false;
+    }
+
+  if (box != nullptr) {
+      box->updateCurves();
+    }
+}
+
 void
 AttributesEditor::startMessageChanged(QTreeWidgetItem *item)
 {
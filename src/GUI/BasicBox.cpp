@@ -109,6 +109,8 @@ const QString BasicBox::SCENARIO_MODE_TEXT = tr("Scenario");
 const QString BasicBox::DEFAULT_MODE_TEXT = "Select content to edit";
 const QColor BasicBox::BOX_COLOR = QColor(60, 60, 60);
 const QColor BasicBox::TEXT_COLOR = QColor(0, 0, 0);
+const float BasicBox::LOW_DETAIL_ZOOM_THRESHOLD = 0.25;
+const float BasicBox::LOW_DETAIL_MAX_WIDTH = 200.;
 
 BasicBox::BasicBox(const QPointF &press, const QPointF &release, MaquetteScene *parent)
   : QGraphicsObject()
@@ -427,6 +429,7 @@ BasicBox::init()
   setGraphicsEffect(_recEffect);
 
   _hover = false;
+  _lowDetail = false;
 
   updateBoxSize();
 
@@ -1975,6 +1978,17 @@ BasicBox::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidg
 {
     Q_UNUSED(widget);
     painter->setClipRect(option->exposedRect);//To increase performance
+
+    //Low zoom level : only a flat rect, no header, text, curves nor proxies
+    if (lowDetail()) {
+        if (!_lowDetail)
+            updateLevelOfDetail();
+        drawLowDetail(painter);
+        setOpacity(_mute ? 0.4 : 1);
+        return;
+    }
+    _lowDetail = false;
+
     bool smallSize = _abstract->width() <= 3 * RESIZE_TOLERANCE;
 
     //Set disabled the curve proxy when box not selected.
@@ -2089,6 +2103,61 @@ BasicBox::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidg
     setOpacity(_mute ? 0.4 : 1);
 }
 
+bool
+BasicBox::lowDetail() const
+{
+    if (_playing || _hover || isSelected())
+        return false;
+
+    return _scene->zoom() < LOW_DETAIL_ZOOM_THRESHOLD && width() < LOW_DETAIL_MAX_WIDTH;
+}
+
+void
+BasicBox::updateLevelOfDetail()
+{
+    bool low = lowDetail();
+    if (low == _lowDetail)
+        return;
+
+    _lowDetail = low;
+    if (_lowDetail) {
+        _curveProxy->setVisible(false);
+        setButtonsVisible(false);
+        _comboBoxProxy->setVisible(false);
+        _muteButton->setVisible(false);
+        _loopButton->setVisible(false);
+    }
+    update();
+}
+
+void
+BasicBox::drawLowDetail(QPainter *painter)
+{
+    const QColor color = isSelected() ? _color : _colorUnselected;
+    const QSize size(qMax(1, (int)_boxRect.width()), qMax(1, (int)_boxRect.height()));
+
+    //Boxes sharing color and size share the same pixmap
+    QString key = QString("BasicBox_lod_%1_%2_%3").arg(color.rgba()).arg(size.width()).arg(size.height());
+    QPixmap pix;
+    if (!QPixmapCache::find(key, &pix)) {
+        pix = QPixmap(size);
+        pix.fill(Qt::transparent);
+
+        QPainter pixPainter(&pix);
+        QColor fill(color);
+        fill.setAlpha(60);
+        pixPainter.fillRect(0, 0, size.width(), size.height(), fill);
+        pixPainter.fillRect(0, 0, size.width(), qMin((int)(RESIZE_TOLERANCE - LINE_WIDTH), size.height()), color);
+        pixPainter.setPen(QPen(color, LINE_WIDTH));
+        pixPainter.drawRect(QRectF(0, 0, size.width(), size.height()).adjusted(LINE_WIDTH / 2., LINE_WIDTH / 2., -(LINE_WIDTH / 2.), -(LINE_WIDTH / 2.)));
+        pixPainter.end();
+
+        QPixmapCache::insert(key, pix);
+    }
+
+    painter->drawPixmap(_boxRect.topLeft(), pix);
+}
+
 void
 BasicBox::displayBoxDuration(){
     float duration = this->duration()/1000.;
@@ -47,6 +47,7 @@
 #include "MaquetteView.hpp"
 #include "HeaderPanelWidget.hpp"
 #include "NetworkTree.hpp"
+#include "ProjectWriter.hpp"
 
 #include <QResource>
 #include <QString>
@@ -123,6 +124,9 @@ MainWindow::MainWindow()
 
   setCentralWidget(_centralWidget);
 
+  _projectWriter = new ProjectWriter(this);
+  connect(_projectWriter, SIGNAL(written(QString,bool)), this, SLOT(projectWritten(QString,bool)));
+
   // Creation of widgets
   createActions();
   createMenus();
@@ -182,6 +186,8 @@ MainWindow::~MainWindow()
     //delete _copyAct;
     //delete _pasteAct;
     _selectAllAct->deleteLater();
+    _undoAct->deleteLater();
+    _redoAct->deleteLater();
 //    delete _commentModeAct;
 
     _helpDialog->deleteLater();
@@ -219,14 +225,14 @@ void
 MainWindow::closeEvent(QCloseEvent *event)
 {
   writeSettings();
-  if (_scene->documentModified()) {
+  if (documentModified()) {
       int ret = QMessageBox::question(_view, tr("Document modified"),
                                       tr("The document was modified.\n\nDo you want to save before leaving ?"),
                                       QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel,
                                       QMessageBox::Cancel);
       switch (ret) {
           case QMessageBox::Yes:
-            if (saveAs()) {
+            if (saveAs() && _projectWriter->waitForFinished()) {
                 event->accept();
                 QWidget::close();
               }
@@ -256,14 +262,14 @@ MainWindow::closeEvent(QCloseEvent *event)
 void
 MainWindow::newFile()
 {
-  if (_scene->documentModified()) {
+  if (documentModified()) {
       int ret = QMessageBox::question(_view, tr("Document modified"),
                                       tr("The document was modified.\n\nDo you want to save before creating a new file ?"),
                                       QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel,
                                       QMessageBox::Cancel);
       switch (ret) {
           case QMessageBox::Yes:
-            if (!saveAs()) {
+            if (!saveAs() || !_projectWriter->waitForFinished()) {
                 return;
               }
             break;
@@ -289,14 +295,14 @@ MainWindow::newFile()
 void
 MainWindow::open()
 {
-  if (_scene->documentModified()) {
+  if (documentModified()) {
       int ret = QMessageBox::question(_view, tr("Document modified"),
                                       tr("The document was modified.\n\nDo you want to save before opening another file ?"),
                                       QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel,
                                       QMessageBox::Cancel);
       switch (ret) {
           case QMessageBox::Yes:
-            if (!saveAs()) {
+            if (!saveAs() || !_projectWriter->waitForFinished()) {
                 return;
               }
             break;
@@ -323,14 +329,14 @@ MainWindow::open()
 void
 MainWindow::open(QString s)
 {
-  if (_scene->documentModified()) {
+  if (documentModified()) {
       int ret = QMessageBox::question(_view, tr("Document modified"),
                                       tr("The document was modified.\n\nDo you want to save before opening another file ?"),
                                       QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel,
                                       QMessageBox::Cancel);
       switch (ret) {
           case QMessageBox::Yes:
-            if (!saveAs()) {
+            if (!saveAs() || !_projectWriter->waitForFinished()) {
                 return;
               }
             break;
@@ -510,7 +516,8 @@ MainWindow::selectMode(const InteractionMode &mode, const BoxCreationMode &boxMo
 bool
 MainWindow::documentModified() const
 {
-  return _scene->documentModified();
+  // the document is only clean once its last save has been written
+  return !_projectWriter->waitForFinished() || _scene->documentModified();
 }
 
 void
@@ -595,6 +602,14 @@ MainWindow::createActions()
   connect(_pasteAct, SIGNAL(triggered()), this, SLOT(pasteSelection()));
   */
 
+  _undoAct = Maquette::getInstance()->undoStack()->createUndoAction(this, tr("Undo"));
+  _undoAct->setShortcut(QKeySequence::Undo);
+  _undoAct->setStatusTip(tr("Undo the last edit"));
+
+  _redoAct = Maquette::getInstance()->undoStack()->createRedoAction(this, tr("Redo"));
+  _redoAct->setShortcut(QKeySequence::Redo);
+  _redoAct->setStatusTip(tr("Redo the last undone edit"));
+
   _selectAllAct = new QAction(tr("Select All"), this);
   _selectAllAct->setShortcut(QKeySequence::SelectAll);
   _selectAllAct->setStatusTip(tr("Select every item"));
@@ -657,6 +672,9 @@ MainWindow::createMenus()
   //_editMenu->addAction(_pasteAct);
 //  _editMenu->addAction(_commentModeAct);
   //_editMenu->addSeparator();
+  _editMenu->addAction(_undoAct);
+  _editMenu->addAction(_redoAct);
+  _editMenu->addSeparator();
   _editMenu->addAction(_selectAllAct);
 
   _viewMenu = _menuBar->addMenu(tr("&View"));
@@ -723,46 +741,31 @@ MainWindow::loadFile(const QString &fileName)
 bool
 MainWindow::saveFile(const QString &fileName)
 {
-  /*********** Backup automatique *************/
-
-    QDate date = QDate::currentDate();
-    QTime time = QTime::currentTime();
-    QString timeString = time.toString();
-
-    QString concat(tr("_")+QString("%1-%2-%3").arg(date.day()).arg(date.month()).arg(date.year())+tr("-")+timeString);
-
-    QString backupName = fileName;
-    int i = fileName.indexOf(".score");
-    backupName.insert(i,concat);
-
-    QProcess process;
-    QStringList args;
-
-    args<< fileName;
-    args<< backupName;
-
-    process.start("cp", args);
-    process.close();
+  // the score is stored into memory on this thread, the file is written in background
+  std::string content;
+  if (!_scene->save(fileName.toStdString(), content)) {
+      QMessageBox::warning(this, tr("i-score"), tr("Cannot save file %1.").arg(fileName));
+      return false;
+    }
+  _projectWriter->write(QByteArray(content.data(), int(content.size())), fileName);
 
-  /*******************************************/
+  setCurrentFile(fileName);
+  statusBar()->showMessage(tr("Saving..."));
+  return true;
+}
 
-  QString fileN;
-  if (!fileName.endsWith(".score")) {
-      fileN = fileName + ".score";
+void
+MainWindow::projectWritten(const QString &fileName, bool success)
+{
+  if (success) {
+      statusBar()->showMessage(tr("File saved"), 2000);
     }
   else {
-      fileN = fileName;
+      statusBar()->clearMessage();
+      _scene->setModified(true);
+      setWindowModified(true);
+      QMessageBox::warning(this, tr("i-score"), tr("Cannot write file %1.").arg(fileName));
     }
-
-  QApplication::setOverrideCursor(Qt::WaitCursor);
-
-  _scene->save(fileName.toStdString());
-
-  QApplication::restoreOverrideCursor();
-
-  setCurrentFile(fileName);
-  statusBar()->showMessage(tr("File saved"), 2000);
-  return true;
 }
 
 void
@@ -169,6 +169,12 @@ MaquetteScene::zoomChanged(float value)
   _timeBar->updateZoom(value);
     
   Maquette::getInstance()->setViewZoom(QPointF(value, 1.));
+
+  //Switch boxes between flat and detailed rendering
+  std::map<unsigned int, BasicBox*> boxes = Maquette::getInstance()->getBoxes();
+  for (std::map<unsigned int, BasicBox*>::iterator it = boxes.begin(); it != boxes.end(); ++it) {
+      it->second->updateLevelOfDetail();
+    }
 }
 
 void
@@ -492,6 +498,9 @@ bool MaquetteScene::subScenarioMode(QGraphicsSceneMouseEvent *mouseEvent)
 void
 MaquetteScene::mousePressEvent(QGraphicsSceneMouseEvent *mouseEvent)
 {
+  // the boxes clicked, selected or dragged must be where their dates are
+  _maquette->flushBoxesRescale();
+
   QGraphicsScene::mousePressEvent(mouseEvent);
   _clicked = true;
  
@@ -669,6 +678,13 @@ MaquetteScene::mouseReleaseEvent(QGraphicsSceneMouseEvent * mouseEvent)
 
   _releasePoint = mouseEvent->scenePos();
   _clicked = false;
+
+  // the items have handled the release : the dragged editions can be sent to the Engines
+  if (_maquette->isPreviewing()) {
+      _maquette->endBoxesPreview();
+      update();
+      setModified(true);
+    }
   switch (_currentInteractionMode) {
       case RELATION_MODE:
 
@@ -781,6 +797,9 @@ MaquetteScene::contextMenuEvent(QGraphicsSceneContextMenuEvent * event)
   _mousePos = QPointF(0., 0.);
 
   _clicked = false;
+  if (_maquette->isPreviewing()) {
+      _maquette->endBoxesPreview();
+    }
   _tempBox = nullptr;
 
   QGraphicsScene::contextMenuEvent(event);
@@ -1388,6 +1407,9 @@ MaquetteScene::changeRelationBounds(unsigned int relID, const float &length, con
 {
   Relation *rel = getRelation(relID);
   if (rel != nullptr) {
+      if (_clicked) {
+          _maquette->beginBoxesPreview();
+        }
       _maquette->changeRelationBounds(relID, minBound, maxBound);
       rel->changeBounds(minBound, maxBound);
       if (length != NO_LENGTH) {
@@ -1496,6 +1518,9 @@ MaquetteScene::boxResized()
   coord.sizeX = std::max((float)10., resizeBox->width());
 
   coord.sizeY = std::max((float)10., resizeBox->height());
+  if (_clicked) {
+      _maquette->beginBoxesPreview();
+    }
   if (_maquette->updateBox(resizeBox->ID(), coord)) {
       update();
       setModified(true);
@@ -1505,6 +1530,16 @@ MaquetteScene::boxResized()
 void
 MaquetteScene::selectionMoved()
 {
+  // while dragging only the preview moves : the Engines are edited on release (see mouseReleaseEvent)
+  bool preview = _clicked;
+  if (preview) {
+      _maquette->beginBoxesPreview();
+    }
+  else {
+      // one undo command and one constraints propagation for the whole selection
+      _maquette->beginBoxesMove();
+    }
+
   for(auto& curItem : selectedItems())
   {
     switch(curItem->type())
@@ -1521,6 +1556,10 @@ MaquetteScene::selectionMoved()
         break;
     }
   }
+
+  if (!preview) {
+      _maquette->endBoxesMove();
+    }
 }
 
 bool
@@ -1973,11 +2012,15 @@ MaquetteScene::setModified(bool modified)
   _modified = modified;
 }
 
-void
-MaquetteScene::save(const string &fileName)
+bool
+MaquetteScene::save(const string &fileName, string &content)
 {
-  _maquette->save(fileName);
+  if (!_maquette->save(fileName, content)) {
+      return false;
+    }
   setModified(false);
+
+  return true;
 }
 
 void
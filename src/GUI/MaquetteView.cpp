@@ -346,7 +346,7 @@ MaquetteView::zoomIn()
           resetCachedContent();
           _scene->update();
           Maquette::getInstance()->setZooming(true);
-          Maquette::getInstance()->updateBoxesFromEngines();
+          Maquette::getInstance()->rescaleBoxes();
 
           //QPointF newCenter(2. * (mapFromGlobal(QCursor::pos()).x() + mapToScene(viewport()->rect().bottomLeft()).x()), getCenterCoordinates().y() );
                 // new center : cursor position in Window + scroll offset. (+ zoom factor 2.)
@@ -398,14 +398,13 @@ MaquetteView::setZoom(float value)
             }
         }
     }
-  repaint();
   resetCachedContent();
 
 /// \todo Old TODO updated (by jC) : check if can be comment
   _scene->update();  
   _scene->zoomChanged(_zoom);
 
-  Maquette::getInstance()->updateBoxesFromEngines();
+  Maquette::getInstance()->rescaleBoxes();
 }
 
 /**
@@ -420,7 +419,7 @@ MaquetteView::zoomOut()
   resetCachedContent();
   _scene->update();
   Maquette::getInstance()->setZooming(true);
-  Maquette::getInstance()->updateBoxesFromEngines();
+  Maquette::getInstance()->rescaleBoxes();
 
   QPointF newCenter(getCenterCoordinates().x() -  _scene->getCurrentTime()/(MaquetteScene::MS_PER_PIXEL) , getCenterCoordinates().y()/2);
   centerOn(newCenter);
@@ -442,4 +441,12 @@ void MaquetteView::resizeEvent(QResizeEvent * evt)
 {
   emit sizeChanged();
   QGraphicsView::resizeEvent(evt);
+  Maquette::getInstance()->rescaleVisibleBoxes();
+}
+
+void
+MaquetteView::scrollContentsBy(int dx, int dy)
+{
+  QGraphicsView::scrollContentsBy(dx, dy);
+  Maquette::getInstance()->rescaleVisibleBoxes();
 }
@@ -0,0 +1,214 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "NamespaceExplorer.hpp"
+#include "Maquette.hpp"
+
+using std::string;
+using std::vector;
+
+NamespaceExplorer::NamespaceExplorer(QObject *parent)
+  : QObject(parent)
+{
+}
+
+NamespaceExplorer::~NamespaceExplorer()
+{
+  for (auto &it : _explorations) {
+      if (it.second.job) {
+          it.second.job->cancelled = true;
+        }
+    }
+
+  // the workers use the Engine : they must end before it can be released
+  for (auto &it : _explorations) {
+      if (it.second.thread.joinable()) {
+          it.second.thread.join();
+        }
+    }
+}
+
+void
+NamespaceExplorer::explore(const QString &deviceName, bool rebuild)
+{
+  Exploration &exploration = _explorations[deviceName];
+
+  // the exploration is restarted once the current one ends, with the last namespace
+  if (exploration.running) {
+      exploration.restart = true;
+      exploration.restartRebuild = exploration.restartRebuild || rebuild;
+      if (!exploration.waited) {
+          exploration.waited = true;
+          exploration.timer->start(EXPLORATION_TIMEOUT);
+        }
+      return;
+    }
+
+  start(deviceName, rebuild);
+}
+
+bool
+NamespaceExplorer::isExploring(const QString &deviceName) const
+{
+  auto it = _explorations.find(deviceName);
+  return it != _explorations.end() && it->second.waited;
+}
+
+void
+NamespaceExplorer::start(const QString &deviceName, bool rebuild)
+{
+  Exploration &exploration = _explorations[deviceName];
+
+  exploration.running = true;
+  exploration.waited = true;
+  exploration.restart = false;
+  exploration.restartRebuild = false;
+
+  if (exploration.timer == nullptr) {
+      exploration.timer = new QTimer(this);
+      exploration.timer->setSingleShot(true);
+      connect(exploration.timer, &QTimer::timeout, this, [this, deviceName] { timeout(deviceName); });
+    }
+  exploration.timer->start(EXPLORATION_TIMEOUT);
+
+  exploration.job = std::make_shared<Job>();
+  exploration.thread = std::thread(&NamespaceExplorer::work, this, deviceName, rebuild, exploration.job);
+}
+
+void
+NamespaceExplorer::deliver(const QString &deviceName)
+{
+  Exploration &exploration = _explorations[deviceName];
+  NamespaceNode root;
+  bool found = false;
+
+  // the worker delivers as it ends
+  if (exploration.thread.joinable()) {
+      exploration.thread.join();
+    }
+  if (exploration.job) {
+      std::lock_guard<std::mutex> lock(exploration.job->mutex);
+      found = exploration.job->explored;
+      root = std::move(exploration.job->root);
+    }
+  exploration.job.reset();
+
+  exploration.running = false;
+
+  if (exploration.restart) {
+      start(deviceName, exploration.restartRebuild);
+      return;
+    }
+
+  exploration.timer->stop();
+  if (exploration.waited) {
+      exploration.waited = false;
+      if (found) {
+          emit explored(deviceName, root);
+        }
+      else {
+          emit timedOut(deviceName);
+        }
+    }
+}
+
+void
+NamespaceExplorer::timeout(const QString &deviceName)
+{
+  Exploration &exploration = _explorations[deviceName];
+
+  if (!exploration.waited) {
+      return;
+    }
+
+  // the exploration stops at the next node : its result will be dropped
+  exploration.waited = false;
+  exploration.restart = false;
+  if (exploration.job) {
+      exploration.job->cancelled = true;
+    }
+  emit timedOut(deviceName);
+}
+
+void
+NamespaceExplorer::work(NamespaceExplorer *explorer, QString deviceName, bool rebuild, std::shared_ptr<Job> job)
+{
+  NamespaceNode root{deviceName.toStdString(), false, {}};
+  if (rebuild) {
+      Maquette::getInstance()->rebuildNetworkNamespace(deviceName.toStdString());
+    }
+  bool explored = exploreNode(*job, deviceName.toStdString(), root);
+
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->explored = explored;
+    job->root = std::move(root);
+  }
+
+  // the explorer joins this thread before it is destroyed
+  QMetaObject::invokeMethod(explorer, "deliver", Qt::QueuedConnection, Q_ARG(QString, deviceName));
+}
+
+bool
+NamespaceExplorer::exploreNode(const Job &job, const string &address, NamespaceNode &node)
+{
+  if (job.cancelled) {
+      return false;
+    }
+
+  vector<string> children;
+  string nodeType;
+
+  if (Maquette::getInstance()->getObjectChildren(address, children) > 0) {
+      for (const auto &child : children) {
+          string childAddress = address + "/" + child;
+
+          node.children.push_back(NamespaceNode{child, false, {}});
+          NamespaceNode &childNode = node.children.back();
+          childNode.isData = Maquette::getInstance()->getObjectType(childAddress, nodeType) && nodeType == "Data";
+
+          if (!exploreNode(job, childAddress, childNode)) {
+              return false;
+            }
+        }
+    }
+
+  return true;
+}
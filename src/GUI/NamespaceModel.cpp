@@ -0,0 +1,480 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "NamespaceModel.hpp"
+#include "Maquette.hpp"
+
+using std::string;
+using std::vector;
+
+NamespaceModel::NamespaceModel(const QString &deviceName, QObject *parent)
+  : QAbstractItemModel(parent), _deviceName(deviceName), _attributes(ATTRIBUTES_CACHE_SIZE)
+{
+  setNamespace(NamespaceNode{deviceName.toStdString(), false, {}});
+
+  connect(Maquette::getInstance(), SIGNAL(valueRead(QString,QString)),
+          this, SLOT(valueRead(QString,QString)), Qt::QueuedConnection);
+
+  _reader = std::thread(static_cast<void (NamespaceModel::*)()>(&NamespaceModel::readAttributes), this);
+}
+
+NamespaceModel::~NamespaceModel()
+{
+  {
+    std::lock_guard<std::mutex> lock(_readsMutex);
+    _readerStop = true;
+    _reads.clear();
+  }
+  _readsCondition.notify_one();
+  _reader.join();
+}
+
+void
+NamespaceModel::setNamespace(const NamespaceNode &root)
+{
+  AddressTrie *trie = AddressTrie::getInstance();
+  int size = countNodes(root) + 1;
+
+  beginResetModel();
+  dropReads();
+  _attributes.clear();
+  _nodes.clear();
+  _nodes.reserve(size);
+
+  // breadth first, so that the children of a node are contiguous
+  vector<const NamespaceNode *> sources;
+  sources.reserve(size);
+  sources.push_back(&root);
+  _nodes.push_back(Node{trie->intern(_deviceName.toStdString()), -1, 0, 1, 0, false});
+
+  for (unsigned int i = 0; i < sources.size(); i++) {
+      const NamespaceNode *source = sources[i];
+      _nodes[i].firstChild = _nodes.size();
+      _nodes[i].childCount = source->children.size();
+
+      int row = 0;
+      for (const auto &child : source->children) {
+          _nodes.push_back(Node{trie->intern(_nodes[i].address, child.name), int(i), row++, 0, 0, child.isData});
+          sources.push_back(&child);
+        }
+    }
+  endResetModel();
+}
+
+void
+NamespaceModel::invalidate()
+{
+  dropReads();
+  _attributes.clear();
+  if (_nodes.size() > 1) {
+      emit dataChanged(index(0, VALUE_COLUMN), index(rowCount() - 1, COLUMN_COUNT - 1));
+    }
+}
+
+int
+NamespaceModel::nodeCount() const
+{
+  return _nodes.size() - 1;
+}
+
+string
+NamespaceModel::address(const QModelIndex &index) const
+{
+  return AddressTrie::getInstance()->address(_nodes[nodeIndex(index)].address);
+}
+
+bool
+NamespaceModel::isData(const QModelIndex &index) const
+{
+  return _nodes[nodeIndex(index)].isData;
+}
+
+QModelIndex
+NamespaceModel::indexOf(AddressHandle handle) const
+{
+  AddressTrie *trie = AddressTrie::getInstance();
+
+  if (handle == _nodes[0].address || !trie->isBelow(handle, _nodes[0].address)) {
+      return QModelIndex();
+    }
+
+  vector<AddressHandle> path;
+  for (AddressHandle it = handle; it != _nodes[0].address; it = trie->parent(it)) {
+      path.push_back(it);
+    }
+
+  // down from the device, among the children of each node
+  int node = 0;
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+      int child = _nodes[node].firstChild, end = child + _nodes[node].childCount;
+      while (child < end && _nodes[child].address != *it) {
+          child++;
+        }
+      if (child == end) {
+          return QModelIndex();
+        }
+      node = child;
+    }
+
+  return createIndex(_nodes[node].row, 0, quintptr(node));
+}
+
+vector<AddressHandle>
+NamespaceModel::addresses() const
+{
+  vector<AddressHandle> result;
+  result.reserve(nodeCount());
+  for (unsigned int i = 1; i < _nodes.size(); i++) {
+      result.push_back(_nodes[i].address);
+    }
+
+  return result;
+}
+
+bool
+NamespaceModel::subtree(const QModelIndex &index, NamespaceNode &node, int maxNodes) const
+{
+  int remaining = maxNodes;
+  return fillSubtree(nodeIndex(index), node, remaining);
+}
+
+bool
+NamespaceModel::fillSubtree(int node, NamespaceNode &out, int &remaining) const
+{
+  const Node &source = _nodes[node];
+
+  out.name = AddressTrie::getInstance()->segment(source.address);
+  out.isData = source.isData;
+  out.children.clear();
+
+  if ((remaining -= source.childCount) < 0) {
+      return false;
+    }
+
+  out.children.resize(source.childCount);
+  for (int i = 0; i < source.childCount; i++) {
+      if (!fillSubtree(source.firstChild + i, out.children[i], remaining)) {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+int
+NamespaceModel::countNodes(const NamespaceNode &root)
+{
+  int count = 0;
+  vector<const NamespaceNode *> stack{&root};
+
+  while (!stack.empty()) {
+      const NamespaceNode *node = stack.back();
+      stack.pop_back();
+      count += node->children.size();
+      for (const auto &child : node->children) {
+          stack.push_back(&child);
+        }
+    }
+
+  return count;
+}
+
+int
+NamespaceModel::nodeIndex(const QModelIndex &index) const
+{
+  return index.isValid() ? int(index.internalId()) : 0;
+}
+
+QModelIndex
+NamespaceModel::index(int row, int column, const QModelIndex &parent) const
+{
+  const Node &node = _nodes[nodeIndex(parent)];
+
+  if (row < 0 || row >= node.childCount || column < 0 || column >= COLUMN_COUNT) {
+      return QModelIndex();
+    }
+
+  return createIndex(row, column, quintptr(node.firstChild + row));
+}
+
+QModelIndex
+NamespaceModel::parent(const QModelIndex &index) const
+{
+  if (!index.isValid()) {
+      return QModelIndex();
+    }
+
+  int parent = _nodes[nodeIndex(index)].parent;
+  if (parent <= 0) {
+      return QModelIndex();
+    }
+
+  return createIndex(_nodes[parent].row, 0, quintptr(parent));
+}
+
+int
+NamespaceModel::rowCount(const QModelIndex &parent) const
+{
+  if (parent.isValid() && parent.column() != 0) {
+      return 0;
+    }
+
+  return _nodes[nodeIndex(parent)].childCount;
+}
+
+int
+NamespaceModel::columnCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return COLUMN_COUNT;
+}
+
+bool
+NamespaceModel::hasChildren(const QModelIndex &parent) const
+{
+  return rowCount(parent) > 0;
+}
+
+QVariant
+NamespaceModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid()) {
+      return QVariant();
+    }
+
+  int node = nodeIndex(index);
+
+  if (role == Qt::DisplayRole) {
+      if (index.column() == NAME_COLUMN) {
+          return QString::fromStdString(AddressTrie::getInstance()->segment(_nodes[node].address));
+        }
+      return attributes(node)->columns[index.column()];
+    }
+
+  if (role == Qt::ToolTipRole && index.column() == NAME_COLUMN) {
+      return QString::fromStdString(AddressTrie::getInstance()->address(_nodes[node].address));
+    }
+
+  return QVariant();
+}
+
+QVariant
+NamespaceModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  static const char *headers[COLUMN_COUNT] = { "Address", "Value", "type ", "min ", "max ", "priority " };
+
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole || section < 0 || section >= COLUMN_COUNT) {
+      return QVariant();
+    }
+
+  return QString(headers[section]);
+}
+
+Qt::ItemFlags
+NamespaceModel::flags(const QModelIndex &index) const
+{
+  if (!index.isValid()) {
+      return Qt::NoItemFlags;
+    }
+
+  return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+}
+
+const NamespaceModel::Attributes *
+NamespaceModel::attributes(int node) const
+{
+  Attributes *attributes = _attributes.object(node);
+  if (attributes != nullptr) {
+      return attributes;
+    }
+
+  // a placeholder until the reader delivers the row (see deliverAttributes)
+  attributes = new Attributes;
+  string address = AddressTrie::getInstance()->address(_nodes[node].address);
+
+  if (_nodes[node].isData) {
+      string value;
+      if (Maquette::getInstance()->peekCachedValue(address, value)) {
+          attributes->columns[VALUE_COLUMN] = QString::fromStdString(value);
+        }
+    }
+  _attributes.insert(node, attributes);
+
+  {
+    std::lock_guard<std::mutex> lock(_readsMutex);
+    _reads.push_back(AttributesRead{node, _generation, address, _nodes[node].isData, Attributes()});
+
+    // the rows scrolled past long ago aren't displayed anymore : they will be read again if they are
+    if (int(_reads.size()) > ATTRIBUTES_CACHE_SIZE) {
+        _attributes.remove(_reads.front().node);
+        _reads.pop_front();
+      }
+  }
+  _readsCondition.notify_one();
+
+  return attributes;
+}
+
+void
+NamespaceModel::dropReads()
+{
+  std::lock_guard<std::mutex> lock(_readsMutex);
+  _generation++;
+  _reads.clear();
+  _readsDone.clear();
+}
+
+void
+NamespaceModel::readAttributes()
+{
+  while (true) {
+      AttributesRead read;
+      {
+        std::unique_lock<std::mutex> lock(_readsMutex);
+        _readsCondition.wait(lock, [this] { return _readerStop || !_reads.empty(); });
+        if (_readerStop) {
+            return;
+          }
+
+        // the last displayed rows first
+        read = std::move(_reads.back());
+        _reads.pop_back();
+      }
+
+      readAttributes(read);
+
+      bool deliver;
+      {
+        std::lock_guard<std::mutex> lock(_readsMutex);
+        if (read.generation != _generation) {
+            continue;
+          }
+        deliver = _readsDone.empty();
+        _readsDone.push_back(std::move(read));
+      }
+
+      // one delivery for the rows read meanwhile
+      if (deliver) {
+          QMetaObject::invokeMethod(this, "deliverAttributes", Qt::QueuedConnection);
+        }
+    }
+}
+
+void
+NamespaceModel::readAttributes(AttributesRead &read)
+{
+  Maquette *maquette = Maquette::getInstance();
+  Attributes &attributes = read.attributes;
+
+  vector<string> services;
+  string nodeType;
+  if (maquette->requestObjectAttribruteValue(read.address, "service", services) > 0 && !services.empty()) {
+      attributes.columns[TYPE_COLUMN] = QString::fromStdString(services[0]);
+    }
+  else if (maquette->getObjectType(read.address, nodeType) > 0) {
+      attributes.columns[TYPE_COLUMN] = QString::fromStdString(nodeType);
+    }
+
+  if (read.isData) {
+      vector<float> rangeBounds;
+      if (maquette->getRangeBounds(read.address, rangeBounds) > 0) {
+          attributes.columns[MIN_COLUMN] = QString("%1").arg(rangeBounds[0]);
+          attributes.columns[MAX_COLUMN] = QString("%1").arg(rangeBounds[1]);
+        }
+
+      unsigned int priority = 0;
+      if (!maquette->getPriority(read.address, priority)) {
+          attributes.columns[PRIORITY_COLUMN] = QString("%1").arg(priority);
+        }
+    }
+}
+
+void
+NamespaceModel::deliverAttributes()
+{
+  vector<AttributesRead> reads;
+  {
+    std::lock_guard<std::mutex> lock(_readsMutex);
+    reads.swap(_readsDone);
+  }
+
+  for (auto &read : reads) {
+      if (read.generation != _generation) {
+          continue;
+        }
+
+      // the value stays the one of the cache (see valueRead)
+      Attributes *attributes = _attributes.object(read.node);
+      string value;
+      if (attributes != nullptr) {
+          read.attributes.columns[VALUE_COLUMN] = attributes->columns[VALUE_COLUMN];
+        }
+      else if (read.isData && Maquette::getInstance()->peekCachedValue(read.address, value)) {
+          read.attributes.columns[VALUE_COLUMN] = QString::fromStdString(value);
+        }
+      _attributes.insert(read.node, new Attributes(read.attributes));
+
+      const Node &node = _nodes[read.node];
+      emit dataChanged(createIndex(node.row, VALUE_COLUMN, quintptr(read.node)),
+                       createIndex(node.row, COLUMN_COUNT - 1, quintptr(read.node)));
+    }
+}
+
+void
+NamespaceModel::valueRead(const QString &address, const QString &value)
+{
+  AddressHandle handle = AddressTrie::getInstance()->find(address.toStdString());
+  if (handle == NO_ADDRESS) {
+      return;
+    }
+
+  QModelIndex valueIndex = indexOf(handle);
+  if (!valueIndex.isValid()) {
+      return;
+    }
+  valueIndex = valueIndex.sibling(valueIndex.row(), VALUE_COLUMN);
+
+  // only the displayed rows are cached, the other ones will peek the value
+  Attributes *attributes = _attributes.object(nodeIndex(valueIndex));
+  if (attributes != nullptr && attributes->columns[VALUE_COLUMN] != value) {
+      attributes->columns[VALUE_COLUMN] = value;
+      emit dataChanged(valueIndex, valueIndex);
+    }
+}
@@ -50,12 +50,16 @@
 #include <QTreeView>
 #include <QByteArray>
 #include <QMessageBox>
+#include <QDialog>
+#include <QVBoxLayout>
 #include <QAbstractItemModel>
 #include <QAbstractItemView>
 #include <QTreeView>
 #include <QApplication>
 #include <DelayedDelete.h>
 #include <utility>
+#include <algorithm>
+#include <climits>
 #include <QDebug>
 
 int NetworkTree::NAME_COLUMN = 0;
@@ -314,6 +318,7 @@ NetworkTree::NetworkTree(QWidget *parent) : QTreeWidget(parent)
   
   connect(this, SIGNAL(itemClicked(QTreeWidgetItem *, int)), this, SLOT(clickInNetworkTree(QTreeWidgetItem *, int)));
   connect(this, SIGNAL(itemChanged(QTreeWidgetItem*, int)), this, SLOT(valueChanged(QTreeWidgetItem*, int)));
+  connect(this, SIGNAL(itemChanged(QTreeWidgetItem*, int)), this, SLOT(checkStateChanged(QTreeWidgetItem*, int)));
   connect(this, SIGNAL(startValueChanged(QTreeWidgetItem*, QString)), this, SLOT(changeStartValue(QTreeWidgetItem*, QString)));
   connect(this, SIGNAL(endValueChanged(QTreeWidgetItem*, QString)), this, SLOT(changeEndValue(QTreeWidgetItem*, QString)));
   
@@ -336,6 +341,12 @@ NetworkTree::NetworkTree(QWidget *parent) : QTreeWidget(parent)
   connect(this,        &NetworkTree::deviceUpdated,
           this,        &NetworkTree::refreshItemNamespace);
 
+  _namespaceExplorer = new NamespaceExplorer(this);
+  connect(_namespaceExplorer, &NamespaceExplorer::explored,
+          this,               &NetworkTree::deviceExplored);
+  connect(_namespaceExplorer, &NamespaceExplorer::timedOut,
+          this,               &NetworkTree::deviceExplorationTimedOut);
+
   _addADeviceItem = addADeviceNode();
   addTopLevelItem(_addADeviceItem);
 }
@@ -419,11 +430,21 @@ NetworkTree::clear()
 {
   QList<QTreeWidgetItem*>::iterator it;
 
-  _addressMap.clear();
+  _itemsAddress.clear();
+  _addressesItem.clear();
+  _addressIndex.clear();
+  _directedItems.clear();
+  _addressListValid = false;
   _nodesWithSelectedChildren.clear();
   _assignedItems.clear();
   _nodesWithSomeChildrenAssigned.clear();
   _nodesWithAllChildrenAssigned.clear();
+  _assignationCounters.clear();
+
+  for (auto model : _namespaceModels) {
+      model->deleteLater();
+    }
+  _namespaceModels.clear();
 
   _startMessages->clear();
   _endMessages->clear();
@@ -463,7 +484,6 @@ NetworkTree::load()
       QTreeWidgetItem *curItem = new QTreeWidgetItem(DeviceNode);
       curItem->setText(NAME_COLUMN , deviceName);
       curItem->setCheckState(NAME_COLUMN,Qt::Unchecked);
-      treeRecursiveExploration(curItem, true);
       itemsList << curItem;
 
       Maquette::getInstance()->getDeviceProtocol(deviceName.toStdString(),protocol);
@@ -473,6 +493,14 @@ NetworkTree::load()
 
   itemsList<<_addADeviceItem;
   addTopLevelItems(itemsList);  
+
+  // The devices are explored concurrently, each one is filled when its namespace arrives
+  for (nameIt = deviceNames.begin(); nameIt != deviceNames.end(); ++nameIt) {
+      QString deviceName = QString::fromStdString(*nameIt);
+      _pendingExplorations[deviceName] = PendingExploration();
+      getDeviceItem(deviceName)->setToolTip(NAME_COLUMN, tr("Exploring the namespace..."));
+      _namespaceExplorer->explore(deviceName, false);
+    }
   
   setSelectionMode(QAbstractItemView::SingleSelection);
 }
@@ -710,6 +738,12 @@ NetworkTree::getAbsoluteAddress(QTreeWidgetItem *item) const
   return address;
 }
 
+unsigned int
+NetworkTree::priorityKey(QTreeWidgetItem *item) const
+{
+  return _itemsPriorityKey.value(item, UINT_MAX);
+}
+
 QString
 NetworkTree::getDeviceName(QTreeWidgetItem *item) const
 {
@@ -727,52 +761,189 @@ NetworkTree::getDeviceName(QTreeWidgetItem *item) const
 QTreeWidgetItem *
 NetworkTree::getItemFromAddress(string address) const
 {
-  return _addressMap.key(address);
+  return _addressesItem.value(AddressTrie::getInstance()->find(address), nullptr);
 }
 
-QPair< QMap <QTreeWidgetItem *, Data>, QList<QString> >
-NetworkTree::treeSnapshot(unsigned int boxID)
+QStringList
+NetworkTree::findAddresses(const QString &text, bool prefix, unsigned int maxResults) const
 {
-  Q_UNUSED(boxID);
+  vector<AddressHandle> found = prefix ? _addressIndex.findPrefix(text.toStdString(), maxResults)
+                                       : _addressIndex.find(text.toStdString(), maxResults);
 
-  QMap<QTreeWidgetItem *, Data> snapshots;
-  QList<QString> devicesConcerned;
+  QStringList addresses;
+  for (AddressHandle handle : found) {
+      addresses << QString::fromStdString(AddressTrie::getInstance()->address(handle));
+    }
 
-  QList<QTreeWidgetItem*> selection = assignedItems().keys();
-  if (!selection.empty()) {
-      QList<QTreeWidgetItem*>::iterator it;
-      vector<string>::iterator it2;
-      QTreeWidgetItem *curItem;
-      for (it = selection.begin(); it != selection.end(); ++it) {
-          curItem = *it;
-          if (curItem->type() != DeviceNode && curItem->type() != NodeNoNamespaceType){
-              QString address = getAbsoluteAddress(*it);
-
-              //get device concerned
-              QString deviceName = getDeviceName(*it);
-              if (!devicesConcerned.contains(deviceName)) {
-                  devicesConcerned.append(deviceName);
-                }
+  return addresses;
+}
 
-              QPair<QTreeWidgetItem *, Data> curPair;
+bool
+NetworkTree::showAddress(const string &address)
+{
+  QTreeWidgetItem *item = getItemFromAddress(address);
+
+  // not built yet : it may be in a large namespace
+  if (item == nullptr) {
+      AddressHandle handle = AddressTrie::getInstance()->find(address);
+      for (auto it = _namespaceModels.begin(); handle != NO_ADDRESS && it != _namespaceModels.end(); ++it) {
+          QModelIndex index = it.value()->indexOf(handle);
+          if (index.isValid()) {
+              buildNamespaceBranch(it.key(), index);
+              item = getItemFromAddress(address);
+              break;
+            }
+        }
+    }
 
-              if (!address.isEmpty()) {                  
-                  vector<string> snapshot = Maquette::getInstance()->requestNetworkSnapShot(address.toStdString());
+  if (item == nullptr) {
+      return false;
+    }
 
-                  Data data;
-                  for (it2 = snapshot.begin(); it2 != snapshot.end(); it2++) {
-                      data.msg = QString::fromStdString(*it2);
-                      data.address = address;
-//                        data.sampleRate = Maquette::getInstance()->getCurveSampleRate(boxID,address.toStdString());
-                      data.hasCurve = false;
-                      snapshots.insert(*it, data);
-                    }
-                }
+  for (QTreeWidgetItem *it = item->parent(); it != nullptr; it = it->parent()) {
+      expandItem(it);
+    }
+  setCurrentItem(item);
+  scrollToItem(item);
+
+  return true;
+}
+
+void
+NetworkTree::setItemAddress(QTreeWidgetItem *item, const string &address)
+{
+  AddressHandle handle = AddressTrie::getInstance()->intern(address);
+
+  // the item had another address : it is not the item of this address anymore
+  QHash<QTreeWidgetItem *, AddressHandle>::iterator previous = _itemsAddress.find(item);
+  if (previous != _itemsAddress.end()) {
+      if (_addressesItem.value(previous.value()) == item) {
+          _addressesItem.remove(previous.value());
+        }
+      _addressIndex.remove(previous.value());
+    }
+
+  // the address had another item
+  QTreeWidgetItem *previousItem = _addressesItem.value(handle, nullptr);
+  if (previousItem != nullptr && previousItem != item) {
+      _itemsAddress.remove(previousItem);
+      _addressIndex.remove(handle);
+    }
+
+  _itemsAddress[item] = handle;
+  _addressIndex.add(handle);
+  _addressListValid = false;
+  _addressesItem[handle] = item;
+}
+
+void
+NetworkTree::forgetItemAddresses(QTreeWidgetItem *item)
+{
+  auto forget = [&] (QTreeWidgetItem* it)
+  {
+      QHash<QTreeWidgetItem *, AddressHandle>::iterator address = _itemsAddress.find(it);
+      if (address != _itemsAddress.end()) {
+          if (_addressesItem.value(address.value()) == it) {
+              _addressesItem.remove(address.value());
             }
+          _addressIndex.remove(address.value());
+          _itemsAddress.erase(address);
+        }
+      _directedItems.remove(it);
+      if (_itemsPriorityKey.remove(it) > 0) {
+          _prioritiesRevision++;
         }
+  };
+
+  forget(item);
+  applyInTree(item, forget);
+  _addressListValid = false;
+}
+
+void
+NetworkTree::updateAssignedCounter(QTreeWidgetItem *item)
+{
+  // as allBrothersAssigned used to check : a node counts once partially assigned, other items once assigned
+  bool assigned = item->type() == NodeNoNamespaceType ? _nodesWithSomeChildrenAssigned.contains(item) : _assignedItems.contains(item);
+
+  AssignationCounters &counters = _assignationCounters[item];
+  if (counters.assigned == assigned) {
+      return;
     }
+  counters.assigned = assigned;
 
-  return qMakePair(snapshots, devicesConcerned);
+  if (item->parent() != nullptr) {
+      _assignationCounters[item->parent()].assignedChildren += assigned ? 1 : -1;
+    }
+}
+
+void
+NetworkTree::forgetItemCounters(QTreeWidgetItem *item)
+{
+  QHash<QTreeWidgetItem *, AssignationCounters>::const_iterator found = _assignationCounters.constFind(item);
+  if (found != _assignationCounters.constEnd() && item->parent() != nullptr) {
+      AssignationCounters counters = found.value();
+      AssignationCounters &fatherCounters = _assignationCounters[item->parent()];
+
+      if (counters.assigned) {
+          fatherCounters.assignedChildren--;
+        }
+      for (int i = 0; i < 2; i++) {
+          if (counters.checkStates[i] == Qt::Checked) {
+              fatherCounters.checkedChildren[i]--;
+            }
+          if (counters.checkStates[i] != Qt::Unchecked) {
+              fatherCounters.markedChildren[i]--;
+            }
+        }
+    }
+
+  _assignationCounters.remove(item);
+  applyInTree(item, [&] (QTreeWidgetItem* it)
+  {
+      _assignationCounters.remove(it);
+  });
+}
+
+int
+NetworkTree::assignationColumnIndex(int column)
+{
+  if (column == START_ASSIGNATION_COLUMN) {
+      return 0;
+    }
+  if (column == END_ASSIGNATION_COLUMN) {
+      return 1;
+    }
+  return -1;
+}
+
+void
+NetworkTree::checkStateChanged(QTreeWidgetItem *item, int column)
+{
+  int index = assignationColumnIndex(column);
+  if (index < 0) {
+      return;
+    }
+
+  AssignationCounters &counters = _assignationCounters[item];
+  Qt::CheckState previousState = counters.checkStates[index];
+  Qt::CheckState state = item->checkState(column);
+  if (state == previousState) {
+      return;
+    }
+  counters.checkStates[index] = state;
+
+  if (item->parent() != nullptr) {
+      AssignationCounters &fatherCounters = _assignationCounters[item->parent()];
+      fatherCounters.checkedChildren[index] += (state == Qt::Checked) - (previousState == Qt::Checked);
+      fatherCounters.markedChildren[index] += (state != Qt::Unchecked) - (previousState != Qt::Unchecked);
+    }
+}
+
+QPair< QMap <QTreeWidgetItem *, Data>, QList<QString> >
+NetworkTree::treeSnapshot(unsigned int boxID)
+{
+  return treeSnapshot(boxID, assignedItems().keys());
 }
 
 QPair< QMap <QTreeWidgetItem *, Data>, QList<QString> >
@@ -783,40 +954,44 @@ NetworkTree::treeSnapshot(unsigned int boxID, QList<QTreeWidgetItem *> itemsList
   QMap<QTreeWidgetItem *, Data> snapshots;
   QList<QString> devicesConcerned;
 
-  QList<QTreeWidgetItem*> selection = itemsList;
-  if (!selection.empty()) {
-      QList<QTreeWidgetItem*>::iterator it;
-      vector<string>::iterator it2;
-      QTreeWidgetItem *curItem;
-      for (it = selection.begin(); it != selection.end(); ++it) {
-          curItem = *it;
-          if (curItem->type() != DeviceNode && curItem->type() != NodeNoNamespaceType){
-              QString address = getAbsoluteAddress(*it);
-
-              //get device concerned
-              QString deviceName = getDeviceName(*it);
-              if (!devicesConcerned.contains(deviceName)) {
-                  devicesConcerned.append(deviceName);
-                }
-
-              QPair<QTreeWidgetItem *, Data> curPair;
+  QList<QTreeWidgetItem*>::iterator it;
+  QList< QPair<QTreeWidgetItem *, QString> > itemsAddresses;
+  vector<string> addresses;
+  QTreeWidgetItem *curItem;
+  for (it = itemsList.begin(); it != itemsList.end(); ++it) {
+      curItem = *it;
+      if (curItem->type() != DeviceNode && curItem->type() != NodeNoNamespaceType){
+          QString address = getAbsoluteAddress(*it);
 
-              if (!address.isEmpty()) {
-                  vector<string> snapshot = Maquette::getInstance()->requestNetworkSnapShot(address.toStdString());
+          //get device concerned
+          QString deviceName = getDeviceName(*it);
+          if (!devicesConcerned.contains(deviceName)) {
+              devicesConcerned.append(deviceName);
+            }
 
-                  Data data;
-                  for (it2 = snapshot.begin(); it2 != snapshot.end(); it2++) {
-                      data.msg = QString::fromStdString(*it2);
-                      data.address = address;
-//                        data.sampleRate = Maquette::getInstance()->getCurveSampleRate(boxID,address.toStdString());
-                      data.hasCurve = false;
-                      snapshots.insert(*it, data);
-                    }
-                }
+          if (!address.isEmpty()) {
+              itemsAddresses.append(qMakePair(curItem, address));
+              addresses.push_back(address.toStdString());
             }
         }
     }
 
+  // one request for all the items
+  map<string, string> snapshot = Maquette::getInstance()->requestNetworkSnapShot(addresses);
+
+  QList< QPair<QTreeWidgetItem *, QString> >::iterator it2;
+  for (it2 = itemsAddresses.begin(); it2 != itemsAddresses.end(); ++it2) {
+      map<string, string>::iterator value = snapshot.find(it2->second.toStdString());
+      if (value != snapshot.end()) {
+          Data data;
+          data.msg = QString::fromStdString(value->second);
+          data.address = it2->second;
+//          data.sampleRate = Maquette::getInstance()->getCurveSampleRate(boxID,address.toStdString());
+          data.hasCurve = false;
+          snapshots.insert(it2->first, data);
+        }
+    }
+
   return qMakePair(snapshots, devicesConcerned);
 }
 
@@ -851,10 +1026,7 @@ NetworkTree::treeRecursiveExploration(QTreeWidgetItem *curItem, bool conflict)
 
          //TOTO : check if necessary (unused for the moment) NH.
          // A tester plus en avant
-         auto preexistingkeys = _addressMap.keys(address);
-         for(auto& key : preexistingkeys) _addressMap.remove(key);
-
-         _addressMap.insert(curItem, address);
+         setItemAddress(curItem, address);
 
          //Get object's children
          if(Maquette::getInstance()->getObjectChildren(address,children) > 0)
@@ -885,6 +1057,162 @@ NetworkTree::treeRecursiveExploration(QTreeWidgetItem *curItem, bool conflict)
      }
 }
 
+void
+NetworkTree::treeBuild(QTreeWidgetItem *curItem, const NamespaceNode &node)
+{
+    string address = (getAbsoluteAddress(curItem)).toStdString();
+
+    setItemAddress(curItem, address);
+
+    for(const auto& child : node.children)
+    {
+        QStringList name{QString::fromStdString(child.name)};
+        NetworkTreeItem *childItem{};
+
+        if(child.isData)
+        {
+            childItem = new NetworkTreeItem(curItem, name, LeaveType);
+            childItem->setupProperties(LeafProperties());
+        }
+        else
+        {
+            childItem = new NetworkTreeItem(curItem, name, NodeNoNamespaceType);
+            childItem->setupProperties(NodeProperties());
+        }
+
+        treeBuild(childItem, child);
+        setNewItemProperties(childItem);
+    }
+}
+
+void
+NetworkTree::browseNamespace(const QString &deviceName)
+{
+    NamespaceModel *model = _namespaceModels.value(deviceName);
+    if(model == nullptr)
+        return;
+
+    QDialog *browser = new QDialog(this);
+    browser->setAttribute(Qt::WA_DeleteOnClose);
+    browser->setWindowTitle(tr("%1 namespace").arg(deviceName));
+
+    // Uniform rows : the view doesn't have to ask each row its size
+    QTreeView *view = new QTreeView(browser);
+    view->setUniformRowHeights(true);
+    view->setModel(model);
+    view->setColumnWidth(NamespaceModel::NAME_COLUMN, 250);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+
+    connect(view, &QTreeView::doubleClicked, [this, deviceName] (const QModelIndex &index)
+    {
+        buildNamespaceBranch(deviceName, index);
+    });
+
+    QVBoxLayout *layout = new QVBoxLayout(browser);
+    layout->addWidget(view);
+    browser->resize(600, 500);
+    browser->show();
+}
+
+void
+NetworkTree::buildNamespaceBranch(const QString &deviceName, const QModelIndex &index)
+{
+    NamespaceModel *model = _namespaceModels.value(deviceName);
+    QTreeWidgetItem *deviceItem = getDeviceItem(deviceName);
+
+    if(model == nullptr || deviceItem == nullptr || !index.isValid())
+        return;
+
+    NamespaceNode node;
+    if(!model->subtree(index, node, LARGE_NAMESPACE_SIZE))
+    {
+        QMessageBox::warning(this, tr("Namespace"),
+                             tr("%1 has too many addresses to be added to the tree.").arg(QString::fromStdString(model->address(index))));
+        return;
+    }
+
+    // The ancestors which are not in the tree yet
+    QList<QModelIndex> branch;
+    for(QModelIndex it = index; it.isValid(); it = it.parent())
+        branch.prepend(it);
+
+    QTreeWidgetItem *parentItem = deviceItem;
+    for(const auto& it : branch)
+    {
+        QTreeWidgetItem *item = getItemFromAddress(model->address(it));
+
+        if(item == nullptr && it == index)
+        {
+            NetworkTreeItem *branchItem = new NetworkTreeItem(parentItem, QStringList(QString::fromStdString(node.name)),
+                                                              node.isData ? LeaveType : NodeNoNamespaceType);
+            if(node.isData)
+                branchItem->setupProperties(LeafProperties());
+            else
+                branchItem->setupProperties(NodeProperties());
+
+            treeBuild(branchItem, node);
+            setNewItemProperties(branchItem);
+            item = getItemFromAddress(model->address(it));
+        }
+        else if(item == nullptr)
+        {
+            NetworkTreeItem *ancestorItem = new NetworkTreeItem(parentItem, QStringList(model->data(it).toString()), NodeNoNamespaceType);
+            ancestorItem->setupProperties(NodeProperties());
+            setItemAddress(ancestorItem, model->address(it));
+            item = ancestorItem;
+        }
+
+        // Filtered out
+        if(item == nullptr)
+            return;
+
+        parentItem = item;
+    }
+
+    for(QTreeWidgetItem *it = parentItem->parent(); it != nullptr; it = it->parent())
+        expandItem(it);
+    setCurrentItem(parentItem);
+    scrollToItem(parentItem);
+}
+
+void
+NetworkTree::forgetNamespaceModel(const QString &deviceName)
+{
+    NamespaceModel *model = _namespaceModels.take(deviceName);
+
+    // Its browser may still be opened
+    if(model != nullptr)
+    {
+        indexNamespaceModel(model, false);
+        model->deleteLater();
+    }
+}
+
+void
+NetworkTree::indexNamespaceModel(NamespaceModel *model, bool add)
+{
+    for(AddressHandle handle : model->addresses())
+    {
+        if(add)
+            _addressIndex.add(handle);
+        else
+            _addressIndex.remove(handle);
+    }
+}
+
+QTreeWidgetItem *
+NetworkTree::getDeviceItem(const QString &deviceName)
+{
+    QList<QTreeWidgetItem *> items = findItems(deviceName, Qt::MatchExactly, NAME_COLUMN);
+
+    for(auto item : items)
+    {
+        if(item->type() == DeviceNode)
+            return item;
+    }
+    return nullptr;
+}
+
 void NetworkTree::setNewItemProperties(NetworkTreeItem* curItem)
 {
     // Get the required properties from Maquette
@@ -903,9 +1231,22 @@ void NetworkTree::setNewItemProperties(NetworkTreeItem* curItem)
 
     //Gets priority
     unsigned int priority = 0;
+    unsigned int priorityKey = UINT_MAX;
     if(!Maquette::getInstance()->getPriority(address,priority))
     {
         curItem->setText(PRIORITY_COLUMN,QString("%1").arg(priority));
+        if(priority != 0)
+            priorityKey = priority;
+    }
+
+    // the sorted messages depending on this priority are sorted again
+    if(_itemsPriorityKey.value(curItem, UINT_MAX) != priorityKey)
+    {
+        if(priorityKey == UINT_MAX)
+            _itemsPriorityKey.remove(curItem);
+        else
+            _itemsPriorityKey.insert(curItem, priorityKey);
+        _prioritiesRevision++;
     }
 
     // Filtering
@@ -921,6 +1262,8 @@ void NetworkTree::setNewItemProperties(NetworkTreeItem* curItem)
 
         if(toDelete)
         {
+            forgetItemAddresses(curItem);
+            forgetItemCounters(curItem);
             delete curItem;
             return;
         }
@@ -944,18 +1287,27 @@ void NetworkTree::setNewItemProperties(NetworkTreeItem* curItem)
             if(servicesValues[0] == "return")
             {
                 curItem->setupProperties(ReturnProperties());
+                _directedItems.insert(curItem);
+                _addressListValid = false;
                 return;
             }
 
             if(servicesValues[0] == "message")
             {
                 curItem->setupProperties(MessageProperties());
+                _directedItems.insert(curItem);
+                _addressListValid = false;
                 return;
             }
 
             if(servicesValues[0] == "parameter")
             {
                 curItem->setupProperties(ParameterProperties());
+                _directedItems.insert(curItem);
+                _addressListValid = false;
+
+                // read in the background : a snapshot then finds the value in the cache
+                Maquette::getInstance()->prefetchValues(std::vector<std::string>(1, address));
             }
         }
 
@@ -1150,6 +1502,7 @@ void NetworkTree::removeCurrentNode()
         switch (ret) {
             case QMessageBox::Yes:{
                 removeOSCMessage(currentItem());
+                forgetItemAddresses(currentItem());
                 currentItem()->parent()->removeChild(currentItem());
                 break;
             }
@@ -1184,8 +1537,14 @@ NetworkTree::brothersPartiallyChecked(QTreeWidgetItem *item, int column)
     QTreeWidgetItem *father, *child;
     int countCheckedItems = 0;
     int childrenCount = 0;
+    int index = assignationColumnIndex(column);
 
-    if (item->parent() != nullptr) {
+    if (item->parent() != nullptr && index >= 0) {
+        father = item->parent();
+        childrenCount = father->childCount();
+        countCheckedItems = _assignationCounters.value(father).markedChildren[index];
+    }
+    else if (item->parent() != nullptr) {
         father = item->parent();
         childrenCount = father->childCount();
         for (int i = 0; i < childrenCount; i++) {
@@ -1460,33 +1819,11 @@ NetworkTree::fathersAssignation(QTreeWidgetItem *item)
 bool
 NetworkTree::allBrothersAssigned(QTreeWidgetItem *item)
 {
-//    std::cout<<"<-- NetworkTree::allBrothersAssigned("<<item->text(0).toStdString()<<")-->"<<std::endl;
-  QTreeWidgetItem *father, *child;
-
   if (item->parent() != nullptr) {
-      father = item->parent();
-      int childrenCount = father->childCount();
-      for (int i = 0; i < childrenCount; i++) {
-          child = father->child(i);
-          if (child->type() == NodeNoNamespaceType) {
-//                std::cout<<child->text(0).toStdString()<<" > NodeNameSpace"<<std::endl;
-              if (!_nodesWithSomeChildrenAssigned.contains(child)) {
-//                    std::cout<<"----------------------> false1 "<<std::endl;
-                  return false;
-                }
-            }
-          else
-          if (!isAssigned(child)) {
-//                    std::cout<<"----------------------> false2 "<<std::endl;
-              return false;
-            }
-        }
-
-//        std::cout<<"----------------------> true1"<<std::endl;
-      return true;
+      QTreeWidgetItem *father = item->parent();
+      return _assignationCounters.value(father).assignedChildren == father->childCount();
     }
   else {
-//        std::cout<<"----------------------> true2"<<std::endl;
       return true;
     }
 }
@@ -1498,8 +1835,13 @@ NetworkTree::allBrothersChecked(QTreeWidgetItem *item, int column)
    * Tool for columns' values
    */
     QTreeWidgetItem *father, *child;
+    int index = assignationColumnIndex(column);
 
-    if (item->parent() != nullptr) {
+    if (item->parent() != nullptr && index >= 0) {
+        father = item->parent();
+        return _assignationCounters.value(father).checkedChildren[index] == father->childCount();
+    }
+    else if (item->parent() != nullptr) {
         father = item->parent();
         int childrenCount = father->childCount();
         for (int i = 0; i < childrenCount; i++) {
@@ -1531,6 +1873,69 @@ NetworkTree::resetAssignedItems()
     }
 
   _assignedItems.clear();
+
+  // the fathers don't count the leaves anymore
+  for (it = assignedLeaves.begin(); it != assignedLeaves.end(); it++) {
+      updateAssignedCounter(*it);
+    }
+}
+
+void
+NetworkTree::setAssignedItems(QMap<QTreeWidgetItem*, Data> items)
+{
+  QList<QTreeWidgetItem *> previousItems = _assignedItems.keys();
+
+  _assignedItems = items;
+
+  for (QTreeWidgetItem *item : previousItems) {
+      updateAssignedCounter(item);
+    }
+  for (QTreeWidgetItem *item : items.keys()) {
+      updateAssignedCounter(item);
+    }
+}
+
+QList<QTreeWidgetItem*>
+NetworkTree::nodesPartiallyAssigned()
+{
+  return inTreeOrder(_nodesWithSomeChildrenAssigned);
+}
+
+QList<QTreeWidgetItem*>
+NetworkTree::nodesTotallyAssigned()
+{
+  return inTreeOrder(_nodesWithAllChildrenAssigned);
+}
+
+QList<QTreeWidgetItem *>
+NetworkTree::inTreeOrder(const QSet<QTreeWidgetItem *> &items)
+{
+  // the path of child indexes from the top level orders the items as the tree shows them
+  std::vector<std::pair<std::vector<int>, QTreeWidgetItem *> > paths;
+  paths.reserve(items.size());
+
+  for (QTreeWidgetItem *item : items) {
+      std::vector<int> path;
+      for (QTreeWidgetItem *curItem = item; curItem != nullptr; curItem = curItem->parent()) {
+          QTreeWidgetItem *father = curItem->parent();
+          if (father != nullptr) {
+              path.push_back(father->indexOfChild(curItem));
+            }
+          else {
+              path.push_back(curItem->treeWidget() != nullptr ? curItem->treeWidget()->indexOfTopLevelItem(curItem) : -1);
+            }
+        }
+      std::reverse(path.begin(), path.end());
+      paths.push_back(std::make_pair(path, item));
+    }
+  std::sort(paths.begin(), paths.end());
+
+  QList<QTreeWidgetItem *> sorted;
+  for (auto &path : paths) {
+      sorted.append(path.second);
+    }
+
+  return sorted;
 }
 
 void
@@ -1548,7 +1953,6 @@ NetworkTree::resetAssignedNodes()
       curItem = *it;
       unassignPartially(curItem);
     }
-  _nodesWithSomeChildrenAssigned.clear();
 
 
   /*
@@ -1560,7 +1964,6 @@ NetworkTree::resetAssignedNodes()
       curItem = *it;
       unassignTotally(curItem);
     }
-  _nodesWithAllChildrenAssigned.clear();
 }
 
 QList<QTreeWidgetItem*> NetworkTree::getExpandedItems()
@@ -1580,82 +1983,144 @@ QList<QTreeWidgetItem*> NetworkTree::getExpandedItems()
 void
 NetworkTree::refreshItemNamespace(QTreeWidgetItem *item, bool updateBoxes)
 {
-    bool isLearning{isInLearningMode()};
+    if(item == nullptr || item->type() != DeviceNode)
+        return;
+
+    QString deviceName = getAbsoluteAddress(item);
+
+    // A refresh is already waiting for this device : keep what it has to restore
+    if(_pendingExplorations.contains(deviceName))
+    {
+        _pendingExplorations[deviceName].updateBoxes |= updateBoxes;
+        _namespaceExplorer->explore(deviceName, true);
+        return;
+    }
+
+    PendingExploration pending;
+    pending.updateBoxes = updateBoxes;
+    pending.isLearning = isInLearningMode();
+
     // Make a copy of the addresses which were expanded
-    std::vector<std::string> previouslyExpandedAddresses;
     applyInTree(invisibleRootItem(), [&] (QTreeWidgetItem* it)
     {
         if(it->isExpanded())
         {
-            previouslyExpandedAddresses.push_back(getAbsoluteAddress(it).toStdString());
+            pending.expandedAddresses.push_back(getAbsoluteAddress(it).toStdString());
         }
     });
 
     // Make a copy of all the addresses
-    std::vector<std::string> previousAddressMap;
-    if(isLearning)
+    if(pending.isLearning)
     {
-        for(auto& addr : _addressMap)
+        for(auto addr : _itemsAddress)
         {
-            previousAddressMap.push_back(addr);
+            pending.previousAddresses.insert(addr);
         }
     }
 
-    if(item != nullptr)
-    {
-        if(item->type() == DeviceNode)
-        {
-            collapseItem(item);
-            string application = getAbsoluteAddress(item).toStdString();
-            item->takeChildren();
+    collapseItem(item);
+    for(int i = 0; i < item->childCount(); i++) {
+        forgetItemAddresses(item->child(i));
+        forgetItemCounters(item->child(i));
+    }
+    item->takeChildren();
+    item->setToolTip(NAME_COLUMN, tr("Exploring the namespace..."));
+
+    _pendingExplorations[deviceName] = pending;
+
+    /// \todo récupérer la valeur de retour de rebuildNetworkNamespace.
+    /// Peut être false en cas de OSC (traitement différent dans ce cas là).
+    _namespaceExplorer->explore(deviceName, true);
+}
+
+void
+NetworkTree::deviceExplored(const QString &deviceName, const NamespaceNode &root)
+{
+    PendingExploration pending = _pendingExplorations.take(deviceName);
+    QTreeWidgetItem *item = getDeviceItem(deviceName);
 
-            /// \todo récupérer la valeur de retour.
-            /// Peut être false en cas de OSC (traitement différent dans ce cas là).
-            Maquette::getInstance()->rebuildNetworkNamespace(application);
-            treeRecursiveExploration(item, true);
-            if(updateBoxes)
-                Maquette::getInstance()->updateBoxesAttributes();
+    // The device was removed meanwhile
+    if(item == nullptr)
+        return;
 
-            if(isOSC(item))
-                createOSCBranch(item);
+    item->setToolTip(NAME_COLUMN, QString());
+    for(int i = 0; i < item->childCount(); i++) {
+        forgetItemAddresses(item->child(i));
+        forgetItemCounters(item->child(i));
+    }
+    item->takeChildren();
+
+    // Too many addresses for an item each : they are browsed with a model instead
+    if(NamespaceModel::countNodes(root) > LARGE_NAMESPACE_SIZE)
+    {
+        NamespaceModel *model = _namespaceModels.value(deviceName);
+        if(model == nullptr)
+        {
+            model = new NamespaceModel(deviceName, this);
+            _namespaceModels[deviceName] = model;
         }
+        else
+            indexNamespaceModel(model, false);
+        model->setNamespace(root);
+        indexNamespaceModel(model, true);
+        setItemAddress(item, deviceName.toStdString());
+
+        QTreeWidgetItem *browseItem = new QTreeWidgetItem(QStringList(tr("%1 addresses : double-click to browse").arg(model->nodeCount())), LargeNamespaceNode);
+        browseItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+        browseItem->setToolTip(NAME_COLUMN, tr("Double-click an address of the browser to add its branch to the tree"));
+        item->addChild(browseItem);
+    }
+    else
+    {
+        forgetNamespaceModel(deviceName);
+        treeBuild(item, root);
     }
 
+    if(pending.updateBoxes)
+        Maquette::getInstance()->updateBoxesAttributes();
+
+    if(isOSC(item))
+        createOSCBranch(item);
+
     // Restore the addresses
     QList<QTreeWidgetItem*> itemsToExpand;
 
     // The ones that were expanded
-    for(auto& addr : previouslyExpandedAddresses)
+    for(auto& addr : pending.expandedAddresses)
     {
-        if(std::find(_addressMap.begin(),
-                     _addressMap.end(),
-                     addr) != _addressMap.end())
-        {
-            const auto& tree_items = _addressMap.keys(addr);
-            for(auto& item : tree_items)
-                itemsToExpand.append(item);
-        }
+        QTreeWidgetItem *expandedItem = getItemFromAddress(addr);
+        if(expandedItem != nullptr)
+            itemsToExpand.append(expandedItem);
     }
 
     // The new ones
-    if(isLearning)
+    if(pending.isLearning)
     {
-        for(auto& addr : _addressMap)
+        for(auto it = _addressesItem.begin(); it != _addressesItem.end(); ++it)
         {
-            if(std::find(previousAddressMap.begin(),
-                         previousAddressMap.end(),
-                         addr) == previousAddressMap.end())
-            {
-                const auto& tree_items = _addressMap.keys(addr);
-                for(auto& item : tree_items)
-                    itemsToExpand.append(item);
-            }
+            if(!pending.previousAddresses.contains(it.key()))
+                itemsToExpand.append(it.value());
         }
     }
 
     expandItems(itemsToExpand);
 }
 
+void
+NetworkTree::deviceExplorationTimedOut(const QString &deviceName)
+{
+    _pendingExplorations.remove(deviceName);
+    QTreeWidgetItem *item = getDeviceItem(deviceName);
+
+    if(item == nullptr)
+        return;
+
+    item->setToolTip(NAME_COLUMN, tr("%1 did not answer").arg(deviceName));
+
+    if(isOSC(item))
+        createOSCBranch(item);
+}
+
 void
 NetworkTree::refreshCurrentItemNamespace()
 {
@@ -1675,8 +2140,15 @@ NetworkTree::deleteCurrentItemNamespace()
                                         QMessageBox::Cancel);
         switch (ret) {
         case QMessageBox::Yes:{
+            forgetItemAddresses(currentItem());
+            forgetItemCounters(currentItem());
+            forgetNamespaceModel(itemName);
             delete currentItem();
+            _pendingExplorations.remove(itemName);
             Maquette::getInstance()->removeNetworkDevice(itemName.toStdString());
+
+            // nothing refers to the device addresses anymore but the engine, which retains those it still uses
+            AddressTrie::getInstance()->releaseDevice(itemName.toStdString());
             return;
         }
 
@@ -1985,6 +2457,9 @@ NetworkTree::mouseDoubleClickEvent(QMouseEvent *event)
         else if (currentItem()->type() == addOSCNode) {
             ;
         }
+        else if (currentItem()->type() == LargeNamespaceNode) {
+            browseNamespace(currentItem()->parent()->text(NAME_COLUMN));
+        }
         else if (currentItem()->type() == DeviceNode) {
             if(currentColumn() == NAME_COLUMN){
                 QString deviceName = currentItem()->text(NAME_COLUMN);
@@ -2229,25 +2704,20 @@ NetworkTree::getAbsoluteAddressWithValue(QTreeWidgetItem *item, int column) cons
 
 QList<string> NetworkTree::getAddressList()
 {
-    QList<string> addressList;
-    QMap<QTreeWidgetItem *, string>::iterator it;
-    for (it = _addressMap.begin(); it != _addressMap.end(); it++) {
-        if(it.key() != nullptr) {
-            QTreeWidgetItem* item = it.key();
-            if(checkPredicateInTree(this->invisibleRootItem(), [&item] (QTreeWidgetItem* node)
-                    {
-                        return node == item;
-                    }))
-            {
-                if (it.key()->toolTip(NetworkTree::TYPE_COLUMN) != nullptr) {
-                    if( it.key()->toolTip(NetworkTree::TYPE_COLUMN) == "bi-directionnal" || it.key()->toolTip(NetworkTree::TYPE_COLUMN) == "receiver" || it.key()->toolTip(NetworkTree::TYPE_COLUMN) == "sender" ) {
-                        addressList << it.value();
-                    }
-                }
-            }
-        }
+    if(_addressListValid)
+        return _addressList;
+
+    // The items of the tree are the ones with an address
+    _addressList.clear();
+    for(QTreeWidgetItem *item : _directedItems)
+    {
+        QHash<QTreeWidgetItem *, AddressHandle>::const_iterator address = _itemsAddress.find(item);
+        if(address != _itemsAddress.end())
+            _addressList << AddressTrie::getInstance()->address(address.value());
     }
-    return addressList;
+    _addressListValid = true;
+
+    return _addressList;
 }
 
 void
@@ -2340,6 +2810,7 @@ NetworkTree::changeNameValue(QTreeWidgetItem *item, QString newValue)
           _endMessages->removeMessage(item);
           _OSCEndMessages->removeMessage(item);
           _OSCStartMessages->removeMessage(item);
+          forgetItemAddresses(item);
           item->parent()->removeChild(item);
 
           removeAssignItem(item);
@@ -2521,9 +2992,15 @@ NetworkTree::updateLine(QTreeWidgetItem *item, bool interpolationState, int samp
 void
 NetworkTree::updateDeviceName(QString oldName, QString newName)
 {
+    // The addresses of its model were interned with the old name
+    bool largeNamespace = _namespaceModels.contains(oldName);
+    forgetNamespaceModel(oldName);
+
     if(currentItem()!=nullptr){
         if(currentItem()->text(NAME_COLUMN) == oldName){
             currentItem()->setText(NAME_COLUMN, newName);
+            if(largeNamespace)
+                refreshItemNamespace(currentItem(), false);
             return;
         }        
     }
@@ -2540,6 +3017,8 @@ NetworkTree::updateDeviceName(QString oldName, QString newName)
             for(int i=0 ; i<items.size() ; i++){
                 if(items[i]->type() == DeviceNode){ //first deviceType found is set
                     items[i]->setText(NAME_COLUMN, newName);
+                    if(largeNamespace)
+                        refreshItemNamespace(items[i], false);
                     return;
                 }
             }
@@ -2563,7 +3042,12 @@ NetworkTree::updateDeviceProtocol(QString newName)
 {           
   QString deviceName = currentItem()->text(NAME_COLUMN);
   QTreeWidgetItem *item = currentItem();
+  for (int i = 0; i < item->childCount(); i++) {
+      forgetItemAddresses(item->child(i));
+      forgetItemCounters(item->child(i));
+    }
   item->takeChildren();
+  forgetNamespaceModel(deviceName);
 
   if (newName == "OSC")
       createOSCBranch(item);
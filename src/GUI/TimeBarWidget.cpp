@@ -44,11 +44,14 @@
 #include "MaquetteView.hpp"
 
 #include <QDebug>
+#include <QPixmapCache>
 
 class MaquetteScene;
 
 const float TimeBarWidget::TIME_BAR_HEIGHT = 15.;
 const float TimeBarWidget::LEFT_MARGIN = 0.5;
+const int TimeBarWidget::TILE_WIDTH = 500;
+const int TimeBarWidget::LABEL_WIDTH = 40;
 static const int S_TO_MS = 1000;
 
 TimeBarWidget::TimeBarWidget(QWidget *parent, MaquetteScene *scene)
@@ -78,13 +81,14 @@ TimeBarWidget::mousePressEvent(QMouseEvent *event)
 
 void TimeBarWidget::moveEvent(QMoveEvent *)
 {
-  redrawPixmap();
+  // Tiles are already rendered, only compose them again
+  update();
 }
 
 void
 TimeBarWidget::updateZoom(float /*value*/)
 {
-  redrawPixmap();
+  update();
 }
 
 void TimeBarWidget::updateSize()
@@ -95,46 +99,64 @@ void TimeBarWidget::updateSize()
                 _scene->view()->size().width(), TIME_BAR_HEIGHT);
 
   setGeometry(_rect);
-  _pixmap = QPixmap(_rect.width(), _rect.height());
 
   setFixedHeight(height());
 
-  redrawPixmap();
+  update();
 }
 
-void TimeBarWidget::redrawPixmap()
+QPixmap
+TimeBarWidget::tile(int tileIndex)
 {
-  _pixmap.fill(QColor(Qt::transparent));
-  if(_pixmap.isNull()) return;
-  _painter.begin(&_pixmap);
+  // Keyed by (zoom, tile index) : zooming back reuses the tiles already rendered
+  QString key = QString("TimeBarWidget_%1_%2").arg(MaquetteScene::MS_PER_PIXEL).arg(tileIndex);
+  QPixmap pixmap;
+
+  if (!QPixmapCache::find(key, &pixmap)) {
+      pixmap = QPixmap(TILE_WIDTH, TIME_BAR_HEIGHT);
+      renderTile(pixmap, tileIndex);
+      QPixmapCache::insert(key, pixmap);
+    }
+
+  return pixmap;
+}
+
+void TimeBarWidget::renderTile(QPixmap &pixmap, int tileIndex)
+{
+  pixmap.fill(QColor(Qt::transparent));
+  if(pixmap.isNull()) return;
+  // Not _painter : tiles are rendered while the widget is being painted
+  QPainter painter(&pixmap);
 
-  _painter.setFont(_font);
-  _painter.setRenderHint(QPainter::Antialiasing, true);
+  painter.setFont(_font);
+  painter.setRenderHint(QPainter::Antialiasing, true);
 
   const float factor{MaquetteScene::MS_PER_PIXEL / 16};
   const int grad_width_in_px{S_TO_MS / 16};
-  const int h_origin{x()};
+  const int h_origin{tileIndex * TILE_WIDTH};
 
-  int pos{((h_origin / grad_width_in_px) + 1 ) * grad_width_in_px - h_origin};
+  // Start before the tile so that labels of the previous graduations overlapping it are drawn
+  int first_grad{(h_origin - LABEL_WIDTH) / grad_width_in_px};
+  if (first_grad < 1)
+    first_grad = 1;
 
-  for(int i = 0;
-      i < width() / grad_width_in_px + 1;
-      ++i)
+  for(int pos = first_grad * grad_width_in_px - h_origin;
+      pos < TILE_WIDTH;
+      pos += grad_width_in_px)
   {
-    _painter.drawLine(QPointF(pos, 3 * TIME_BAR_HEIGHT / 4), QPointF(pos, TIME_BAR_HEIGHT));
+    painter.drawLine(QPointF(pos, 3 * TIME_BAR_HEIGHT / 4), QPointF(pos, TIME_BAR_HEIGHT));
     float secondDrawn = ((h_origin + pos) / grad_width_in_px) * factor;
 
     if(factor >= 1)
     {
-      _painter.drawText(QPointF(pos, 2 * TIME_BAR_HEIGHT / 3), QString("%1'%2").arg(int(secondDrawn) / 60).arg(int(secondDrawn) % 60));
+      painter.drawText(QPointF(pos, 2 * TIME_BAR_HEIGHT / 3), QString("%1'%2").arg(int(secondDrawn) / 60).arg(int(secondDrawn) % 60));
     }
     else
     {
-      _painter.drawText(QPointF(pos, 2 * TIME_BAR_HEIGHT / 3), QString("%1").arg(secondDrawn));
+      painter.drawText(QPointF(pos, 2 * TIME_BAR_HEIGHT / 3), QString("%1").arg(secondDrawn));
     }
-    pos += grad_width_in_px;
   }
-  _painter.end();
+  painter.end();
 }
 
 void
@@ -142,8 +164,14 @@ TimeBarWidget::paintEvent(QPaintEvent *event)
 {
   Q_UNUSED(event);
 
+  const int h_origin{x()};
+  const int first_tile{(h_origin >= 0 ? h_origin : h_origin - TILE_WIDTH + 1) / TILE_WIDTH};
+  const int last_tile{(h_origin + width()) / TILE_WIDTH};
+
   _painter.begin(this);
   _painter.drawRect(_rect);
-  _painter.drawPixmap(0, 0, _rect.width(), _rect.height(), _pixmap);
+  for (int i = first_tile; i <= last_tile; ++i) {
+      _painter.drawPixmap(i * TILE_WIDTH - h_origin, 0, tile(i));
+    }
   _painter.end();
 }
@@ -0,0 +1,272 @@
+#include "HeadlessRunner.hpp"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <iostream>
+
+HeadlessRunner *HeadlessRunner::_instance = nullptr;
+
+HeadlessRunner::HeadlessRunner(const QString &jamomaFolder, bool quitAtEnd, bool printExecution, bool compiled)
+  : QObject(), _quitAtEnd(quitAtEnd), _printExecution(printExecution), _compiled(compiled), _lookahead(0), _startPoint(0)
+{
+  _instance = this;
+
+  _planTimer = new QTimer(this);
+  _planTimer->setInterval(100);
+  connect(_planTimer, SIGNAL(timeout()), this, SLOT(checkPlaybackPlan()));
+
+  _engines = new Engine(&triggerPointIsActiveCallback, &boxIsRunningCallback, &transportCallback,
+                        &deviceCallback, &deviceConnectionErrorCallback, NULL, jamomaFolder.toStdString());
+
+  // Engine callbacks are not called from the main thread
+  connect(this, SIGNAL(playSignal()), this, SLOT(play()), Qt::QueuedConnection);
+  connect(this, SIGNAL(stopSignal()), this, SLOT(stop()), Qt::QueuedConnection);
+  connect(this, SIGNAL(pauseSignal()), this, SLOT(pause()), Qt::QueuedConnection);
+  connect(this, SIGNAL(rewindSignal()), this, SLOT(rewind()), Qt::QueuedConnection);
+  connect(this, SIGNAL(startPointSignal(uint)), this, SLOT(setStartPoint(uint)), Qt::QueuedConnection);
+  connect(this, SIGNAL(speedSignal(double)), this, SLOT(setSpeed(double)), Qt::QueuedConnection);
+  connect(this, SIGNAL(scenarioEndedSignal()), this, SLOT(scenarioEnded()), Qt::QueuedConnection);
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+  if (_engines->isPlaying())
+    _engines->stop();
+
+  joinPrintThread();
+  delete _engines;
+  _instance = nullptr;
+}
+
+bool
+HeadlessRunner::load(const QString &fileName)
+{
+  if (!QFile::exists(fileName)) {
+      std::cerr << "HeadlessRunner::load : " << fileName.toStdString() << " not found" << std::endl;
+      return false;
+    }
+
+  if (!_engines->load(fileName.toStdString())) {
+      std::cerr << "HeadlessRunner::load : can't load " << fileName.toStdString() << std::endl;
+      return false;
+    }
+
+  std::vector<TimeBoxId> boxesId;
+  _engines->getBoxesId(boxesId);
+  std::cout << fileName.toStdString() << " loaded (" << boxesId.size() - 1 << " boxes)" << std::endl;
+
+  return true;
+}
+
+void
+HeadlessRunner::play()
+{
+  // The fixed portion of the score is sent by the playback plan thread
+  if (_compiled) {
+      if (_engines->isPlayingPlaybackPlan())
+        return;
+
+      // the devices of the project may have changed since the last play
+      std::vector<std::string> devices;
+      _engines->getNetworkDevicesName(devices);
+      for (auto &device : devices)
+        _engines->setDeviceBundles(device, _lookahead > 0);
+      _engines->setPlaybackLookahead(_lookahead);
+
+      TimeValue end = 0;
+      unsigned int nbMessages = _engines->compilePlaybackPlan(_startPoint, end);
+      if (nbMessages == 0) {
+          std::cout << "Nothing to play from " << _startPoint << " ms" << std::endl;
+          return;
+        }
+
+      std::cout << "Play " << nbMessages << " compiled messages from " << _startPoint << " to " << end << " ms" << std::endl;
+      if (end < _engines->getBoxEndTime(ROOT_BOX_ID))
+        std::cout << "The score waits for a trigger point or loops from " << end << " ms : the rest is not played" << std::endl;
+
+      _engines->playPlaybackPlan();
+      _planTimer->start();
+      return;
+    }
+
+  if (_engines->isPaused()) {
+      _engines->pause(false);
+      return;
+    }
+
+  if (_engines->isPlaying())
+    return;
+
+  _engines->setTimeOffset(_startPoint);
+  _engines->play();
+  std::cout << "Play from " << _startPoint << " ms" << std::endl;
+
+  // Printing blocks until the end of the execution : don't block the transport
+  if (_printExecution) {
+      joinPrintThread();
+      _printThread = std::thread(&Engine::printExecutionInLinuxConsole, _engines);
+    }
+}
+
+void
+HeadlessRunner::stop()
+{
+  if (_compiled) {
+      _planTimer->stop();
+      _engines->stopPlaybackPlan();
+    }
+
+  if (_engines->isPlaying())
+    _engines->stop();
+
+  joinPrintThread();
+  _engines->setTimeOffset(_startPoint);
+  std::cout << "Stop" << std::endl;
+}
+
+void
+HeadlessRunner::setLookahead(unsigned int lookahead)
+{
+  _lookahead = lookahead;
+}
+
+void
+HeadlessRunner::setMessageBudget(unsigned int messagesBySecond, unsigned int tick)
+{
+  std::vector<std::string> devices;
+  _engines->getNetworkDevicesName(devices);
+
+  for (auto &device : devices)
+    _engines->setDeviceMessageBudget(device, messagesBySecond);
+
+  _engines->setOutputTick(tick);
+}
+
+void
+HeadlessRunner::checkPlaybackPlan()
+{
+  if (_engines->isPlayingPlaybackPlan())
+    return;
+
+  _planTimer->stop();
+
+  EnginePlanStatistics statistics = _engines->getPlaybackPlanStatistics();
+  if (statistics.sentMessages > 0)
+    std::cout << statistics.sentMessages << " messages sent, "
+              << statistics.totalLateness / statistics.sentMessages << " us late on average, "
+              << statistics.maxLateness << " us at most" << std::endl;
+
+  for (auto &device : _engines->getPlaybackLookaheadStatistics())
+    std::cout << device.first << " : " << device.second.sentBundles << " bundles sent, "
+              << device.second.totalAdvance / device.second.sentBundles << " us ahead on average, "
+              << device.second.minAdvance << " us at least" << std::endl;
+
+  for (auto &output : _engines->getOutputMetrics())
+    std::cout << output.first << " output : " << output.second.sentMessages << " messages sent, "
+              << output.second.maxDepth << " queued at most, "
+              << output.second.droppedSamples << " curve samples replaced, "
+              << output.second.budgetDrops << " over budget" << std::endl;
+
+  scenarioEnded();
+}
+
+void
+HeadlessRunner::joinPrintThread()
+{
+  if (_printThread.joinable())
+    _printThread.join();
+}
+
+void
+HeadlessRunner::pause()
+{
+  if (_engines->isPlaying())
+    _engines->pause(!_engines->isPaused());
+}
+
+void
+HeadlessRunner::rewind()
+{
+  _startPoint = 0;
+  stop();
+}
+
+void
+HeadlessRunner::setStartPoint(unsigned int timeOffset)
+{
+  _startPoint = timeOffset;
+
+  if (!_engines->isPlaying())
+    _engines->setTimeOffset(_startPoint);
+}
+
+void
+HeadlessRunner::setSpeed(double speed)
+{
+  _engines->setExecutionSpeedFactor(speed);
+}
+
+void
+HeadlessRunner::scenarioEnded()
+{
+  std::cout << "Main scenario ended" << std::endl;
+  joinPrintThread();
+
+  if (_quitAtEnd)
+    QCoreApplication::quit();
+}
+
+void
+HeadlessRunner::triggerPointIsActiveCallback(ConditionedTimeBoxId triggerId, bool active)
+{
+  // Nobody to click on trigger points : they can only be triggered by their expression
+  if (active)
+    std::cout << "Trigger point " << triggerId << " is waiting" << std::endl;
+}
+
+void
+HeadlessRunner::boxIsRunningCallback(TimeBoxId boxId, bool running)
+{
+  if (_instance != nullptr && boxId == ROOT_BOX_ID && !running)
+    emit _instance->scenarioEndedSignal();
+}
+
+void
+HeadlessRunner::transportCallback(TTSymbol &transport, const TTValue &value)
+{
+  if (_instance == nullptr)
+    return;
+
+  if (transport == TTSymbol("Play"))
+    emit _instance->playSignal();
+
+  else if (transport == TTSymbol("Stop"))
+    emit _instance->stopSignal();
+
+  else if (transport == TTSymbol("Pause"))
+    emit _instance->pauseSignal();
+
+  else if (transport == TTSymbol("Rewind"))
+    emit _instance->rewindSignal();
+
+  else if (transport == TTSymbol("StartPoint")) {
+      if (value.size() == 1 && value[0].type() == kTypeUInt32)
+        emit _instance->startPointSignal(TTUInt32(value[0]));
+    }
+  else if (transport == TTSymbol("Speed")) {
+      if (value.size() == 1 && value[0].type() == kTypeFloat32)
+        emit _instance->speedSignal(TTFloat32(value[0]));
+    }
+}
+
+void
+HeadlessRunner::deviceCallback(TTSymbol &/*deviceName*/)
+{
+  // No namespace tree to update
+}
+
+void
+HeadlessRunner::deviceConnectionErrorCallback(TTSymbol &deviceName, TTSymbol &errorInfo)
+{
+  std::cerr << "Can't connect to " << deviceName.c_str() << " : " << errorInfo.c_str() << std::endl;
+}
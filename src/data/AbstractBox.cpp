@@ -49,7 +49,8 @@ AbstractBox::AbstractBox(const QPointF &newTopLeft, const float &newWidth, const
                          const string &newName, const QColor &newColor, unsigned int newID, unsigned int motherID,
                          NetworkMessages *startMessages, NetworkMessages *endMessages) :
   _topLeft(newTopLeft), _width(newWidth), _height(newHeight), _name(newName), _color(newColor),
-  _ID(newID), _motherID(motherID), _startMessages(startMessages),_endMessages(endMessages)
+  _ID(newID), _motherID(motherID), _startMessages(startMessages),_endMessages(endMessages),
+  _date(0), _duration(0), _hasDates(false)
 {
     _networkTreeExpandedItems = QList<QTreeWidgetItem*>();
     _messagesToRecord = QList<std::string>();
@@ -59,7 +60,8 @@ AbstractBox::AbstractBox(const QPointF &newTopLeft, const float &newWidth, const
 AbstractBox::AbstractBox(const AbstractBox &other) :
   Abstract(), _topLeft(other._topLeft), _width(other._width), _height(other._height),
   _name(other._name), _color(other._color), _ID(other._ID), _motherID(other._motherID),
-  _startMessages(other._startMessages),_endMessages(other._endMessages)
+  _startMessages(other._startMessages),_endMessages(other._endMessages),
+  _date(other._date), _duration(other._duration), _hasDates(other._hasDates)
 {
     _networkTreeExpandedItems = QList<QTreeWidgetItem*>();
     _messagesToRecord = QList<std::string>();
@@ -0,0 +1,218 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "AddressIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+using std::string;
+using std::vector;
+
+bool
+AddressIndex::ByAddress::operator()(AddressHandle a, AddressHandle b) const
+{
+  int compare = index->key(a).compare(index->key(b));
+
+  return compare < 0 || (compare == 0 && a < b);
+}
+
+AddressIndex::AddressIndex()
+  : _sorted(ByAddress{this}), _size(0)
+{
+}
+
+const string &
+AddressIndex::key(AddressHandle handle) const
+{
+  return handle == NO_ADDRESS ? _probe : _entries[handle].address;
+}
+
+string
+AddressIndex::lowered(const string &text)
+{
+  string result(text);
+  std::transform(result.begin(), result.end(), result.begin(), [] (unsigned char c) { return std::tolower(c); });
+
+  return result;
+}
+
+vector<AddressIndex::Trigram>
+AddressIndex::trigrams(const string &text)
+{
+  vector<Trigram> result;
+  for (string::size_type i = 0; i + 3 <= text.size(); i++) {
+      result.push_back((Trigram((unsigned char)text[i]) << 16) | (Trigram((unsigned char)text[i + 1]) << 8) | Trigram((unsigned char)text[i + 2]));
+    }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+
+  return result;
+}
+
+void
+AddressIndex::add(AddressHandle handle)
+{
+  if (handle == NO_ADDRESS) {
+      return;
+    }
+
+  if (handle >= _entries.size()) {
+      _entries.resize(handle + 1);
+    }
+
+  Entry &entry = _entries[handle];
+
+  // first time : list it in its trigrams, for good
+  if (entry.address.empty()) {
+      entry.address = lowered(AddressTrie::getInstance()->address(handle));
+      for (Trigram trigram : trigrams(entry.address)) {
+          _postings[trigram].push_back(handle);
+        }
+    }
+
+  if (entry.count++ == 0) {
+      _sorted.insert(handle);
+      _size++;
+    }
+}
+
+void
+AddressIndex::remove(AddressHandle handle)
+{
+  if (handle >= _entries.size() || _entries[handle].count == 0) {
+      return;
+    }
+
+  if (--_entries[handle].count == 0) {
+      _sorted.erase(handle);
+      _size--;
+    }
+}
+
+void
+AddressIndex::clear()
+{
+  _sorted.clear();
+  for (auto &entry : _entries) {
+      entry.count = 0;
+    }
+  _size = 0;
+}
+
+bool
+AddressIndex::contains(AddressHandle handle) const
+{
+  return handle < _entries.size() && _entries[handle].count > 0;
+}
+
+unsigned int
+AddressIndex::size() const
+{
+  return _size;
+}
+
+vector<AddressHandle>
+AddressIndex::findPrefix(const string &prefix, unsigned int maxResults) const
+{
+  vector<AddressHandle> result;
+
+  _probe = lowered(prefix);
+  for (auto it = _sorted.lower_bound(NO_ADDRESS); it != _sorted.end() && result.size() < maxResults; ++it) {
+      if (_entries[*it].address.compare(0, _probe.size(), _probe) != 0) {
+          break;
+        }
+      result.push_back(*it);
+    }
+
+  return result;
+}
+
+vector<AddressHandle>
+AddressIndex::find(const string &text, unsigned int maxResults) const
+{
+  vector<AddressHandle> result;
+  string searched = lowered(text);
+
+  if (searched.empty()) {
+      return result;
+    }
+
+  // too short for a trigram : the sorted addresses are checked until enough are found
+  vector<Trigram> searchedTrigrams = trigrams(searched);
+  if (searchedTrigrams.empty()) {
+      for (auto it = _sorted.begin(); it != _sorted.end() && result.size() < maxResults; ++it) {
+          if (_entries[*it].address.find(searched) != string::npos) {
+              result.push_back(*it);
+            }
+        }
+      return result;
+    }
+
+  // the rarest trigram lists every address containing the text
+  const vector<AddressHandle> *candidates = nullptr;
+  for (Trigram trigram : searchedTrigrams) {
+      auto posting = _postings.find(trigram);
+      if (posting == _postings.end()) {
+          return result;
+        }
+      if (candidates == nullptr || posting->second.size() < candidates->size()) {
+          candidates = &posting->second;
+        }
+    }
+
+  for (AddressHandle handle : *candidates) {
+      if (_entries[handle].count > 0 && _entries[handle].address.find(searched) != string::npos) {
+          result.push_back(handle);
+        }
+    }
+
+  ByAddress byAddress{this};
+  if (result.size() > maxResults) {
+      std::partial_sort(result.begin(), result.begin() + maxResults, result.end(), byAddress);
+      result.resize(maxResults);
+    }
+  else {
+      std::sort(result.begin(), result.end(), byAddress);
+    }
+
+  return result;
+}
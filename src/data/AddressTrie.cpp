@@ -0,0 +1,334 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "AddressTrie.hpp"
+
+#include <algorithm>
+
+using std::string;
+using std::vector;
+
+AddressTrie *AddressTrie::_instance = nullptr;
+
+AddressTrie::AddressTrie()
+{
+  _segments.push_back(string());
+  _nodes.push_back(Node{NO_ADDRESS, 0, NO_ADDRESS, NO_ADDRESS, 0, false});
+}
+
+AddressTrie *
+AddressTrie::getInstance()
+{
+  static std::once_flag created;
+  std::call_once(created, [] { _instance = new AddressTrie(); });
+
+  return _instance;
+}
+
+unsigned long long
+AddressTrie::childKey(AddressHandle parent, unsigned int segment)
+{
+  return (static_cast<unsigned long long>(parent) << 32) | segment;
+}
+
+AddressHandle
+AddressTrie::findChild(AddressHandle parent, const string &segment) const
+{
+  std::unordered_map<string, unsigned int>::const_iterator id = _segmentsIds.find(segment);
+  if (id == _segmentsIds.end()) {
+      return NO_ADDRESS;
+    }
+
+  std::unordered_map<unsigned long long, AddressHandle>::const_iterator it = _children.find(childKey(parent, id->second));
+
+  return it != _children.end() ? it->second : NO_ADDRESS;
+}
+
+AddressHandle
+AddressTrie::internChild(AddressHandle parent, const string &segment)
+{
+  std::unordered_map<string, unsigned int>::iterator id = _segmentsIds.find(segment);
+  if (id == _segmentsIds.end()) {
+      id = _segmentsIds.insert(std::make_pair(segment, static_cast<unsigned int>(_segments.size()))).first;
+      _segments.push_back(segment);
+    }
+
+  std::unordered_map<unsigned long long, AddressHandle>::iterator it = _children.find(childKey(parent, id->second));
+  if (it != _children.end()) {
+      // interned again : the device was added back
+      _nodes[it->second].released = false;
+      return it->second;
+    }
+
+  AddressHandle handle;
+  Node node = {parent, id->second, NO_ADDRESS, _nodes[parent].firstChild, 0, false};
+  if (_freeNodes.empty()) {
+      handle = _nodes.size();
+      _nodes.push_back(node);
+    }
+  else {
+      handle = _freeNodes.back();
+      _freeNodes.pop_back();
+      _nodes[handle] = node;
+    }
+  _nodes[parent].firstChild = handle;
+  _children[childKey(parent, id->second)] = handle;
+
+  return handle;
+}
+
+AddressHandle
+AddressTrie::intern(const string &address)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  AddressHandle handle = NO_ADDRESS;
+  string::size_type begin = 0, end;
+
+  while (begin <= address.size()) {
+      end = address.find('/', begin);
+      if (end == string::npos) {
+          end = address.size();
+        }
+      if (end > begin) {
+          handle = internChild(handle, address.substr(begin, end - begin));
+        }
+      begin = end + 1;
+    }
+
+  return handle;
+}
+
+AddressHandle
+AddressTrie::intern(AddressHandle parent, const string &segment)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (parent >= _nodes.size() || segment.empty()) {
+      return parent;
+    }
+
+  return internChild(parent, segment);
+}
+
+AddressHandle
+AddressTrie::find(const string &address) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  AddressHandle handle = NO_ADDRESS;
+  string::size_type begin = 0, end;
+
+  while (begin <= address.size()) {
+      end = address.find('/', begin);
+      if (end == string::npos) {
+          end = address.size();
+        }
+      if (end > begin) {
+          handle = findChild(handle, address.substr(begin, end - begin));
+          if (handle == NO_ADDRESS) {
+              return NO_ADDRESS;
+            }
+        }
+      begin = end + 1;
+    }
+
+  return handle;
+}
+
+string
+AddressTrie::address(AddressHandle handle) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (handle >= _nodes.size()) {
+      return string();
+    }
+
+  vector<AddressHandle> path;
+  for (AddressHandle h = handle; h != NO_ADDRESS; h = _nodes[h].parent) {
+      path.push_back(h);
+    }
+
+  string result;
+  for (vector<AddressHandle>::reverse_iterator it = path.rbegin(); it != path.rend(); ++it) {
+      if (!result.empty()) {
+          result += '/';
+        }
+      result += _segments[_nodes[*it].segment];
+    }
+
+  return result;
+}
+
+string
+AddressTrie::segment(AddressHandle handle) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return handle < _nodes.size() ? _segments[_nodes[handle].segment] : string();
+}
+
+AddressHandle
+AddressTrie::parent(AddressHandle handle) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return handle < _nodes.size() ? _nodes[handle].parent : NO_ADDRESS;
+}
+
+vector<AddressHandle>
+AddressTrie::children(AddressHandle handle) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  vector<AddressHandle> result;
+  if (handle < _nodes.size()) {
+      for (AddressHandle child = _nodes[handle].firstChild; child != NO_ADDRESS; child = _nodes[child].nextSibling) {
+          result.push_back(child);
+        }
+      std::sort(result.begin(), result.end(), [this](AddressHandle a, AddressHandle b) {
+          return _segments[_nodes[a].segment] < _segments[_nodes[b].segment];
+        });
+    }
+
+  return result;
+}
+
+bool
+AddressTrie::isBelow(AddressHandle handle, AddressHandle ancestor) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (handle >= _nodes.size()) {
+      return false;
+    }
+
+  for (AddressHandle h = handle; h != NO_ADDRESS; h = _nodes[h].parent) {
+      if (h == ancestor) {
+          return true;
+        }
+    }
+
+  return ancestor == NO_ADDRESS;
+}
+
+unsigned int
+AddressTrie::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return _nodes.size() - 1 - _freeNodes.size();
+}
+
+bool
+AddressTrie::forget(AddressHandle handle)
+{
+  Node &node = _nodes[handle];
+  if (handle == NO_ADDRESS || !node.released || node.references > 0 || node.firstChild != NO_ADDRESS) {
+      return false;
+    }
+
+  // unlink the node from its parent children
+  AddressHandle *link = &_nodes[node.parent].firstChild;
+  while (*link != handle) {
+      link = &_nodes[*link].nextSibling;
+    }
+  *link = node.nextSibling;
+
+  _children.erase(childKey(node.parent, node.segment));
+  node = Node{NO_ADDRESS, 0, NO_ADDRESS, NO_ADDRESS, 0, false};
+  _freeNodes.push_back(handle);
+
+  return true;
+}
+
+void
+AddressTrie::retain(AddressHandle handle)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (handle != NO_ADDRESS && handle < _nodes.size()) {
+      _nodes[handle].references++;
+    }
+}
+
+void
+AddressTrie::release(AddressHandle handle)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (handle == NO_ADDRESS || handle >= _nodes.size() || _nodes[handle].references == 0) {
+      return;
+    }
+
+  // the parents are forgotten with their last child
+  if (--_nodes[handle].references == 0) {
+      AddressHandle parent = _nodes[handle].parent;
+      while (forget(handle)) {
+          handle = parent;
+          parent = _nodes[handle].parent;
+        }
+    }
+}
+
+void
+AddressTrie::releaseDevice(const string &deviceName)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  AddressHandle device = findChild(NO_ADDRESS, deviceName);
+  if (device == NO_ADDRESS) {
+      return;
+    }
+
+  // the children are forgotten before their parents
+  vector<AddressHandle> nodes(1, device);
+  for (unsigned int i = 0; i < nodes.size(); i++) {
+      _nodes[nodes[i]].released = true;
+      for (AddressHandle child = _nodes[nodes[i]].firstChild; child != NO_ADDRESS; child = _nodes[child].nextSibling) {
+          nodes.push_back(child);
+        }
+    }
+
+  for (vector<AddressHandle>::reverse_iterator it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      forget(*it);
+    }
+}
@@ -9,8 +9,18 @@
 #include "Engine.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include <thread>
+#include <chrono>
+#include <set>
+#include <algorithm>
+#include <libxml/xmlIO.h>
 #include <QDebug>
+#include <QHostInfo>
+#include <QUdpSocket>
+
+#include "OSCBundle.hpp"
 
 using namespace std;
 
@@ -30,11 +40,20 @@ EngineCacheElement::~EngineCacheElement()
     ;
 }
 
+bool EngineCachedValue::isFresh(unsigned int maxAge) const
+{
+    if (maxAge == NO_MAX_AGE)
+        return true;
+    
+    return std::chrono::steady_clock::now() - date < std::chrono::milliseconds(maxAge);
+}
+
 Engine::Engine(void(*timeEventStatusAttributeCallback)(ConditionedTimeBoxId, bool),
                void(*automationSchedulerRunningAttributeCallback)(TimeBoxId, bool),
                void(*transportDataValueCallback)(TTSymbol&, const TTValue&),
                void (*networkDeviceNamespaceCallback)(TTSymbol&),
                void (*networkDeviceConnectionError)(TTSymbol&, TTSymbol&),
+               void (*cachedValueReadCallback)(const std::string&, const std::string&),
                std::string pathToTheJamomaFolder)
 {
     m_TimeEventStatusAttributeCallback = timeEventStatusAttributeCallback;
@@ -42,11 +61,32 @@ Engine::Engine(void(*timeEventStatusAttributeCallback)(ConditionedTimeBoxId, boo
     m_TransportDataValueCallback = transportDataValueCallback;
     m_NetworkDeviceNamespaceCallback = networkDeviceNamespaceCallback;
     m_NetworkDeviceConnectionError = networkDeviceConnectionError;
+    m_CachedValueReadCallback = cachedValueReadCallback;
     
     m_nextTimeBoxId = 1;
     m_nextIntervalId = 1;
     m_nextConditionedTimeBoxId = 1;
     
+    m_addresses = AddressTrie::getInstance();
+    m_addressCacheSize = ADDRESS_CACHE_SIZE;
+    m_addressCacheHand = 0;
+    
+    m_valueReaderStop = false;
+    
+    m_editingDepth = 0;
+    m_editingSolverLoaded = false;
+    m_editingSolved = true;
+    m_editingRefused = false;
+    
+    m_playbackPlanBegin = 0;
+    m_playbackPlanEnd = 0;
+    m_planStop = false;
+    m_planRunning = false;
+    m_planDate = 0;
+    m_planLookahead = 0;
+    m_outputQueueCapacity = OUTPUT_QUEUE_CAPACITY;
+    m_outputTick = 0;
+    
     iscore = TTSymbol("i-score");
     
     if (!pathToTheJamomaFolder.empty()){
@@ -95,7 +135,12 @@ void Engine::initModular(const char* pathToTheJamomaFolder)
     // create a sender to send message to any application
     m_sender = TTObject("Sender");
     
+    // create another one for the playback plan thread
+    m_planSender = TTObject("Sender");
+    
     registerIscoreToProtocols();
+    
+    registerIscoreTransportData();
 }
 
 void Engine::registerIscoreToProtocols()
@@ -187,6 +232,45 @@ void Engine::registerIscoreToProtocols()
 	}
 }
 
+void Engine::registerIscoreTransportData()
+{
+    TTObject    aData;
+    TTValue     baton, args, out;
+    TTString    s;
+    
+    // the transport feature, its data type and its description
+    const char* transport[6][3] = {
+        {"Play",        "none",     "start or resume the main scenario"},
+        {"Stop",        "none",     "stop or pause the main scenario"},
+        {"Pause",       "none",     "pause the main scenario"},
+        {"Rewind",      "none",     "stop the main scenario and go back to its start"},
+        {"StartPoint",  "integer",  "the date (in ms) from where the main scenario will start on the next play"},
+        {"Speed",       "decimal",  "the execution speed factor of the main scenario"}};
+    
+    TTLogMessage("\n*** Expose transport features ***\n");
+    ////////////////////////////////////////////////////////////////////////
+    
+    for (TTUInt8 i = 0; i < 6; i++) {
+        
+        // create a message data (using TransportDataValueCallback)
+        aData = TTObject("Data", kTTSym_message);
+        
+        baton = TTValue(TTPtr(this), TTSymbol(transport[i][0]));
+        aData.set("baton", baton);
+        aData.set("function", TTPtr(&TransportDataValueCallback));
+        aData.set("type", TTSymbol(transport[i][1]));
+        aData.set("description", TTSymbol(transport[i][2]));
+        
+        // register it into i-score directory under /Transport
+        s = "/Transport/";
+        s += transport[i][0];
+        args = TTValue(TTAddress(s), aData);
+        m_iscore.send("ObjectRegister", args, out);
+        
+        m_transportDataList.push_back(aData);
+    }
+}
+
 void Engine::initScore(const char* pathToTheJamomaFolder)
 {   
     TTValue     args, out;
@@ -233,8 +317,32 @@ void Engine::dumpAddressBelow(TTNodePtr aNode)
     }
 }
 
+TTNodeDirectoryPtr Engine::accessNamespaceDirectory(TTAddress& anAddress)
+{
+    if (m_namespacesRebuilding.count(anAddress.getDirectory().c_str()))
+        return NULL;
+    
+    return accessApplicationDirectoryFrom(anAddress);
+}
+
+void Engine::setNamespaceRebuilding(const std::string & deviceName, bool rebuilding)
+{
+    std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+    
+    if (rebuilding)
+        m_namespacesRebuilding.insert(deviceName);
+    else {
+        std::multiset<std::string>::iterator it = m_namespacesRebuilding.find(deviceName);
+        if (it != m_namespacesRebuilding.end())
+            m_namespacesRebuilding.erase(it);
+    }
+}
+
 Engine::~Engine()
 {
+    clearPlaybackPlan();
+    stopOutputs();
+    
     // Clear all the EngineCacheMaps
     // note : this should be useless because all elements are removed by the maquette
     clearTimeCondition();
@@ -242,6 +350,14 @@ Engine::~Engine()
     clearInterval();
     clearTimeBox();
     
+    stopValueReader();
+    clearValueCache();
+    
+    // release the addresses which keys the other caches
+    setAddressCacheSize(0);
+    for (auto &curve : m_nominalSampleRates)
+        m_addresses->release(curve.first.second);
+    
     TTValue out;
     
     TTLogMessage("\n*** Release protocols ***\n");
@@ -282,9 +398,14 @@ TimeBoxId Engine::cacheTimeBox(TTObject& automation, TTAddress& anAddress, TTObj
     m_timeBoxMap[id] = e;
     m_nextTimeBoxId++;
     
+    cacheTimeEvents(id);
+    
     cacheStartCallback(id);
     cacheEndCallback(id);
     
+    if (m_editingSolverLoaded && id != ROOT_BOX_ID)
+        m_editingSolver.setBox(id, getBoxBeginTime(id), getBoxEndTime(id));
+    
     return id;
 }
 
@@ -308,7 +429,12 @@ TTObject& Engine::getSubScenario(TimeBoxId boxId)
 
 void Engine::setLoop(TimeBoxId boxId, TTObject& loop)
 {
+    // the main process changes so its events can change too (e.g. for the main scenario)
+    uncacheTimeEvents(boxId);
     m_timeBoxMap[boxId]->loop = loop;
+    cacheTimeEvents(boxId);
+    
+    m_editingSolverLoaded = false;
 }
 
 TTObject& Engine::getLoop(TimeBoxId boxId)
@@ -379,12 +505,15 @@ void Engine::uncacheTimeBox(TimeBoxId boxId)
     
     uncacheStartCallback(boxId);
     uncacheEndCallback(boxId);
+    uncacheTimeEvents(boxId);
     
     TTValue out;
     m_iscore.send("ObjectUnregister", e->address, out);
     
     delete e;
     m_timeBoxMap.erase(boxId);
+    
+    m_editingSolver.removeBox(boxId);
 }
 
 void Engine::clearTimeBox()
@@ -423,11 +552,55 @@ void Engine::clearTimeBox()
     // don't clear the m_timeBoxMap (because it is not empty)
     m_startCallbackMap.clear();
     m_endCallbackMap.clear();
+    m_timeEventMap.clear();
     
     // set the next id to 2 because the main scenario is registered with the 1 id
     m_nextTimeBoxId = 2;
 }
 
+void Engine::cacheTimeEvents(TimeBoxId boxId)
+{
+    TTObject startEvent, endEvent;
+    
+    getMainProcess(boxId).get("startEvent", startEvent);
+    getMainProcess(boxId).get("endEvent", endEvent);
+    
+    if (startEvent.valid())
+        m_timeEventMap[startEvent.instance()] = std::make_pair(boxId, BEGIN_CONTROL_POINT_INDEX);
+    
+    if (endEvent.valid())
+        m_timeEventMap[endEvent.instance()] = std::make_pair(boxId, END_CONTROL_POINT_INDEX);
+}
+
+void Engine::uncacheTimeEvents(TimeBoxId boxId)
+{
+    TTObject startEvent, endEvent;
+    
+    getMainProcess(boxId).get("startEvent", startEvent);
+    getMainProcess(boxId).get("endEvent", endEvent);
+    
+    EngineTimeEventsMap::iterator it = m_timeEventMap.find(startEvent.instance());
+    if (it != m_timeEventMap.end() && it->second.first == boxId)
+        m_timeEventMap.erase(it);
+    
+    it = m_timeEventMap.find(endEvent.instance());
+    if (it != m_timeEventMap.end() && it->second.first == boxId)
+        m_timeEventMap.erase(it);
+}
+
+TimeBoxId Engine::getTimeEventBoxId(TTObject& timeEvent, TimeEventIndex& controlPointId)
+{
+    EngineTimeEventsMap::iterator it = m_timeEventMap.find(timeEvent.instance());
+    
+    if (it == m_timeEventMap.end()) {
+        controlPointId = NO_ID;
+        return NO_ID;
+    }
+    
+    controlPointId = it->second.second;
+    return it->second.first;
+}
+
 IntervalId Engine::cacheInterval(TTObject& interval)
 {
     TimeBoxId id;
@@ -440,6 +613,14 @@ IntervalId Engine::cacheInterval(TTObject& interval)
     m_intervalMap[id] = e;
     m_nextIntervalId++;
     
+    TTObject startEvent, endEvent;
+    interval.get("startEvent", startEvent);
+    interval.get("endEvent", endEvent);
+    m_intervalEventsMap[EngineTimeEventsPair(startEvent.instance(), endEvent.instance())] = id;
+    
+    // the engine may have shifted boxes to keep the new relation
+    m_editingSolverLoaded = false;
+    
     return id;
 }
 
@@ -452,8 +633,18 @@ void Engine::uncacheInterval(IntervalId relationId)
 {
     EngineCacheElementPtr e = m_intervalMap[relationId];
     
+    TTObject startEvent, endEvent;
+    e->object.get("startEvent", startEvent);
+    e->object.get("endEvent", endEvent);
+    
+    EngineIntervalsMap::iterator it = m_intervalEventsMap.find(EngineTimeEventsPair(startEvent.instance(), endEvent.instance()));
+    if (it != m_intervalEventsMap.end() && it->second == relationId)
+        m_intervalEventsMap.erase(it);
+    
     delete e;
     m_intervalMap.erase(relationId);
+    
+    m_editingSolver.removeRelation(relationId);
 }
 
 void Engine::clearInterval()
@@ -474,6 +665,7 @@ void Engine::clearInterval()
     }
     
     m_intervalMap.clear();
+    m_intervalEventsMap.clear();
     
     m_nextIntervalId = 1;
 }
@@ -1026,8 +1218,20 @@ void Engine::changeTemporalRelationBounds(IntervalId relationId, BoundValue minB
     
     // NOTE : sending 0 0 means the relation is not rigid
     // NOTE : it is also possible to use the "rigid" attribute to swicth between those two states
+    // during a transaction the bounds are changed on commit, if the edited boxes can keep them
+    if (m_editingDepth) {
+        
+        std::vector<TimeBoxId> solverMovedBoxes;
+        
+        if (!solveRelationBounds(relationId, durationMin, durationMax, solverMovedBoxes))
+            m_editingRefused = true;
+        
+        return;
+    }
+    
     args = TTValue(durationMin, durationMax);
     interval.send("Limit", args, out);
+    m_editingSolverLoaded = false;
     
     // return the entire time box map except the first box !!! (this is bad but it is like former engine)
     it = m_timeBoxMap.begin();
@@ -1038,172 +1242,71 @@ void Engine::changeTemporalRelationBounds(IntervalId relationId, BoundValue minB
 
 bool Engine::isTemporalRelationExisting(TimeBoxId boxId1, TimeEventIndex controlPoint1, TimeBoxId boxId2, TimeEventIndex controlPoint2)
 {
-    TTValue     v1, v2, v;
-    IntervalId  found = NO_ID;
-    EngineCacheMapIterator  it;
+    TTObject    event1, event2;
     
-    // Get the events from the given box ids and pass them to the time process
+    // Get the events from the given box ids
     if (controlPoint1 == BEGIN_CONTROL_POINT_INDEX)
-        getMainProcess(boxId1).get("startEvent", v1);
+        getMainProcess(boxId1).get("startEvent", event1);
     else
-        getMainProcess(boxId1).get("endEvent", v1);
+        getMainProcess(boxId1).get("endEvent", event1);
     
     if (controlPoint2 == BEGIN_CONTROL_POINT_INDEX)
-        getMainProcess(boxId2).get("startEvent", v2);
+        getMainProcess(boxId2).get("startEvent", event2);
     else
-        getMainProcess(boxId2).get("endEvent", v2);
-    
-    // Look into the interval map to retreive an interval with the same events
-    for (it = m_intervalMap.begin(); it != m_intervalMap.end(); ++it) {
-        
-        it->second->object.get("startEvent", v);
-        
-        if (v == v1) {
-            
-            it->second->object.get("endEvent", v);
-            
-            if (v == v2) {
-                found = it->first;
-                break;
-            }
-        }
-    }
+        getMainProcess(boxId2).get("endEvent", event2);
     
-	return found != NO_ID;
+    // Look into the interval index to retreive an interval with the same events
+	return m_intervalEventsMap.find(EngineTimeEventsPair(event1.instance(), event2.instance())) != m_intervalEventsMap.end();
 }
 
 TimeBoxId Engine::getRelationFirstBoxId(IntervalId relationId)
 {
-    TTValue         out, v;
-    TimeBoxId   found = NO_ID;
-    EngineCacheMapIterator  it;
+    TTObject        timeEvent;
+    TimeEventIndex  ctrlPointId;
     
     // get the start event of the interval
-	getInterval(relationId).get("startEvent", out);
-    
-    // Look into the time box map to retreive an automation with the same event
-    for (it = m_timeBoxMap.begin(); it != m_timeBoxMap.end(); ++it)
-    {
-        TTObject mainProcess = it->second->object;
-        if (it->second->loop.valid())
-            mainProcess = it->second->loop;
-        
-        mainProcess.get("startEvent", v);
-        
-        if (out == v) {
-            found = it->first;
-            break;
-        }
-        
-        mainProcess.get("endEvent", v);
-        
-        if (out == v) {
-            found = it->first;
-            break;
-        }
-    }
+	getInterval(relationId).get("startEvent", timeEvent);
     
-    return found;
+    // retreive the time box owning this event
+    return getTimeEventBoxId(timeEvent, ctrlPointId);
 }
 
 TimeEventIndex Engine::getRelationFirstCtrlPointIndex(IntervalId relationId)
 {
-    TTValue         out, v;
-    TimeEventIndex  ctrlPointId = NO_ID;
-    EngineCacheMapIterator  it;
+    TTObject        timeEvent;
+    TimeEventIndex  ctrlPointId;
     
     // get the start event of the interval
-	getInterval(relationId).get("startEvent", out);
-
-    // Look into the time box map to retreive an automation with the same event
-    for (it = m_timeBoxMap.begin(); it != m_timeBoxMap.end(); ++it)
-    {
-        TTObject mainProcess = it->second->object;
-        if (it->second->loop.valid())
-            mainProcess = it->second->loop;
-        
-        mainProcess.get("startEvent", v);
-        
-        if (out == v) {
-            ctrlPointId = BEGIN_CONTROL_POINT_INDEX;
-            break;
-        }
-        
-        mainProcess.get("endEvent", v);
-        
-        if (out == v) {
-            ctrlPointId = END_CONTROL_POINT_INDEX;
-            break;
-        }
-    }
+	getInterval(relationId).get("startEvent", timeEvent);
+    
+    // retreive the control point of the time box owning this event
+    getTimeEventBoxId(timeEvent, ctrlPointId);
     
     return ctrlPointId;
 }
 
 TimeBoxId Engine::getRelationSecondBoxId(IntervalId relationId)
 {
-    TTValue         out, v;
-    TimeBoxId   found = NO_ID;
-    EngineCacheMapIterator  it;
-    
-    // Get the end event of the interval
-	getInterval(relationId).get("endEvent", out);
+    TTObject        timeEvent;
+    TimeEventIndex  ctrlPointId;
     
-    // Look into the time box map to retreive an automation with the same event
-    for (it = m_timeBoxMap.begin(); it != m_timeBoxMap.end(); ++it)
-    {
-        TTObject mainProcess = it->second->object;
-        if (it->second->loop.valid())
-            mainProcess = it->second->loop;
-        
-        mainProcess.get("startEvent", v);
-        
-        if (out == v) {
-            found = it->first;
-            break;
-        }
-        
-        mainProcess.get("endEvent", v);
-        
-        if (out == v) {
-            found = it->first;
-            break;
-        }
-    }
+    // get the end event of the interval
+	getInterval(relationId).get("endEvent", timeEvent);
     
-    return found;
+    // retreive the time box owning this event
+    return getTimeEventBoxId(timeEvent, ctrlPointId);
 }
 
 TimeEventIndex Engine::getRelationSecondCtrlPointIndex(IntervalId relationId)
 {
-    TTValue         out, v;
-    TimeEventIndex  ctrlPointId = NO_ID;
-    EngineCacheMapIterator  it;
+    TTObject        timeEvent;
+    TimeEventIndex  ctrlPointId;
     
-    // get the start event of the interval
-	getInterval(relationId).get("endEvent", out);
+    // get the end event of the interval
+	getInterval(relationId).get("endEvent", timeEvent);
     
-    // Look into the time box map to retreive an automation with the same event
-    for (it = m_timeBoxMap.begin(); it != m_timeBoxMap.end(); ++it)
-    {
-        TTObject mainProcess = it->second->object;
-        if (it->second->loop.valid())
-            mainProcess = it->second->loop;
-        
-        mainProcess.get("startEvent", v);
-        
-        if (out == v) {
-            ctrlPointId = BEGIN_CONTROL_POINT_INDEX;
-            break;
-        }
-        
-        mainProcess.get("endEvent", v);
-        
-        if (out == v) {
-            ctrlPointId = END_CONTROL_POINT_INDEX;
-            break;
-        }
-    }
+    // retreive the control point of the time box owning this event
+    getTimeEventBoxId(timeEvent, ctrlPointId);
     
     return ctrlPointId;
 }
@@ -1232,8 +1335,20 @@ bool Engine::performBoxEditing(TimeBoxId boxId, TimeValue start, TimeValue end,
     TTErr   err;
     EngineCacheMapIterator  it;
     
+    // during a transaction the box is moved on commit, if the relations with the other edited boxes can be kept
+    if (m_editingDepth) {
+        
+        if (m_timeBoxMap.find(boxId) == m_timeBoxMap.end() || end < start)
+            return false;
+        
+        m_editedBoxes[boxId] = std::make_pair(start, end);
+        m_editingSolved = false;
+        return true;
+    }
+    
     args = TTValue(start, end);
     err = getMainProcess(boxId).send("Move", args, out);
+    m_editingSolverLoaded = false;
 
     // return the entire time box map except the first box !!! (this is bad but it is like former engine)
     it = m_timeBoxMap.begin();
@@ -1244,73 +1359,310 @@ bool Engine::performBoxEditing(TimeBoxId boxId, TimeValue start, TimeValue end,
     return !err;
 }
 
-std::string Engine::getBoxName(TimeBoxId boxId)
+void Engine::beginEditing()
 {
-    TTSymbol    name;
+    // a nested transaction is part of the outer one
+    if (m_editingDepth++ > 0)
+        return;
     
-	getAutomation(boxId).get("name", name);
+    m_editedBoxes.clear();
+    m_editedRelations.clear();
+    m_editingMovedBoxes.clear();
+    m_editingSolved = true;
+    m_editingRefused = false;
     
-    // format name replacing '_' by '.'
-    TTString s_toParse = name.c_str();
-    std::replace(s_toParse.begin(), s_toParse.end(), '_', ' ');
+    loadEditingSolver();
+}
+
+bool Engine::commitEditing(vector<TimeBoxId>& movedBoxes)
+{
+    EngineBoxesDatesMap         datesBefore, dates;
+    EngineRelationsBoundsMap    boundsBefore;
+    std::set<TimeBoxId>         editedBoxes;
+    TimeValue                   begin, end;
+    bool                        accepted;
     
-    return s_toParse.c_str();
+    if (m_editingDepth == 0)
+        return true;
+    
+    // a nested commit leaves the editions to the outer one
+    if (--m_editingDepth > 0)
+        return true;
+    
+    loadEditingSolver();
+    
+    // the moved boxes are solved together, once
+    if (!m_editingSolved && !m_editingRefused) {
+        
+        std::map<unsigned int, std::pair<int, int> > solverDates(m_editedBoxes.begin(), m_editedBoxes.end());
+        std::vector<unsigned int> solverMovedBoxes;
+        
+        if (m_editingSolver.moveBoxes(solverDates, solverMovedBoxes))
+            m_editingMovedBoxes.insert(solverMovedBoxes.begin(), solverMovedBoxes.end());
+        else
+            m_editingRefused = true;
+    }
+    
+    // only the edited boxes and the ones shifted by the solver can have moved
+    for (auto& box : m_editedBoxes)
+        editedBoxes.insert(box.first);
+    editedBoxes.insert(m_editingMovedBoxes.begin(), m_editingMovedBoxes.end());
+    
+    for (TimeBoxId boxId : editedBoxes) {
+        
+        // the box may have been removed during the transaction
+        if (m_timeBoxMap.find(boxId) == m_timeBoxMap.end())
+            continue;
+        
+        datesBefore[boxId] = std::make_pair(getBoxBeginTime(boxId), getBoxEndTime(boxId));
+        
+        if (m_editingSolver.boxDates(boxId, begin, end) &&
+            (begin != datesBefore[boxId].first || end != datesBefore[boxId].second))
+            dates[boxId] = std::make_pair(begin, end);
+    }
+    
+    for (auto& bounds : m_editedRelations) {
+        
+        // the relation may have been removed during the transaction
+        if (m_intervalMap.find(bounds.first) != m_intervalMap.end())
+            boundsBefore[bounds.first] = std::make_pair(getRelationMinBound(bounds.first), getRelationMaxBound(bounds.first));
+    }
+    
+    // the whole transaction is applied or nothing
+    accepted = !m_editingRefused && applyEditing(m_editedRelations, dates);
+    
+    if (!accepted) {
+        
+        if (!m_editingRefused)
+            applyEditing(boundsBefore, datesBefore);
+        
+        // the solver goes back to the engine
+        for (auto& before : datesBefore)
+            m_editingSolver.setBox(before.first, before.second.first, before.second.second);
+        
+        for (auto& before : boundsBefore)
+            m_editingSolver.setRelationBounds(before.first, before.second.first, before.second.second);
+    }
+    
+    // when refused, the boxes shown where the transaction put them go back too
+    for (auto& before : datesBefore) {
+        
+        if (!accepted || m_editedBoxes.count(before.first) ||
+            getBoxBeginTime(before.first) != before.second.first ||
+            getBoxEndTime(before.first) != before.second.second)
+            movedBoxes.push_back(before.first);
+    }
+    
+    m_editedBoxes.clear();
+    m_editedRelations.clear();
+    m_editingMovedBoxes.clear();
+    m_editingSolved = true;
+    m_editingRefused = false;
+    
+    return accepted;
 }
 
-unsigned int Engine::getBoxVerticalPosition(TimeBoxId boxId)
+void Engine::loadEditingSolver()
 {
-    TTValue v;
+    EngineCacheMapIterator  it;
     
-	getAutomation(boxId).get("verticalPosition", v);
+    if (m_editingSolverLoaded)
+        return;
     
-    return v[0];
+    m_editingSolver.clear();
+    
+    it = m_timeBoxMap.begin();
+    it++;
+    for (; it != m_timeBoxMap.end(); ++it)
+        m_editingSolver.setBox(it->first, getBoxBeginTime(it->first), getBoxEndTime(it->first));
+    
+    for (it = m_intervalMap.begin(); it != m_intervalMap.end(); ++it)
+        m_editingSolver.setRelation(it->first,
+                                    getRelationFirstBoxId(it->first), getRelationFirstCtrlPointIndex(it->first),
+                                    getRelationSecondBoxId(it->first), getRelationSecondCtrlPointIndex(it->first),
+                                    getRelationMinBound(it->first), getRelationMaxBound(it->first));
+    
+    m_editingSolverLoaded = true;
+    
+    // the editions of the transaction are solved again on the new mirror
+    for (auto& bounds : m_editedRelations)
+        m_editingSolver.setRelationBounds(bounds.first, bounds.second.first, bounds.second.second);
+    
+    if (!m_editedBoxes.empty() || !m_editedRelations.empty())
+        m_editingSolved = false;
 }
 
-void Engine::setBoxVerticalPosition(TimeBoxId boxId, unsigned int newPosition)
+bool Engine::solveRelationBounds(IntervalId relationId, BoundValue minBound, BoundValue maxBound, std::vector<TimeBoxId>& movedBoxes)
 {
-	getAutomation(boxId).set("verticalPosition", TTUInt32(newPosition));
+    loadEditingSolver();
+    
+    // the moved boxes are solved with the change
+    std::map<unsigned int, std::pair<int, int> > dates(m_editedBoxes.begin(), m_editedBoxes.end());
+    
+    if (!m_editingSolver.changeRelationBounds(relationId, minBound, maxBound, dates, movedBoxes))
+        return false;
+    
+    m_editedRelations[relationId] = std::make_pair(minBound, maxBound);
+    m_editingMovedBoxes.insert(movedBoxes.begin(), movedBoxes.end());
+    m_editingSolved = true;
+    
+    return true;
 }
 
-unsigned int Engine::getBoxVerticalSize(TimeBoxId boxId)
+bool Engine::applyEditing(const EngineRelationsBoundsMap& bounds, const EngineBoxesDatesMap& dates)
 {
-    TTValue v;
+    TTValue args, out;
     
-	getAutomation(boxId).get("verticalSize", v);
+    for (auto& relation : bounds) {
+        
+        if (m_intervalMap.find(relation.first) == m_intervalMap.end())
+            continue;
+        
+        args = TTValue(TTUInt32(relation.second.first), TTUInt32(relation.second.second));
+        getInterval(relation.first).send("Limit", args, out);
+    }
     
-    return v[0];
+    for (unsigned int pass = 0; ; pass++) {
+        
+        std::vector<TimeBoxId> misplacedBoxes;
+        
+        for (auto& box : dates) {
+            
+            if (m_timeBoxMap.find(box.first) == m_timeBoxMap.end())
+                continue;
+            
+            if (getBoxBeginTime(box.first) != box.second.first || getBoxEndTime(box.first) != box.second.second)
+                misplacedBoxes.push_back(box.first);
+        }
+        
+        if (misplacedBoxes.empty())
+            return true;
+        
+        if (pass == EDITING_PASSES)
+            return false;
+        
+        for (TimeBoxId boxId : misplacedBoxes) {
+            
+            args = TTValue(dates.at(boxId).first, dates.at(boxId).second);
+            getMainProcess(boxId).send("Move", args, out);
+        }
+    }
 }
 
-void Engine::setBoxVerticalSize(TimeBoxId boxId, unsigned int newSize)
+bool Engine::isEditing()
 {
-    getAutomation(boxId).set("verticalSize", TTUInt32(newSize));
+    return m_editingDepth > 0;
 }
 
-QColor Engine::getBoxColor(TimeBoxId boxId)
+bool Engine::previewBoxEditing(TimeBoxId boxId, TimeValue start, TimeValue end, vector<TimeBoxId>& movedBoxes)
 {
-    TTValue v;
-    QColor  color;
+    if (m_editingDepth == 0)
+        return performBoxEditing(boxId, start, end, movedBoxes);
     
-	getAutomation(boxId).get("color", v);
+    if (m_timeBoxMap.find(boxId) == m_timeBoxMap.end() || end < start)
+        return false;
     
-    color = QColor(v[0], v[1], v[2]);
+    loadEditingSolver();
     
-    return color;
+    // the box is solved with the other edited boxes, which stay pinned
+    std::map<unsigned int, std::pair<int, int> > dates(m_editedBoxes.begin(), m_editedBoxes.end());
+    dates[boxId] = std::make_pair(int(start), int(end));
+    
+    if (!m_editingSolver.moveBoxes(dates, movedBoxes))
+        return false;
+    
+    m_editedBoxes[boxId] = std::make_pair(start, end);
+    m_editingMovedBoxes.insert(movedBoxes.begin(), movedBoxes.end());
+    m_editingSolved = true;
+    
+    return true;
 }
 
-void Engine::setBoxColor(TimeBoxId boxId, QColor newColor)
+bool Engine::previewTemporalRelationBounds(IntervalId relationId, BoundValue minBound, BoundValue maxBound, vector<TimeBoxId>& movedBoxes)
 {
-    TTValue v;
-    
-    v = newColor.red();
-    v.append(newColor.green());
-    v.append(newColor.blue());
+    if (m_editingDepth == 0 || m_intervalMap.find(relationId) == m_intervalMap.end())
+        return false;
     
-	getAutomation(boxId).set("color", v);
+    // filtered as changeTemporalRelationBounds does
+    return solveRelationBounds(relationId, minBound == NO_BOUND ? 0 : abs(minBound), maxBound == NO_BOUND ? 0 : abs(maxBound), movedBoxes);
 }
 
-void Engine::setBoxMuteState(TimeBoxId boxId, bool muteState)
+void Engine::getEditedBoxDates(TimeBoxId boxId, TimeValue& begin, TimeValue& end)
 {
-    getAutomation(boxId).set("mute", muteState);
+    if (m_editingDepth && m_editingSolverLoaded && m_editingSolver.boxDates(boxId, begin, end))
+        return;
+    
+    begin = getBoxBeginTime(boxId);
+    end = getBoxEndTime(boxId);
+}
+
+std::string Engine::getBoxName(TimeBoxId boxId)
+{
+    TTSymbol    name;
+    
+	getAutomation(boxId).get("name", name);
+    
+    // format name replacing '_' by '.'
+    TTString s_toParse = name.c_str();
+    std::replace(s_toParse.begin(), s_toParse.end(), '_', ' ');
+    
+    return s_toParse.c_str();
+}
+
+unsigned int Engine::getBoxVerticalPosition(TimeBoxId boxId)
+{
+    TTValue v;
+    
+	getAutomation(boxId).get("verticalPosition", v);
+    
+    return v[0];
+}
+
+void Engine::setBoxVerticalPosition(TimeBoxId boxId, unsigned int newPosition)
+{
+	getAutomation(boxId).set("verticalPosition", TTUInt32(newPosition));
+}
+
+unsigned int Engine::getBoxVerticalSize(TimeBoxId boxId)
+{
+    TTValue v;
+    
+	getAutomation(boxId).get("verticalSize", v);
+    
+    return v[0];
+}
+
+void Engine::setBoxVerticalSize(TimeBoxId boxId, unsigned int newSize)
+{
+    getAutomation(boxId).set("verticalSize", TTUInt32(newSize));
+}
+
+QColor Engine::getBoxColor(TimeBoxId boxId)
+{
+    TTValue v;
+    QColor  color;
+    
+	getAutomation(boxId).get("color", v);
+    
+    color = QColor(v[0], v[1], v[2]);
+    
+    return color;
+}
+
+void Engine::setBoxColor(TimeBoxId boxId, QColor newColor)
+{
+    TTValue v;
+    
+    v = newColor.red();
+    v.append(newColor.green());
+    v.append(newColor.blue());
+    
+	getAutomation(boxId).set("color", v);
+}
+
+void Engine::setBoxMuteState(TimeBoxId boxId, bool muteState)
+{
+    getAutomation(boxId).set("mute", muteState);
     getSubScenario(boxId).set("mute", muteState);
     if (isLoop(boxId))
         getLoop(boxId).set("mute", muteState);
@@ -1554,6 +1906,13 @@ void Engine::setCurveSampleRate(TimeBoxId boxId, const std::string & address, un
     TTUInt32    i;
     TTErr       err;
     
+    // the rate set replaces the one lowered for the budget of the device
+    auto nominal = m_nominalSampleRates.find(std::make_pair(boxId, m_addresses->find(address)));
+    if (nominal != m_nominalSampleRates.end()) {
+        m_addresses->release(nominal->first.second);
+        m_nominalSampleRates.erase(nominal);
+    }
+    
     // get curve object at address
     err = getAutomation(boxId).send("CurveGet", toTTAddress(address), objects);
     
@@ -1575,6 +1934,11 @@ unsigned int Engine::getCurveSampleRate(TimeBoxId boxId, const std::string & add
     TTValue     out, objects;
     TTErr       err;
     
+    // the rate may be lowered for the budget of the device during the execution
+    auto nominal = m_nominalSampleRates.find(std::make_pair(boxId, m_addresses->find(address)));
+    if (nominal != m_nominalSampleRates.end())
+        return nominal->second;
+    
     // get curve object at address
     err = getAutomation(boxId).send("CurveGet", toTTAddress(address), objects);
     
@@ -1759,7 +2123,7 @@ bool Engine::getCurveSections(TimeBoxId boxId, std::string address, unsigned int
     return err == kTTErrNone;
 }
 
-bool Engine::getCurveValues(TimeBoxId boxId, const std::string & address, unsigned int /*argNb*/, std::vector<float>& result)
+bool Engine::getCurveValues(TimeBoxId boxId, const std::string & address, unsigned int argNb, std::vector<float>& result)
 {
     TTObject    curve;
     TTValue     out, duration, curveValues;
@@ -1767,11 +2131,14 @@ bool Engine::getCurveValues(TimeBoxId boxId, const std::string & address, unsign
     
     // get curve object at address
     err = getAutomation(boxId).send("CurveGet", toTTAddress(address), out);
+    
+    // there is one indexed curve by argument
+    if (!err && argNb >= out.size())
+        err = kTTErrInvalidValue;
 
     if (!err) {
         
-        // get first indexed curve only
-        curve = out[0];
+        curve = out[argNb];
         
         // get time process duration
         getAutomation(boxId).get("duration", duration);
@@ -2393,6 +2760,10 @@ bool Engine::play(TimeBoxId boxId)
     TTLogMessage("***************************************\n");
     TTLogMessage("Engine::play\n");
     
+    // keep the curves within the budget of their device
+    if (boxId == ROOT_BOX_ID)
+        adaptCurveSampleRates();
+    
     TTBoolean success = !getMainProcess(boxId).send("Start");
   
     return success;
@@ -2417,6 +2788,9 @@ bool Engine::stop(TimeBoxId boxId)
 {
     // stop a time process its end event (this will also stop other time processes attached to the end event)
     TTBoolean success = !getMainProcess(boxId).send("End");
+    
+    if (boxId == ROOT_BOX_ID)
+        restoreCurveSampleRates();
   
     TTLogMessage("Engine::stopped\n");
     TTLogMessage("***************************************\n");
@@ -2565,254 +2939,1654 @@ void Engine::trigger(vector<ConditionedTimeBoxId> triggerIds)
         lastTimeCondition.send("Trigger", events, out);
 }
 
-void Engine::addNetworkDevice(const std::string & deviceName, const std::string & pluginToUse, const std::string & DeviceIp, const unsigned int & destinationPort, const unsigned int & receptionPort, const bool isInputPort, const std::string & stringPort)
+unsigned int Engine::compilePlaybackPlan(TimeValue begin, TimeValue & end)
 {
-    TTValue     args, none, out;
-    TTSymbol    applicationName(deviceName);
-    TTObject    anApplication;
-    TTObject    aProtocol;
-    TTErr       err;
+    vector<ConditionedTimeBoxId>    triggersId;
+    map<TimeBoxId, TimeValue>       boxesBegin, boxesEnd;
+    map<string, float>              sampleRateFactors = getCurveSampleRateFactors();
+    
+    clearPlaybackPlan();
+    
+    if (end == 0)
+        end = getBoxEndTime(ROOT_BOX_ID);
+    
+    getBoxesAbsoluteDates(boxesBegin, boxesEnd);
+    
+    // a loop repeats what it contains : the portion stops there
+    for (auto &box : boxesBegin)
+        if (isLoop(box.first) && boxesEnd[box.first] > begin)
+            end = std::min(end, std::max(begin, box.second));
     
-    // if the application doesn't already exist
-    if (!accessApplication(applicationName)) {
+    // a trigger point waits for the performer : the portion stops there
+    getTriggersPointId(triggersId);
+    for (ConditionedTimeBoxId triggerId : triggersId) {
         
-        // create the application
-        m_applicationManager.send("ApplicationInstantiateDistant", applicationName, out);
-        anApplication = out[0];
+        TimeBoxId boxId = getTriggerPointRelatedBoxId(triggerId);
+        if (boxesBegin.find(boxId) == boxesBegin.end())
+            continue;
         
-        // check if the protocol has been loaded
-        aProtocol = accessProtocol(TTSymbol(pluginToUse));
-		if (aProtocol.valid()) {
+        TimeValue date = getTriggerPointRelatedCtrlPointIndex(triggerId) == BEGIN_CONTROL_POINT_INDEX ? boxesBegin[boxId] : boxesEnd[boxId];
+        if (date >= begin)
+            end = std::min(end, date);
+    }
+    
+    if (end <= begin)
+        return 0;
+    
+    m_playbackPlanBegin = begin;
+    m_playbackPlanEnd = end;
+    
+    for (auto &box : boxesBegin) {
+        
+        TimeBoxId   boxId = box.first;
+        TimeValue   boxBegin = box.second;
+        TimeValue   boxEnd = boxesEnd[boxId];
+        
+        if (boxEnd < begin || boxBegin >= end || isBoxMutedInScore(boxId))
+            continue;
+        
+        // the messages of the start control point, already sorted by priority
+        if (boxBegin >= begin && !getCtrlPointMutingState(boxId, BEGIN_CONTROL_POINT_INDEX))
+            planCtrlPointMessages(boxId, BEGIN_CONTROL_POINT_INDEX, boxBegin);
+        
+        // the samples of the curves, between the control points
+        for (auto &address : getCurvesAddress(boxId)) {
             
-            // stop the protocol
-            aProtocol.send("Stop");
+            unsigned int    sampleRate = getCurveSampleRate(boxId, address);
+            vector<vector<float> > curvesValues;
             
-            // register the application to the protocol
-            aProtocol.send("ApplicationRegister", applicationName, out);
+            // within the budget of the device
+            auto factor = sampleRateFactors.find(address.substr(0, address.find('/')));
+            if (factor != sampleRateFactors.end() && sampleRate > 0)
+                sampleRate = std::max<unsigned int>(sampleRate * factor->second, 1);
             
-            // select appliction before to set its parameter
-            aProtocol.send("ApplicationSelect", applicationName, out);
+            if (sampleRate == 0 || getCurveMuteState(boxId, address))
+                continue;
             
-            // prepare parameters depending of the protocol
-            if (pluginToUse == "Minuit" || pluginToUse == "OSC") {
+            // one indexed curve by argument of the message
+            for (unsigned int argNb = 0; ; argNb++) {
                 
-                args = TTValue(TTUInt16(destinationPort), TTUInt16(receptionPort));
-                aProtocol.set("port", args);
-                aProtocol.set("ip", TTSymbol(DeviceIp));
-            }
-            else if (pluginToUse == "MIDI") {
+                vector<float> values;
+                if (!getCurveValues(boxId, address, argNb, values) || values.size() < 2)
+                    break;
                 
-                if (isInputPort)
-                    aProtocol.set("input", TTSymbol(stringPort));
-                else
-                    aProtocol.set("output", TTSymbol(stringPort));
+                curvesValues.push_back(values);
             }
             
-            // run the protocol
-            err = aProtocol.send("Run", none, out);
+            if (curvesValues.empty())
+                continue;
             
-            if (err) {
-                out.toString();
-                TTSymbol errorInfo = TTSymbol(TTString(out[0]));
-                m_NetworkDeviceConnectionError(iscore, errorInfo);
+            bool            redundancy = getCurveRedundancy(boxId, address);
+            AddressHandle   handle = retainPlanAddress(address);
+            TTAddress       anAddress = toTTAddress(handle, address);
+            double          duration = boxEnd - boxBegin;
+            double          period = 1000. / sampleRate;
+            vector<float>   lastValues;
+            
+            for (auto &values : curvesValues)
+                lastValues.push_back(values[0]);
+            
+            // the curves are sampled over the whole box : interpolate them at the sample rate
+            // (each date is computed from the sample index, an accumulated period would drift on long boxes)
+            for (unsigned long sample = 1; sample * period < duration; sample++) {
+                
+                double      date = sample * period;
+                TTValue     value;
+                bool        changed = false;
+                
+                value.resize(curvesValues.size());
+                
+                for (unsigned int argNb = 0; argNb < curvesValues.size(); argNb++) {
+                    
+                    vector<float> & values = curvesValues[argNb];
+                    float       position = date / duration * (values.size() - 1);
+                    TTUInt32    index = position;
+                    TTUInt32    next = std::min<TTUInt32>(index + 1, values.size() - 1);
+                    float       argValue = values[index] + (position - index) * (values[next] - values[index]);
+                    
+                    changed |= argValue != lastValues[argNb];
+                    lastValues[argNb] = argValue;
+                    value[argNb] = TTFloat64(argValue);
+                }
+                
+                if (!redundancy && !changed)
+                    continue;
+                
+                if (boxBegin + date < begin || boxBegin + date >= end)
+                    continue;
+                
+                EnginePlannedMessage planned;
+                planned.date = boxBegin + date;
+                planned.address = anAddress;
+                planned.networktreeAddress = handle;
+                planned.value = value;
+                planned.sample = true;
+                m_playbackPlan.push_back(planned);
             }
         }
         
-        // set the priority, service, tags and rangeBounds attributes as a cached attributes
-        args = kTTSym_priority;
-        args.append(kTTSym_service);
-        args.append(kTTSym_tags);
-        args.append(kTTSym_rangeBounds);
-        args.append(kTTSym_rangeClipmode);
-        anApplication.set("cachedAttributes", args);
+        // the messages of the end control point
+        if (boxEnd >= begin && boxEnd < end && !getCtrlPointMutingState(boxId, END_CONTROL_POINT_INDEX))
+            planCtrlPointMessages(boxId, END_CONTROL_POINT_INDEX, boxEnd);
     }
+    
+    // keep the priority order of the messages sent at the same date
+    std::stable_sort(m_playbackPlan.begin(), m_playbackPlan.end(),
+                     [] (const EnginePlannedMessage & a, const EnginePlannedMessage & b) { return a.date < b.date; });
+    
+    return m_playbackPlan.size();
 }
 
-void Engine::removeNetworkDevice(const std::string & deviceName)
+void Engine::planCtrlPointMessages(TimeBoxId boxId, TimeEventIndex controlPointIndex, TimeValue date)
 {
-    TTValue     v, out;
-    TTSymbol    applicationName(deviceName);
-    TTObject    anApplication = accessApplication(applicationName);
-    TTSymbol    protocolName;
-    TTObject    aProtocol;
+    vector<string> messages;
     
-    // if the application exists
-    if (anApplication.valid()) {
-        
-        // get the protocol name used by the application (we register distante application to 1 protocol only)
-        protocolName = accessApplicationProtocolNames(applicationName)[0];
-        aProtocol = accessProtocol(protocolName);
-        
-        // stop the protocol for this application
-        aProtocol.send("Stop");
+    getCtrlPointMessagesToSend(boxId, controlPointIndex, messages);
+    
+    // parse the messages as sendNetworkMessage does
+    for (auto &message : messages) {
         
-        // unregister the application to the protocol
-        aProtocol.send("ApplicationUnregister", applicationName, out);
+        EnginePlannedMessage planned;
+        TTValue v = TTString(message);
+        v.fromString();
         
-        // realease the application
-        m_applicationManager.send("ApplicationRelease", applicationName, out);
+        TTSymbol aSymbol = v[0];
+        planned.date = date;
+        planned.networktreeAddress = retainPlanAddress(aSymbol.string().data());
+        planned.address = toTTAddress(planned.networktreeAddress, aSymbol.string().data());
+        planned.value.copyFrom(v, 1);
+        m_playbackPlan.push_back(planned);
     }
 }
 
-void Engine::sendNetworkMessage(const std::string & stringToSend)
-{    
-    TTValue out, data, v = TTString(stringToSend);
-    v.fromString();
+AddressHandle Engine::retainPlanAddress(const std::string & address)
+{
+    AddressHandle handle = m_addresses->intern(address);
     
-    TTSymbol aSymbol = v[0];
-    TTAddress anAddress = toTTAddress(aSymbol.string().data());
-    data.copyFrom(v, 1);
+    if (m_playbackPlanAddresses.insert(handle).second)
+        m_addresses->retain(handle);
     
-    m_sender.set(kTTSym_address, anAddress);
-    m_sender.send(kTTSym_Send, data, out);
+    return handle;
 }
 
-void Engine::getProtocolNames(std::vector<std::string>& allProtocolNames)
+void Engine::getBoxesAbsoluteDates(map<TimeBoxId, TimeValue> & boxesBegin, map<TimeBoxId, TimeValue> & boxesEnd)
 {
-    TTValue     protocolNames;
-    TTSymbol    name;
+    vector<TimeBoxId> boxesId;
     
-    // get all protocol names
-    m_applicationManager.get("protocolNames", protocolNames);
-    
-    for (TTUInt8 i = 0; i < protocolNames.size(); i++) {
+    // the dates of the boxes from the start of the main scenario (the dates of a sub box are relative to its parent)
+    getBoxesId(boxesId);
+    for (TimeBoxId boxId : boxesId) {
         
-        name = protocolNames[i];
-        allProtocolNames.push_back(name.c_str());
+        if (boxId == ROOT_BOX_ID)
+            continue;
+        
+        TimeValue offset = 0;
+        for (TimeBoxId parentId = getParentId(boxId); parentId != ROOT_BOX_ID && parentId != NO_ID; parentId = getParentId(parentId))
+            offset += getBoxBeginTime(parentId);
+        
+        boxesBegin[boxId] = offset + getBoxBeginTime(boxId);
+        boxesEnd[boxId] = offset + getBoxEndTime(boxId);
     }
 }
 
-void Engine::getNetworkDevicesName(std::vector<std::string>& allDeviceNames)
+bool Engine::isBoxMutedInScore(TimeBoxId boxId)
 {
-    TTValue     applicationNames;
-    TTSymbol    name;
+    for (; boxId != ROOT_BOX_ID && boxId != NO_ID; boxId = getParentId(boxId))
+        if (getBoxMuteState(boxId))
+            return true;
     
-    // get all application name
-    m_applicationManager.get("applicationNames", applicationNames);
+    return false;
+}
+
+map<string, float> Engine::getCurveSampleRateFactors()
+{
+    map<string, float>                          factors;
+    map<string, map<TimeValue, long long> >     rateChanges;
+    map<string, unsigned int>                   budgets;
+    map<TimeBoxId, TimeValue>                   boxesBegin, boxesEnd;
     
-    for (TTUInt8 i = 0; i < applicationNames.size(); i++) {
-        
-        name = applicationNames[i];
+    {
+        std::lock_guard<std::mutex> lock(m_outputsMutex);
+        budgets = m_deviceBudgets;
+    }
+    
+    if (budgets.empty())
+        return factors;
+    
+    // the samples by second the curves of each device add at their start and remove at their end
+    getBoxesAbsoluteDates(boxesBegin, boxesEnd);
+    for (auto &box : boxesBegin) {
         
-        // don't return iscore application name
-        if (name == iscore)
+        if (isBoxMutedInScore(box.first))
             continue;
         
-        allDeviceNames.push_back(name.c_str());
+        for (auto &address : getCurvesAddress(box.first)) {
+            
+            string device = address.substr(0, address.find('/'));
+            
+            if (budgets.find(device) == budgets.end() || getCurveMuteState(box.first, address))
+                continue;
+            
+            unsigned int sampleRate = getCurveSampleRate(box.first, address);
+            rateChanges[device][box.second] += sampleRate;
+            rateChanges[device][boxesEnd[box.first]] -= sampleRate;
+        }
     }
-}
-
-bool Engine::isNetworkDeviceRequestable(const std::string deviceName)
-{
-    TTSymbol    applicationName(deviceName);
-    TTObject    anApplication = accessApplication(applicationName);
-    TTSymbol    protocolName;
-    TTObject    aProtocol;
-    TTValue     v, out;
-    TTBoolean   discover = NO;
     
-    // if the application exists
-    if (anApplication.valid()) {
+    // the highest rate of the curves running at the same time
+    for (auto &device : rateChanges) {
         
-        // get the protocol name used by the application (we register distante application to 1 protocol only)
-        protocolName = accessApplicationProtocolNames(applicationName)[0];
-        aProtocol = accessProtocol(protocolName);
+        long long rate = 0, maxRate = 0;
         
-        aProtocol.get("discover", out);
-   
-        discover = out[0];
+        for (auto &change : device.second) {
+            rate += change.second;
+            maxRate = std::max(maxRate, rate);
+        }
+        
+        if (maxRate > budgets[device.first])
+            factors[device.first] = float(budgets[device.first]) / maxRate;
     }
     
-    return discover;
+    return factors;
 }
 
-std::vector<std::string> Engine::requestNetworkSnapShot(const std::string & address)
+void Engine::adaptCurveSampleRates()
 {
-    vector<string>      snapshot;
-    TTAddress           anAddress = toTTAddress(address);
-    TTNodeDirectoryPtr  aDirectory;
-    TTNodePtr           aNode;
-    TTObject            anObject;
-    TTString            s;
-    TTValue             v;
+    vector<TimeBoxId> boxesId;
     
-    // get the application directory
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
+    restoreCurveSampleRates();
     
-    if (aDirectory) {
+    map<string, float> factors = getCurveSampleRateFactors();
+    if (factors.empty())
+        return;
     
-        // get the node
-        if (!aDirectory->getTTNode(anAddress, &aNode)) {
+    getBoxesId(boxesId);
+    for (TimeBoxId boxId : boxesId) {
+        
+        for (auto &address : getCurvesAddress(boxId)) {
             
-            // get object attributes
-            anObject = aNode->getObject();
+            auto factor = factors.find(address.substr(0, address.find('/')));
+            if (factor == factors.end())
+                continue;
             
-            if (anObject.valid()) {
-                
-                // in case of proxy data or mirror object
-                if (anObject.name() == TTSymbol("Data") ||
-                    (anObject.name() == kTTSym_Mirror && TTMirrorPtr(anObject.instance())->getName() == TTSymbol("Data")))
-                {
-                    // get the service attribute
-                    anObject.get("service", v);
-                    TTSymbol service = v[0];
-                    
-                    // ask the value only for parameter
-                    if (service == kTTSym_parameter) {
-                        
-                        // get the value attribute
-                        if (!anObject.get("value", v)) {
-                            
-                            v.toString();
-                            s = TTString(v[0]);
-                        
-                            // append address value to the snapshot
-                            snapshot.push_back(address + " " + s.data());
-                        }
-                    }
-                }
-            }
+            unsigned int sampleRate = getCurveSampleRate(boxId, address);
+            if (sampleRate == 0)
+                continue;
+            
+            setCurveSampleRate(boxId, address, std::max<unsigned int>(sampleRate * factor->second, 1));
+            
+            AddressHandle handle = m_addresses->intern(address);
+            m_addresses->retain(handle);
+            m_nominalSampleRates[std::make_pair(boxId, handle)] = sampleRate;
         }
     }
-    
-    return snapshot;
 }
 
-int
-Engine::requestObjectAttributeValue(const std::string & address, const std::string & attribute, vector<string>& value)
+void Engine::restoreCurveSampleRates()
 {
-    TTAddress           anAddress = toTTAddress(address);
+    map<pair<TimeBoxId, AddressHandle>, unsigned int> nominalSampleRates;
+    
+    nominalSampleRates.swap(m_nominalSampleRates);
+    
+    for (auto &curve : nominalSampleRates) {
+        setCurveSampleRate(curve.first.first, m_addresses->address(curve.first.second), curve.second);
+        m_addresses->release(curve.first.second);
+    }
+}
+
+void Engine::clearPlaybackPlan()
+{
+    stopPlaybackPlan();
+    
+    m_playbackPlan.clear();
+    m_playbackPlanBegin = 0;
+    
+    for (AddressHandle handle : m_playbackPlanAddresses)
+        m_addresses->release(handle);
+    m_playbackPlanAddresses.clear();
+    m_playbackPlanEnd = 0;
+}
+
+bool Engine::playPlaybackPlan()
+{
+    bool running = false;
+    
+    // only one call can start the plan thread
+    if (m_playbackPlan.empty() || !m_planRunning.compare_exchange_strong(running, true))
+        return false;
+    
+    // the previous execution ended by itself or was stopped
+    if (m_planThread.joinable())
+        m_planThread.join();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_planMutex);
+        m_planStop = false;
+        m_planStatistics = EnginePlanStatistics();
+        m_lookaheadStatistics.clear();
+    }
+    
+    // where to send the messages of the devices with bundles (jamoma is not asked from the thread)
+    EnginePlanRouting               routing;
+    vector<EngineBundleDestination> & destinations = routing.destinations;
+    vector<int>                     & destinationOf = routing.destinationOf;
+    
+    destinationOf.assign(m_playbackPlan.size(), -1);
+    
+    if (m_planLookahead > 0) {
+        
+        map<string, int> destinationIndex;
+        
+        for (auto &device : m_bundleDevices) {
+            
+            EngineBundleDestination destination;
+            vector<int>             ports;
+            
+            if (getDeviceStringParameter(device, "OSC", "ip", destination.ip) != 0 ||
+                getDeviceIntegerVectorParameter(device, "OSC", "port", ports) != 0 || ports.empty())
+                continue;
+            
+            destination.device = device;
+            destination.port = ports[0];
+            destinationIndex[device] = destinations.size();
+            destinations.push_back(destination);
+        }
+        
+        for (unsigned int i = 0; i < m_playbackPlan.size() && !destinations.empty(); i++) {
+            
+            auto it = destinationIndex.find(m_playbackPlan[i].address.getDirectory().c_str());
+            if (it != destinationIndex.end())
+                destinationOf[i] = it->second;
+        }
+    }
+    
+    // the other messages are queued in the output of their protocol
+    routing.outputOf.assign(m_playbackPlan.size(), NULL);
+    routing.curveOf.assign(m_playbackPlan.size(), OUTPUT_CURVES_MAX);
+    
+    for (unsigned int i = 0; i < m_playbackPlan.size(); i++) {
+        
+        EnginePlannedMessage & message = m_playbackPlan[i];
+        
+        if (destinationOf[i] >= 0)
+            continue;
+        
+        routing.outputOf[i] = accessOutput(message.address.getDirectory().c_str());
+        
+        if (routing.outputOf[i] && message.sample)
+            routing.curveOf[i] = accessOutputCurve(routing.outputOf[i], message);
+    }
+    
+    m_planDate = m_playbackPlanBegin;
+    m_planThread = std::thread(&Engine::playPlaybackPlanMessages, this, routing);
+    
+    return true;
+}
+
+bool Engine::stopPlaybackPlan()
+{
+    bool wasRunning = m_planRunning;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_planMutex);
+        m_planStop = true;
+    }
+    m_planCondition.notify_all();
+    
+    if (m_planThread.joinable())
+        m_planThread.join();
+    
+    return wasRunning;
+}
+
+bool Engine::isPlayingPlaybackPlan()
+{
+    return m_planRunning;
+}
+
+TimeValue Engine::getPlaybackPlanDate()
+{
+    return m_planDate;
+}
+
+EnginePlanStatistics Engine::getPlaybackPlanStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_planMutex);
+    
+    return m_planStatistics;
+}
+
+void Engine::setPlaybackLookahead(unsigned int lookahead)
+{
+    m_planLookahead = lookahead;
+}
+
+unsigned int Engine::getPlaybackLookahead()
+{
+    return m_planLookahead;
+}
+
+bool Engine::setDeviceBundles(const std::string & deviceName, bool bundles)
+{
+    string protocol;
+    
+    if (!bundles) {
+        m_bundleDevices.erase(deviceName);
+        return true;
+    }
+    
+    // only an OSC device can receive the bundles as they are
+    if (getDeviceProtocol(deviceName, protocol) != 0 || protocol != "OSC")
+        return false;
+    
+    m_bundleDevices.insert(deviceName);
+    return true;
+}
+
+bool Engine::getDeviceBundles(const std::string & deviceName)
+{
+    return m_bundleDevices.find(deviceName) != m_bundleDevices.end();
+}
+
+EngineLookaheadStatisticsMap Engine::getPlaybackLookaheadStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_planMutex);
+    
+    return m_lookaheadStatistics;
+}
+
+// converts a planned message into an OSC message, whose address is the jamoma address without its device
+static OSCMessage toOSCMessage(const EnginePlannedMessage & message)
+{
+    string      address = message.address.c_str();
+    OSCMessage  oscMessage(address.substr(address.find(':') + 1));
+    
+    for (TTUInt32 i = 0; i < message.value.size(); i++) {
+        
+        switch (message.value[i].type()) {
+                
+            case kTypeFloat32 :
+            case kTypeFloat64 :
+                oscMessage.addFloat(TTFloat64(message.value[i]));
+                break;
+                
+            case kTypeSymbol : {
+                TTSymbol s = message.value[i];
+                oscMessage.addString(s.c_str());
+                break;
+            }
+                
+            case kTypeString : {
+                TTString s = message.value[i];
+                oscMessage.addString(s);
+                break;
+            }
+                
+            default :
+                oscMessage.addInt(TTInt32(message.value[i]));
+                break;
+        }
+    }
+    
+    return oscMessage;
+}
+
+void Engine::playPlaybackPlanMessages(EnginePlanRouting routing)
+{
+    vector<EngineBundleDestination> & destinations = routing.destinations;
+    vector<int>                     & destinationOf = routing.destinationOf;
+    std::chrono::milliseconds lookahead(m_planLookahead.load());
+    size_t      size = m_playbackPlan.size();
+    QUdpSocket  socket;
+    QList<QHostAddress> hosts;
+    TTValue     out;
+    
+    for (auto &destination : destinations) {
+        
+        QHostAddress host(QString::fromStdString(destination.ip));
+        if (host.isNull())
+            host = QHostInfo::fromName(QString::fromStdString(destination.ip)).addresses().value(0);
+        hosts << host;
+    }
+    
+    // the plan starts once the destinations are resolved : a slow lookup doesn't make the first messages late
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::system_clock::time_point systemStart = std::chrono::system_clock::now();
+    
+    // the next message sent as is (bundled false) or in a bundle (bundled true) from i
+    auto next = [&] (size_t i, bool bundled) {
+        while (i < size && (destinationOf[i] >= 0) != bundled)
+            i++;
+        return i;
+    };
+    
+    size_t direct = next(0, false);
+    size_t bundled = next(0, true);
+    
+    while (direct < size || bundled < size) {
+        
+        // the bundled messages are sent lookahead before their date
+        std::chrono::steady_clock::time_point directDue = direct < size ? start + std::chrono::milliseconds(m_playbackPlan[direct].date - m_playbackPlanBegin) : std::chrono::steady_clock::time_point::max();
+        std::chrono::steady_clock::time_point bundledDue = bundled < size ? start + std::chrono::milliseconds(m_playbackPlan[bundled].date - m_playbackPlanBegin) : std::chrono::steady_clock::time_point::max();
+        bool toBundle = bundled < size && (direct == size || bundledDue - lookahead < directDue);
+        std::chrono::steady_clock::time_point due = toBundle ? bundledDue : directDue;
+        
+        // sleep until the message date (minus the lookahead), unless asked to stop
+        {
+            std::unique_lock<std::mutex> lock(m_planMutex);
+            if (m_planCondition.wait_until(lock, toBundle ? due - lookahead : due, [this] { return m_planStop; }))
+                break;
+        }
+        
+        if (!toBundle) {
+            
+            EnginePlannedMessage & message = m_playbackPlan[direct];
+            EngineOutput * output = routing.outputOf[direct];
+            
+            if (output == NULL) {
+                m_planSender.set(kTTSym_address, message.address);
+                m_planSender.send(kTTSym_Send, message.value, out);
+            }
+            else if (routing.curveOf[direct] < OUTPUT_CURVES_MAX)
+                outputCurveSample(output, routing.curveOf[direct], message.value);
+            else
+                outputCue(output, message.address, message.value);
+            
+            m_planDate = message.date;
+            direct = next(direct + 1, false);
+            
+            long long delay = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - due).count();
+            unsigned int lateness = std::max<long long>(delay, 0);
+            
+            std::lock_guard<std::mutex> lock(m_planMutex);
+            m_planStatistics.sentMessages++;
+            m_planStatistics.totalLateness += lateness;
+            m_planStatistics.maxLateness = std::max(m_planStatistics.maxLateness, lateness);
+            continue;
+        }
+        
+        // one bundle by device for the messages of this date, time tagged with it
+        TimeValue           date = m_playbackPlan[bundled].date;
+        vector<OSCBundle>   bundles(destinations.size(), OSCBundle(OSCBundle::timeTag(systemStart + (due - start))));
+        
+        for (; bundled < size && m_playbackPlan[bundled].date == date; bundled = next(bundled + 1, true))
+            bundles[destinationOf[bundled]].add(toOSCMessage(m_playbackPlan[bundled]));
+        
+        m_planDate = date;
+        
+        for (unsigned int d = 0; d < bundles.size(); d++) {
+            
+            if (bundles[d].size() == 0)
+                continue;
+            
+            const vector<char> & data = bundles[d].data();
+            socket.writeDatagram(data.data(), data.size(), hosts[d], destinations[d].port);
+            
+            long long advance = std::chrono::duration_cast<std::chrono::microseconds>(due - std::chrono::steady_clock::now()).count();
+            
+            std::lock_guard<std::mutex> lock(m_planMutex);
+            EngineLookaheadStatistics & statistics = m_lookaheadStatistics[destinations[d].device];
+            statistics.minAdvance = statistics.sentBundles ? std::min(statistics.minAdvance, advance) : advance;
+            statistics.totalAdvance += advance;
+            statistics.sentBundles++;
+            statistics.sentMessages += bundles[d].size();
+        }
+    }
+    
+    m_planRunning = false;
+}
+
+void Engine::addNetworkDevice(const std::string & deviceName, const std::string & pluginToUse, const std::string & DeviceIp, const unsigned int & destinationPort, const unsigned int & receptionPort, const bool isInputPort, const std::string & stringPort)
+{
+    TTValue     args, none, out;
+    TTSymbol    applicationName(deviceName);
+    TTObject    anApplication;
+    TTObject    aProtocol;
+    TTErr       err;
+    
+    // create the application if it doesn't already exist
+    {
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        
+        if (!accessApplication(applicationName)) {
+            
+            m_applicationManager.send("ApplicationInstantiateDistant", applicationName, out);
+            anApplication = out[0];
+        }
+    }
+    
+    // the protocol is run without the lock
+    if (anApplication.valid()) {
+        
+        // check if the protocol has been loaded
+        aProtocol = accessProtocol(TTSymbol(pluginToUse));
+		if (aProtocol.valid()) {
+            
+            // stop the protocol
+            aProtocol.send("Stop");
+            
+            // register the application to the protocol
+            aProtocol.send("ApplicationRegister", applicationName, out);
+            
+            // select appliction before to set its parameter
+            aProtocol.send("ApplicationSelect", applicationName, out);
+            
+            // prepare parameters depending of the protocol
+            if (pluginToUse == "Minuit" || pluginToUse == "OSC") {
+                
+                args = TTValue(TTUInt16(destinationPort), TTUInt16(receptionPort));
+                aProtocol.set("port", args);
+                aProtocol.set("ip", TTSymbol(DeviceIp));
+            }
+            else if (pluginToUse == "MIDI") {
+                
+                if (isInputPort)
+                    aProtocol.set("input", TTSymbol(stringPort));
+                else
+                    aProtocol.set("output", TTSymbol(stringPort));
+            }
+            
+            // run the protocol
+            err = aProtocol.send("Run", none, out);
+            
+            if (err) {
+                out.toString();
+                TTSymbol errorInfo = TTSymbol(TTString(out[0]));
+                m_NetworkDeviceConnectionError(iscore, errorInfo);
+            }
+        }
+        
+        // set the priority, service, tags and rangeBounds attributes as a cached attributes
+        args = kTTSym_priority;
+        args.append(kTTSym_service);
+        args.append(kTTSym_tags);
+        args.append(kTTSym_rangeBounds);
+        args.append(kTTSym_rangeClipmode);
+        
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        anApplication.set("cachedAttributes", args);
+    }
+}
+
+void Engine::removeNetworkDevice(const std::string & deviceName)
+{
+    TTValue     v, out;
+    TTSymbol    applicationName(deviceName);
+    TTObject    anApplication = accessApplication(applicationName);
+    TTSymbol    protocolName;
+    TTObject    aProtocol;
+    
+    // if the application exists
+    if (anApplication.valid()) {
+        
+        // forget its parameters values before the mirrors are released
+        clearValueCache(deviceName);
+        forgetCachedAddresses(deviceName);
+        m_bundleDevices.erase(deviceName);
+        
+        {
+            std::lock_guard<std::mutex> lock(m_outputsMutex);
+            m_outputsByDevice.erase(deviceName);
+            m_deviceBudgets.erase(deviceName);
+        }
+        
+        // get the protocol name used by the application (we register distante application to 1 protocol only)
+        protocolName = accessApplicationProtocolNames(applicationName)[0];
+        aProtocol = accessProtocol(protocolName);
+        
+        // stop the protocol for this application
+        aProtocol.send("Stop");
+        
+        // unregister the application to the protocol
+        aProtocol.send("ApplicationUnregister", applicationName, out);
+        
+        // realease the application (its directory with it)
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        m_applicationManager.send("ApplicationRelease", applicationName, out);
+    }
+}
+
+void Engine::sendNetworkMessage(const std::string & stringToSend)
+{    
+    TTValue out, data, v = TTString(stringToSend);
+    v.fromString();
+    
+    TTSymbol aSymbol = v[0];
+    TTAddress anAddress = toTTAddress(aSymbol.string().data());
+    data.copyFrom(v, 1);
+    
+    // let the output thread of the protocol send it
+    EngineOutput * output = accessOutput(anAddress.getDirectory().c_str());
+    if (output) {
+        outputCue(output, anAddress, data);
+        return;
+    }
+    
+    m_sender.set(kTTSym_address, anAddress);
+    m_sender.send(kTTSym_Send, data, out);
+}
+
+void Engine::setOutputQueueCapacity(unsigned int capacity)
+{
+    // the playback plan may be queuing messages
+    stopPlaybackPlan();
+    stopOutputs();
+    
+    std::lock_guard<std::mutex> lock(m_outputsMutex);
+    m_outputQueueCapacity = capacity;
+}
+
+unsigned int Engine::getOutputQueueCapacity()
+{
+    std::lock_guard<std::mutex> lock(m_outputsMutex);
+    
+    return m_outputQueueCapacity;
+}
+
+EngineOutputMetricsMap Engine::getOutputMetrics()
+{
+    EngineOutputMetricsMap          metrics;
+    std::lock_guard<std::mutex>     lock(m_outputsMutex);
+    
+    for (auto &output : m_outputs) {
+        
+        EngineOutputMetrics & m = metrics[output.first];
+        m.depth = std::max(output.second->depth.load(), 0);
+        m.maxDepth = output.second->maxDepth;
+        m.sentMessages = output.second->sentMessages;
+        m.droppedSamples = output.second->droppedSamples;
+        m.overflowDepth = output.second->overflowDepth;
+        m.maxOverflowDepth = output.second->maxOverflowDepth;
+        m.budgetDrops = output.second->budgetDrops;
+    }
+    
+    return metrics;
+}
+
+void Engine::setDeviceMessageBudget(const std::string & deviceName, unsigned int messagesBySecond)
+{
+    std::lock_guard<std::mutex> lock(m_outputsMutex);
+    
+    if (messagesBySecond == 0)
+        m_deviceBudgets.erase(deviceName);
+    else
+        m_deviceBudgets[deviceName] = messagesBySecond;
+    
+    // the outputs which already send to the device
+    for (auto &output : m_outputs) {
+        
+        auto budget = output.second->budgetsIndex.find(deviceName);
+        if (budget != output.second->budgetsIndex.end())
+            output.second->budgets[budget->second].messagesBySecond = messagesBySecond;
+    }
+}
+
+unsigned int Engine::getDeviceMessageBudget(const std::string & deviceName)
+{
+    std::lock_guard<std::mutex> lock(m_outputsMutex);
+    
+    auto budget = m_deviceBudgets.find(deviceName);
+    
+    return budget != m_deviceBudgets.end() ? budget->second : 0;
+}
+
+void Engine::setOutputTick(unsigned int tick)
+{
+    m_outputTick = tick;
+}
+
+unsigned int Engine::getOutputTick()
+{
+    return m_outputTick;
+}
+
+EngineOutput* Engine::accessOutput(const std::string & deviceName)
+{
+    std::lock_guard<std::mutex> lock(m_outputsMutex);
+    
+    if (m_outputQueueCapacity == 0)
+        return NULL;
+    
+    auto it = m_outputsByDevice.find(deviceName);
+    if (it != m_outputsByDevice.end())
+        return it->second;
+    
+    // the protocol of the device (we register distant application to 1 protocol only)
+    TTValue protocolNames = accessApplicationProtocolNames(TTSymbol(deviceName));
+    if (protocolNames.size() == 0)
+        return NULL;
+    
+    TTSymbol        protocolName = protocolNames[0];
+    EngineOutput*   &output = m_outputs[protocolName.c_str()];
+    
+    if (output == NULL) {
+        
+        output = new EngineOutput(m_outputQueueCapacity);
+        output->protocol = protocolName.c_str();
+        output->sender = TTObject("Sender");
+        output->thread = std::thread(&Engine::sendOutputMessages, this, output);
+    }
+    
+    m_outputsByDevice[deviceName] = output;
+    
+    return output;
+}
+
+unsigned int Engine::accessOutputCurve(EngineOutput* output, const EnginePlannedMessage & message)
+{
+    std::lock_guard<std::mutex> lock(m_outputsMutex);
+    
+    auto it = output->curvesIndex.find(message.networktreeAddress);
+    if (it != output->curvesIndex.end())
+        return it->second;
+    
+    unsigned int curve = output->curvesIndex.size();
+    if (curve >= OUTPUT_CURVES_MAX)
+        return OUTPUT_CURVES_MAX;
+    
+    // the output thread only reads the address of a slot once it is queued
+    output->curves[curve].address = message.address;
+    output->curves[curve].device = accessOutputBudget(output, message.address.getDirectory().c_str());
+    output->curvesIndex[message.networktreeAddress] = curve;
+    m_addresses->retain(message.networktreeAddress);
+    
+    return curve;
+}
+
+unsigned int Engine::accessOutputBudget(EngineOutput* output, const std::string & deviceName)
+{
+    auto it = output->budgetsIndex.find(deviceName);
+    if (it != output->budgetsIndex.end())
+        return it->second;
+    
+    unsigned int device = output->budgetsIndex.size();
+    if (device >= OUTPUT_DEVICES_MAX)
+        return OUTPUT_DEVICES_MAX;
+    
+    auto budget = m_deviceBudgets.find(deviceName);
+    output->budgets[device].messagesBySecond = budget != m_deviceBudgets.end() ? budget->second : 0;
+    output->budgetsIndex[deviceName] = device;
+    
+    return device;
+}
+
+bool Engine::spendOutputBudget(EngineOutput* output, unsigned int device)
+{
+    if (device >= OUTPUT_DEVICES_MAX)
+        return true;
+    
+    EngineDeviceBudget & budget = output->budgets[device];
+    unsigned int messagesBySecond = budget.messagesBySecond;
+    
+    if (messagesBySecond == 0)
+        return true;
+    
+    // refill the tokens for the time elapsed, up to a burst
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - budget.refill).count();
+    double burst = std::max(messagesBySecond * OUTPUT_BUDGET_BURST / 1000., 1.);
+    
+    budget.tokens = std::min(budget.tokens + elapsed * messagesBySecond, burst);
+    budget.refill = now;
+    
+    if (budget.tokens < 1)
+        return false;
+    
+    budget.tokens--;
+    return true;
+}
+
+void Engine::outputCue(EngineOutput* output, const TTAddress & address, const TTValue & value)
+{
+    EngineOutputMessage     message;
+    EngineOverflowMessage   overflowed;
+    
+    // while messages overflow, the next ones follow them to keep their order
+    if (output->overflowDepth == 0 && output->freeCues.pop(message.cue)) {
+        
+        // the slot keeps its storage from a cue to the next
+        EngineCueSlot & slot = output->cues[message.cue];
+        slot.address = address;
+        slot.value = value;
+        
+        if (pushOutputMessage(output, message))
+            return;
+        
+        output->freeCues.push(message.cue);
+    }
+    
+    // a cue is never dropped : it waits in the overflow rather than stalling the caller
+    overflowed.address = address;
+    overflowed.value = value;
+    
+    overflowOutputMessage(output, overflowed);
+}
+
+void Engine::outputCurveSample(EngineOutput* output, unsigned int curve, const TTValue & value)
+{
+    EngineCurveSlot &   slot = output->curves[curve];
+    bool                pending;
+    
+    while (slot.locked.exchange(true, std::memory_order_acquire))
+        std::this_thread::yield();
+    
+    slot.value = value;
+    pending = slot.pending;
+    slot.pending = true;
+    
+    slot.locked.store(false, std::memory_order_release);
+    
+    // the previous sample is not sent yet : it is replaced
+    if (pending) {
+        output->droppedSamples++;
+        return;
+    }
+    
+    // the slot takes the place of the sample in the queue, after the messages in overflow if any
+    if (output->overflowDepth > 0) {
+        
+        EngineOverflowMessage overflowed;
+        overflowed.curve = curve;
+        
+        overflowOutputMessage(output, overflowed);
+        return;
+    }
+    
+    EngineOutputMessage message;
+    message.curve = curve;
+    
+    if (pushOutputMessage(output, message))
+        return;
+    
+    // the queue is full : the sample is dropped and the next sample of the curve will be queued again
+    output->droppedSamples++;
+    
+    while (slot.locked.exchange(true, std::memory_order_acquire))
+        std::this_thread::yield();
+    
+    slot.pending = false;
+    
+    slot.locked.store(false, std::memory_order_release);
+}
+
+bool Engine::pushOutputMessage(EngineOutput* output, const EngineOutputMessage & message)
+{
+    // a slow device must not stall the caller
+    if (!output->queue.push(message))
+        return false;
+    
+    notifyOutput(output);
+    
+    return true;
+}
+
+void Engine::overflowOutputMessage(EngineOutput* output, const EngineOverflowMessage & message)
+{
+    unsigned int overflowDepth;
+    
+    {
+        std::lock_guard<std::mutex> lock(output->overflowMutex);
+        output->overflow.push_back(message);
+        overflowDepth = ++output->overflowDepth;
+    }
+    
+    unsigned int maxOverflowDepth = output->maxOverflowDepth;
+    
+    while (overflowDepth > maxOverflowDepth && !output->maxOverflowDepth.compare_exchange_weak(maxOverflowDepth, overflowDepth))
+        ;
+    
+    notifyOutput(output);
+}
+
+void Engine::notifyOutput(EngineOutput* output)
+{
+    unsigned int depth = std::max(++output->depth, 0);
+    unsigned int maxDepth = output->maxDepth;
+    
+    while (depth > maxDepth && !output->maxDepth.compare_exchange_weak(maxDepth, depth))
+        ;
+    
+    // the output thread checks the depth before sleeping
+    if (output->sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(output->mutex);
+        output->condition.notify_one();
+    }
+}
+
+void Engine::sendOutputMessages(EngineOutput* output)
+{
+    EngineOutputMessage message;
+    EngineOverflowMessage overflowed;
+    TTAddress           address;
+    TTValue             value, out;
+    std::chrono::steady_clock::time_point nextTick = std::chrono::steady_clock::now();
+    int                 tickMessages = 0;
+    
+    // the samples are copied without allocating
+    value.reserve(OUTPUT_MESSAGE_VALUES);
+    
+    while (true) {
+        
+        // with a tick, only the messages queued before it are sent : the queue may never drain when overloaded
+        unsigned int tick = m_outputTick;
+        
+        bool popped = false, fromOverflow = false;
+        
+        if (tick == 0 || tickMessages > 0) {
+            
+            popped = output->queue.pop(message);
+            
+            // the messages in overflow were queued after the ones of the queue
+            if (!popped && output->overflowDepth > 0) {
+                
+                std::lock_guard<std::mutex> lock(output->overflowMutex);
+                
+                if (!output->overflow.empty()) {
+                    
+                    overflowed = std::move(output->overflow.front());
+                    output->overflow.pop_front();
+                    output->overflowDepth--;
+                    popped = fromOverflow = true;
+                }
+            }
+        }
+        
+        if (popped) {
+            
+            output->depth--;
+            
+            if (tickMessages > 0)
+                tickMessages--;
+            
+            unsigned int curve = fromOverflow ? overflowed.curve : message.curve;
+            
+            // a curve sends its last sample, unless its device is over its budget : the next sample will carry a newer value
+            if (curve < OUTPUT_CURVES_MAX) {
+                
+                EngineCurveSlot & slot = output->curves[curve];
+                bool budget = spendOutputBudget(output, slot.device);
+                
+                while (slot.locked.exchange(true, std::memory_order_acquire))
+                    std::this_thread::yield();
+                
+                address = slot.address;
+                value = slot.value;
+                slot.pending = false;
+                
+                slot.locked.store(false, std::memory_order_release);
+                
+                if (!budget) {
+                    output->budgetDrops++;
+                    continue;
+                }
+                
+                output->sender.set(kTTSym_address, address);
+                output->sender.send(kTTSym_Send, value, out);
+            }
+            // a cue is never dropped, and the budget of its device is left to the curves
+            else if (fromOverflow) {
+                
+                output->sender.set(kTTSym_address, overflowed.address);
+                output->sender.send(kTTSym_Send, overflowed.value, out);
+            }
+            else {
+                
+                EngineCueSlot & slot = output->cues[message.cue];
+                
+                output->sender.set(kTTSym_address, slot.address);
+                output->sender.send(kTTSym_Send, slot.value, out);
+                output->freeCues.push(message.cue);
+            }
+            
+            output->sentMessages++;
+            continue;
+        }
+        
+        // sleep until a message is queued, or stop once the queue is empty
+        std::unique_lock<std::mutex> lock(output->mutex);
+        
+        // with a tick, the samples queued until the next one are coalesced, then the messages queued meanwhile are sent
+        if (tick > 0) {
+            
+            if (!output->stop) {
+                nextTick = std::max(nextTick + std::chrono::milliseconds(tick), std::chrono::steady_clock::now());
+                output->condition.wait_until(lock, nextTick, [output] { return output->stop; });
+            }
+            
+            tickMessages = std::max(output->depth.load(), 0);
+            
+            if (output->stop && tickMessages == 0)
+                break;
+            
+            continue;
+        }
+        
+        if (output->stop)
+            break;
+        
+        output->sleeping = true;
+        
+        if (output->depth > 0) {
+            output->sleeping = false;
+            continue;
+        }
+        
+        output->condition.wait(lock, [output] { return !output->sleeping || output->stop; });
+        output->sleeping = false;
+    }
+}
+
+void Engine::stopOutputs()
+{
+    std::map<std::string, EngineOutput*> outputs;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_outputsMutex);
+        outputs.swap(m_outputs);
+        m_outputsByDevice.clear();
+    }
+    
+    for (auto &output : outputs) {
+        
+        {
+            std::lock_guard<std::mutex> lock(output.second->mutex);
+            output.second->stop = true;
+        }
+        output.second->condition.notify_one();
+        
+        output.second->thread.join();
+        
+        for (auto &curve : output.second->curvesIndex)
+            m_addresses->release(curve.first);
+        
+        delete output.second;
+    }
+}
+
+void Engine::getProtocolNames(std::vector<std::string>& allProtocolNames)
+{
+    TTValue     protocolNames;
+    TTSymbol    name;
+    
+    // get all protocol names
+    m_applicationManager.get("protocolNames", protocolNames);
+    
+    for (TTUInt8 i = 0; i < protocolNames.size(); i++) {
+        
+        name = protocolNames[i];
+        allProtocolNames.push_back(name.c_str());
+    }
+}
+
+void Engine::getNetworkDevicesName(std::vector<std::string>& allDeviceNames)
+{
+    TTValue     applicationNames;
+    TTSymbol    name;
+    
+    // get all application name
+    m_applicationManager.get("applicationNames", applicationNames);
+    
+    for (TTUInt8 i = 0; i < applicationNames.size(); i++) {
+        
+        name = applicationNames[i];
+        
+        // don't return iscore application name
+        if (name == iscore)
+            continue;
+        
+        allDeviceNames.push_back(name.c_str());
+    }
+}
+
+bool Engine::isNetworkDeviceRequestable(const std::string deviceName)
+{
+    TTSymbol    applicationName(deviceName);
+    TTObject    anApplication = accessApplication(applicationName);
+    TTSymbol    protocolName;
+    TTObject    aProtocol;
+    TTValue     v, out;
+    TTBoolean   discover = NO;
+    
+    // if the application exists
+    if (anApplication.valid()) {
+        
+        // get the protocol name used by the application (we register distante application to 1 protocol only)
+        protocolName = accessApplicationProtocolNames(applicationName)[0];
+        aProtocol = accessProtocol(protocolName);
+        
+        aProtocol.get("discover", out);
+   
+        discover = out[0];
+    }
+    
+    return discover;
+}
+
+std::vector<std::string> Engine::requestNetworkSnapShot(const std::string & address)
+{
+    vector<string>              snapshot;
+    std::map<string, string>    values = requestNetworkSnapShot(vector<string>(1, address));
+    
+    if (!values.empty())
+        snapshot.push_back(values.begin()->second);
+    
+    return snapshot;
+}
+
+std::map<std::string, std::string> Engine::requestNetworkSnapShot(const std::vector<std::string> & addresses)
+{
+    typedef std::pair<string, TTAddress>            AddressPair;
+    
+    std::map<string, string>                        snapshot;
+    std::map<string, vector<AddressPair> >          addressesByDevice;
+    std::map<string, vector<AddressPair> >::iterator it;
     TTNodeDirectoryPtr  aDirectory;
     TTNodePtr           aNode;
     TTObject            anObject;
-    TTString            s;
+    string              value;
+    TTValue             v;
+    
+    // group the addresses by device to read their values from the device cache
+    for (vector<string>::const_iterator a = addresses.begin(); a != addresses.end(); ++a) {
+        TTAddress anAddress = toTTAddress(*a);
+        addressesByDevice[anAddress.getDirectory().c_str()].push_back(AddressPair(*a, anAddress));
+    }
+    
+    for (it = addressesByDevice.begin(); it != addressesByDevice.end(); ++it) {
+        
+        for (vector<AddressPair>::iterator anAddress = it->second.begin(); anAddress != it->second.end(); ++anAddress) {
+            
+            // the namespace is locked to find the object only : its value can be asked through the network
+            {
+                std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+                
+                aDirectory = accessNamespaceDirectory(anAddress->second);
+                
+                if (!aDirectory || aDirectory->getTTNode(anAddress->second, &aNode))
+                    continue;
+                
+                anObject = aNode->getObject();
+            }
+            
+            if (!anObject.valid())
+                continue;
+            
+            // in case of proxy data or mirror object
+            if (anObject.name() == TTSymbol("Data") ||
+                (anObject.name() == kTTSym_Mirror && TTMirrorPtr(anObject.instance())->getName() == TTSymbol("Data")))
+            {
+                // get the service attribute
+                anObject.get("service", v);
+                TTSymbol service = v[0];
+                
+                // ask the value only for parameter
+                if (service == kTTSym_parameter) {
+                    
+                    // get the value from the cache
+                    if (getCachedValue(it->first, anAddress->first, anObject, value, VALUE_CACHE_MAX_AGE))
+                        
+                        // append address value to the snapshot
+                        snapshot[anAddress->first] = anAddress->first + " " + value;
+                }
+            }
+        }
+    }
+    
+    return snapshot;
+}
+
+int
+Engine::requestObjectAttributeValue(const std::string & address, const std::string & attribute, vector<string>& value)
+{
+    TTAddress           anAddress = toTTAddress(address);
+    TTNodeDirectoryPtr  aDirectory;
+    TTNodePtr           aNode;
+    TTObject            anObject;
+    string              s;
     TTValue             v;
 
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
     value.clear();
 
-    if (!aDirectory)
-        return 1;
+    {
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        
+        aDirectory = accessNamespaceDirectory(anAddress);
+        
+        if (!aDirectory)
+            return 1;
+        
+        if (aDirectory->getTTNode(anAddress, &aNode))
+            return 0;
+        
+        anObject = aNode->getObject();
+    }
 
-    if (!aDirectory->getTTNode(anAddress, &aNode)) {
+    // get object attributes
+    if (anObject.valid()) {
+        
+        // the other attributes are cached by the mirrors (see in addNetworkDevice)
+        if (attribute == "value") {
+            
+            if (getCachedValue(anAddress.getDirectory().c_str(), address, anObject, s, VALUE_CACHE_MAX_AGE)) {
+                
+                value.push_back(s);
+                return 1;
+            }
+        }
+        else if (!anObject.get(TTSymbol(attribute), v)) {
+            
+            v.toString();
+            s = TTString(v[0]).c_str();
+            value.push_back(s);
+            return 1;
+        }
+    }
+    return 0;
+}
 
-        // get object attributes
+int
+Engine::getCachedValue(const std::string & address, std::string & value, unsigned int maxAge)
+{
+    AddressHandle       handle = m_addresses->intern(address);
+    TTAddress           anAddress = toTTAddress(handle, address);
+    TTNodeDirectoryPtr  aDirectory;
+    TTNodePtr           aNode;
+    TTObject            anObject;
+    
+    // a fresh value doesn't need any directory access
+    {
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        
+        EngineDevicesValuesMap::iterator device = m_valueCacheMap.find(anAddress.getDirectory().c_str());
+        
+        if (device != m_valueCacheMap.end()) {
+            
+            EngineValuesMap::iterator it = device->second.find(handle);
+            
+            if (it != device->second.end() && it->second->isFresh(maxAge)) {
+                
+                value = it->second->value;
+                return 1;
+            }
+        }
+    }
+    
+    // the namespace is locked to find the object only : its value can be asked through the network
+    {
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        
+        aDirectory = accessNamespaceDirectory(anAddress);
+        
+        if (!aDirectory || aDirectory->getTTNode(anAddress, &aNode))
+            return 0;
+        
         anObject = aNode->getObject();
+    }
+    
+    if (!anObject.valid())
+        return 0;
+    
+    return getCachedValue(anAddress.getDirectory().c_str(), handle, anObject, value, maxAge);
+}
 
-        if (anObject.valid()) {
+int
+Engine::getCachedValue(const std::string & deviceName, AddressHandle address, TTObject & anObject, std::string & value, unsigned int maxAge)
+{
+    EngineCachedValuePtr    e;
+    TTAttributePtr          anAttribute = NULL;
+    TTBoolean               isMirror = anObject.name() == kTTSym_Mirror;
+    TTBoolean               cached = NO;
+    TTString                s;
+    TTValue                 v;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        
+        EngineDevicesValuesMap::iterator device = m_valueCacheMap.find(deviceName);
+        
+        if (device != m_valueCacheMap.end()) {
             
-            if (!anObject.get(TTSymbol(attribute), v)) {
+            EngineValuesMap::iterator it = device->second.find(address);
+            
+            if (it != device->second.end()) {
                 
-                v.toString();
-                s = TTString(v[0]);
-                value.push_back(s.c_str());
-                return 1;
+                if (it->second->isFresh(maxAge)) {
+                    
+                    value = it->second->value;
+                    return 1;
+                }
+                
+                // an old value is read again below, its observation is kept
+                cached = YES;
+            }
+        }
+    }
+    
+    // read the value from the device (this can be a network request for a mirror)
+    if (anObject.get("value", v))
+        return 0;
+    
+    v.toString();
+    s = TTString(v[0]);
+    value = s.c_str();
+    
+    if (cached) {
+        
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        
+        EngineDevicesValuesMap::iterator device = m_valueCacheMap.find(deviceName);
+        
+        // the entry may have been cleared meanwhile : it is then observed again at the next request
+        if (device != m_valueCacheMap.end()) {
+            
+            EngineValuesMap::iterator it = device->second.find(address);
+            
+            if (it != device->second.end()) {
+                
+                it->second->value = value;
+                it->second->date = std::chrono::steady_clock::now();
             }
         }
+        return 1;
+    }
+    
+    if (anObject.instance()->findAttribute(kTTSym_value, &anAttribute))
+        return 1;
+    
+    e = EngineCachedValuePtr(new EngineCachedValue());
+    e->object = anObject;
+    e->value = value;
+    e->date = std::chrono::steady_clock::now();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        
+        EngineValuesMap& values = m_valueCacheMap[deviceName];
+        EngineValuesMap::iterator it = values.find(address);
+        
+        // another thread observed the value meanwhile : drop this entry
+        if (it != values.end()) {
+            
+            value = it->second->value;
+            return 1;
+        }
+        
+        values[address] = e;
+        m_addresses->retain(address);
+    }
+    
+    // observe the value attribute (outside the lock : the observation may notify the current value)
+    // the callback finds the entry by its address : it never uses an entry removed by clearValueCache
+    e->callback = TTObject("callback");
+    e->callback.set("baton", TTValue(TTPtr(this), TTSymbol(deviceName), TTUInt32(address)));
+    e->callback.set("function", TTPtr(&CachedValueCallback));
+    e->callback.set("notification", kTTSym_value);
+    
+    anAttribute->registerObserverForNotifications(e->callback);
+    
+    // the mirrors of the devices which can be listened (Minuit) are notified of each change,
+    // the others (OSC) of the messages received from the device only
+    if (isMirror && accessApplicationProtocolNames(TTSymbol(deviceName))[0] == TTSymbol("Minuit"))
+        e->listening = !TTMirrorPtr(anObject.instance())->enableListening(*anAttribute, YES);
+    
+    // read the value again : a value changed before the observation started would never be notified
+    if (!anObject.get("value", v)) {
+        
+        v.toString();
+        s = TTString(v[0]);
+        value = s.c_str();
+        
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        e->value = value;
+        e->date = std::chrono::steady_clock::now();
+    }
+    
+    return 1;
+}
+
+int
+Engine::peekCachedValue(const std::string & address, std::string & value)
+{
+    AddressHandle   handle = m_addresses->intern(address);
+    TTAddress       anAddress = toTTAddress(handle, address);
+    
+    std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+    
+    EngineDevicesValuesMap::iterator device = m_valueCacheMap.find(anAddress.getDirectory().c_str());
+    
+    if (device != m_valueCacheMap.end()) {
+        
+        EngineValuesMap::iterator it = device->second.find(handle);
+        
+        if (it != device->second.end()) {
+            
+            value = it->second->value;
+            
+            if (!it->second->isFresh(VALUE_CACHE_MAX_AGE))
+                queueValueRead(address);
+            
+            return 1;
+        }
     }
+    
+    queueValueRead(address);
     return 0;
 }
 
+void
+Engine::prefetchCachedValues(const std::vector<std::string> & addresses)
+{
+    std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+    
+    for (std::vector<std::string>::const_iterator it = addresses.begin(); it != addresses.end(); ++it)
+        queueValueRead(*it);
+}
+
+void
+Engine::queueValueRead(const std::string & address)
+{
+    if (m_valueReaderStop || !m_valueReadsPending.insert(address).second)
+        return;
+    
+    m_valueReads.push_back(address);
+    
+    // the reader starts with the first read
+    if (!m_valueReader.joinable())
+        m_valueReader = std::thread(&Engine::readQueuedValues, this);
+    else
+        m_valueReaderCondition.notify_one();
+}
+
+void
+Engine::readQueuedValues()
+{
+    std::string address, value;
+    
+    while (true) {
+        
+        {
+            std::unique_lock<std::mutex> lock(m_valueCacheMutex);
+            
+            m_valueReaderCondition.wait(lock, [this] { return m_valueReaderStop || !m_valueReads.empty(); });
+            
+            if (m_valueReaderStop)
+                return;
+            
+            address = m_valueReads.front();
+            m_valueReads.pop_front();
+            m_valueReadsPending.erase(address);
+        }
+        
+        if (getCachedValue(address, value) && m_CachedValueReadCallback)
+            m_CachedValueReadCallback(address, value);
+    }
+}
+
+void
+Engine::stopValueReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        
+        m_valueReaderStop = true;
+        m_valueReads.clear();
+        m_valueReadsPending.clear();
+    }
+    m_valueReaderCondition.notify_one();
+    
+    if (m_valueReader.joinable())
+        m_valueReader.join();
+}
+
+void
+Engine::clearValueCache(const std::string & deviceName)
+{
+    EngineDevicesValuesMap  toClear;
+    TTAttributePtr          anAttribute;
+    
+    // take the values out of the cache then stop the observations outside the lock
+    {
+        std::lock_guard<std::mutex> lock(m_valueCacheMutex);
+        
+        if (deviceName.empty())
+            toClear.swap(m_valueCacheMap);
+        
+        else {
+            
+            EngineDevicesValuesMap::iterator device = m_valueCacheMap.find(deviceName);
+            
+            if (device == m_valueCacheMap.end())
+                return;
+            
+            toClear[deviceName].swap(device->second);
+            m_valueCacheMap.erase(device);
+        }
+    }
+    
+    for (EngineDevicesValuesMap::iterator device = toClear.begin(); device != toClear.end(); ++device) {
+        
+        for (EngineValuesMap::iterator it = device->second.begin(); it != device->second.end(); ++it) {
+            
+            EngineCachedValuePtr e = it->second;
+            anAttribute = NULL;
+            
+            if (e->object.instance()->findAttribute(kTTSym_value, &anAttribute))
+                continue;
+            
+            if (e->listening)
+                TTMirrorPtr(e->object.instance())->enableListening(*anAttribute, NO);
+            
+            if (e->callback.valid())
+                anAttribute->unregisterObserverForNotifications(e->callback);
+        }
+    }
+    
+    // the callbacks don't use the addresses anymore
+    for (EngineDevicesValuesMap::iterator device = toClear.begin(); device != toClear.end(); ++device)
+        for (EngineValuesMap::iterator it = device->second.begin(); it != device->second.end(); ++it)
+            m_addresses->release(it->first);
+}
+
 int
 Engine::setObjectAttributeValue(const std::string & address, const std::string & attribute, std::string & value)
 {
@@ -2822,25 +4596,30 @@ Engine::setObjectAttributeValue(const std::string & address, const std::string &
     TTObject            anObject;
     TTValue             v;
     
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
     value.clear();
     
-    if (!aDirectory)
-        return 1;
-    
-    if (!aDirectory->getTTNode(anAddress, &aNode)) {
+    {
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        
+        aDirectory = accessNamespaceDirectory(anAddress);
+        
+        if (!aDirectory)
+            return 1;
+        
+        if (aDirectory->getTTNode(anAddress, &aNode))
+            return 0;
         
-        // set object attributes
         anObject = aNode->getObject();
+    }
+    
+    // the object is set without the lock : this can be sent through the network
+    if (anObject.valid()) {
         
-        if (anObject.valid()) {
-            
-            v = TTString(value);
-            v.fromString();
-      
-            if(!anObject.set(TTSymbol(attribute), v))
-                return 1;
-        }
+        v = TTString(value);
+        v.fromString();
+  
+        if(!anObject.set(TTSymbol(attribute), v))
+            return 1;
     }
     return 0;
 }
@@ -2848,6 +4627,8 @@ Engine::setObjectAttributeValue(const std::string & address, const std::string &
 int
 Engine::requestObjectType(const std::string & address, std::string & nodeType)
 {
+    std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+    
     TTNodeDirectoryPtr  aDirectory;
     TTAddress           anAddress = toTTAddress(address);
     TTSymbol            type;
@@ -2855,7 +4636,7 @@ Engine::requestObjectType(const std::string & address, std::string & nodeType)
     TTNodePtr           aNode;
 
     nodeType = "none";
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
+    aDirectory = accessNamespaceDirectory(anAddress);
 
     if (!aDirectory)
         return 0;
@@ -2890,22 +4671,23 @@ Engine::requestObjectPriority(const std::string &address, unsigned int &priority
     TTNodePtr           aNode;
     TTValue             v;
 
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
-
-    if (!aDirectory)
-        return 0;
-
-    if (!aDirectory->getTTNode(anAddress, &aNode)) {
-
+    {
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+        
+        aDirectory = accessNamespaceDirectory(anAddress);
+        
+        if (!aDirectory || aDirectory->getTTNode(anAddress, &aNode))
+            return 0;
+        
         anObject = aNode->getObject();
+    }
 
-        if (anObject.valid()) {
+    if (anObject.valid()) {
 
-            if (!anObject.get(kTTSym_priority, v))
-                priority = v[0];
-            else
-                return 1;
-        }
+        if (!anObject.get(kTTSym_priority, v))
+            priority = v[0];
+        else
+            return 1;
     }
     return 0;
 }
@@ -2913,13 +4695,15 @@ Engine::requestObjectPriority(const std::string &address, unsigned int &priority
 int
 Engine::requestObjectChildren(const std::string & address, vector<string>& children)
 {
+    std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+    
     TTNodeDirectoryPtr  aDirectory;
     TTAddress           anAddress = toTTAddress(address);
     TTNodePtr           aNode, childNode;
     TTList              nodeList;
     TTString            s;
 
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
+    aDirectory = accessNamespaceDirectory(anAddress);
     children.clear();
 
     if (!aDirectory)
@@ -2968,7 +4752,14 @@ Engine::rebuildNetworkNamespace(const string &deviceName, const string &/*addres
             if (m_namespaceObserver.valid())
                 return 1;
             
+            // the device builds the directory while it answers : no lock is held meanwhile
+            setNamespaceRebuilding(deviceName, true);
+            
+            // the mirrors are going to be replaced
+            clearValueCache(deviceName);
+            
             anApplication.send("DirectoryBuild");
+            setNamespaceRebuilding(deviceName, false);
             return 0;
         }
         // OSC case : reload the namespace from the last project file if exist
@@ -2987,8 +4778,11 @@ Engine::rebuildNetworkNamespace(const string &deviceName, const string &/*addres
             TTObject aXmlHandler(kTTSym_XmlHandler);
             
             // read the file to setup TTModularApplications
+            setNamespaceRebuilding(deviceName, true);
+            clearValueCache(deviceName);
             aXmlHandler.set(kTTSym_object, anApplication);
             aXmlHandler.send(kTTSym_Read, namespaceFilePath, none);
+            setNamespaceRebuilding(deviceName, false);
             
             return 0;
         }
@@ -3004,13 +4798,18 @@ Engine::loadNetworkNamespace(const string &deviceName, const string &filepath)
     TTValue     out;
     TTErr       err;
     
+    // the mirrors are going to be replaced
+    clearValueCache(deviceName);
+    
     // create a TTXmlHandler
     TTObject aXmlHandler(kTTSym_XmlHandler);
     
     // read the file to setup an application
+    setNamespaceRebuilding(deviceName, true);
     aXmlHandler.set(kTTSym_object, anApplication);
     
     err = aXmlHandler.send(kTTSym_Read, TTSymbol(filepath), out);
+    setNamespaceRebuilding(deviceName, false);
     
     if (!err) {
         
@@ -3018,7 +4817,10 @@ Engine::loadNetworkNamespace(const string &deviceName, const string &filepath)
         m_applicationManager.send("ProtocolStop", TTSymbol("OSC"), out);
     
         // init the application
-        anApplication.send("Init");
+        {
+            std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+            anApplication.send("Init");
+        }
         
         // store the namespace file for this device
         m_namespaceFilesPath[deviceName] = filepath;
@@ -3134,6 +4936,20 @@ Engine::setDeviceName(string deviceName, string newName)
     
     err = anApplication.set("name", newApplicationName);
     
+    if (!err && m_bundleDevices.erase(deviceName))
+        m_bundleDevices.insert(newName);
+    
+    if (!err) {
+        std::lock_guard<std::mutex> lock(m_outputsMutex);
+        m_outputsByDevice.erase(deviceName);
+        
+        auto budget = m_deviceBudgets.find(deviceName);
+        if (budget != m_deviceBudgets.end()) {
+            m_deviceBudgets[newName] = budget->second;
+            m_deviceBudgets.erase(deviceName);
+        }
+    }
+    
     return err != kTTErrNone;
 }
 
@@ -3273,11 +5089,13 @@ bool Engine::setDeviceLearn(std::string deviceName, bool newLearn)
         m_namespaceObserver.set("baton", baton);
         m_namespaceObserver.set("function", TTPtr(&NamespaceCallback));
         
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
         accessApplicationDirectory(applicationName)->addObserverForNotifications(kTTAdrsRoot, m_namespaceObserver);
     }
     // disable namespace observation
     else if (!newLearn && m_namespaceObserver.valid()) {
         
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
         accessApplicationDirectory(applicationName)->removeObserverForNotifications(kTTAdrsRoot, m_namespaceObserver);
         
         m_namespaceObserver = TTObject();
@@ -3324,96 +5142,36 @@ int Engine::requestNetworkNamespace(const std::string & address, std::string & n
     TTSymbol            type, service;
     TTNodeDirectoryPtr  aDirectory;
     TTNodePtr           aNode, childNode;
+    TTObject            anObject;
     TTMirrorPtr         aMirror;
     TTList              nodeList;
     TTString            s;
     TTValue             v;
     
-    // get the application directory
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
-    
-    if (!aDirectory)
-        return 0;
-    
-    // explore the directory at this address
-    // notice the tree is already built (see in initModular)
-    if (!aDirectory->getTTNode(anAddress, &aNode)) {
+    // the namespace is locked to read the node and its children only :
+    // the attributes are asked below without the lock, the value through the network
+    {
+        std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
         
-        // get object attributes
-        aMirror = TTMirrorPtr(aNode->getObject().instance());
-        if (aMirror) {
-            
-            type = aMirror->getName();
-            
-            if (type != kTTSymEmpty)
-                nodeType = type.c_str();
-            else
-                nodeType = "none";
-            
-            if (type == TTSymbol("Data")) {
-                
-                // append a service attribute
-                attributs.push_back("service");
-                
-                // get the value of the service attribute
-                if (!aMirror->getAttributeValue(TTSymbol("service"), v))
-                    service = v[0];
-                else
-                    service = TTSymbol("error");
-                
-                v.toString();
-                s = TTString(v[0]);
-                attributsValue.push_back(s.c_str());
-                
-                // for parameter data : ask the value
-                if (service == kTTSym_parameter) {
-                
-                    // append the value attribute
-                    attributs.push_back("value");
-                
-                    // get the value attribute
-                    aMirror->getAttributeValue(TTSymbol("value"), v);
-                    v.toString();
-                    s = TTString(v[0]);
-                    attributsValue.push_back(s.c_str());
-                }
-                
-                // for any data : ask the rangeBounds
-                // append the value attribute
-                attributs.push_back("rangeBounds");
-                
-                // get the value of the rangeBounds attribute
-                aMirror->getAttributeValue(TTSymbol("rangeBounds"), v);
-                    
-                v.toString();
-                s = TTString(v[0]);
-                attributsValue.push_back(s.c_str());
-            }
-            else if (type == TTSymbol("Container")) {
-                
-                // append a service attribute
-                attributs.push_back("service");
-                
-                // get the value of the service attribute
-                if (!aMirror->getAttributeValue(TTSymbol("service"), v))
-                    service = v[0];
-                else
-                    service = TTSymbol("error");
-                
-                v.toString();
-                s = TTString(v[0]);
-                attributsValue.push_back(s.c_str());
-            }
-        }
+        // get the application directory
+        aDirectory = accessNamespaceDirectory(anAddress);
+        
+        if (!aDirectory)
+            return 0;
         
-        // TODO : get attributes value
+        // explore the directory at this address
+        // notice the tree is already built (see in initModular)
+        if (aDirectory->getTTNode(anAddress, &aNode))
+            return 0;
+        
+        anObject = aNode->getObject();
         
         // get children
         aNode->getChildren(S_WILDCARD, S_WILDCARD, nodeList);
         
         // sort children
         nodeList.sort(&compareNodePriorityThenNameThenInstance);
-
+        
         // sort children in leaves and nodes
         for (nodeList.begin(); nodeList.end(); nodeList.next()) {
             
@@ -3441,15 +5199,84 @@ int Engine::requestNetworkNamespace(const std::string & address, std::string & n
             else
                 nodes.push_back(s.c_str());
         }
+    }
+    
+    // get object attributes
+    aMirror = TTMirrorPtr(anObject.instance());
+    if (aMirror) {
         
-        return 1;
+        type = aMirror->getName();
+        
+        if (type != kTTSymEmpty)
+            nodeType = type.c_str();
+        else
+            nodeType = "none";
+        
+        if (type == TTSymbol("Data")) {
+            
+            // append a service attribute
+            attributs.push_back("service");
+            
+            // get the value of the service attribute
+            if (!aMirror->getAttributeValue(TTSymbol("service"), v))
+                service = v[0];
+            else
+                service = TTSymbol("error");
+            
+            v.toString();
+            s = TTString(v[0]);
+            attributsValue.push_back(s.c_str());
+            
+            // for parameter data : ask the value
+            if (service == kTTSym_parameter) {
+            
+                // append the value attribute
+                attributs.push_back("value");
+            
+                // get the value attribute
+                aMirror->getAttributeValue(TTSymbol("value"), v);
+                v.toString();
+                s = TTString(v[0]);
+                attributsValue.push_back(s.c_str());
+            }
+            
+            // for any data : ask the rangeBounds
+            // append the value attribute
+            attributs.push_back("rangeBounds");
+            
+            // get the value of the rangeBounds attribute
+            aMirror->getAttributeValue(TTSymbol("rangeBounds"), v);
+                
+            v.toString();
+            s = TTString(v[0]);
+            attributsValue.push_back(s.c_str());
+        }
+        else if (type == TTSymbol("Container")) {
+            
+            // append a service attribute
+            attributs.push_back("service");
+            
+            // get the value of the service attribute
+            if (!aMirror->getAttributeValue(TTSymbol("service"), v))
+                service = v[0];
+            else
+                service = TTSymbol("error");
+            
+            v.toString();
+            s = TTString(v[0]);
+            attributsValue.push_back(s.c_str());
+        }
     }
     
-    return 0;
+    // TODO : get attributes value
+    
+    return 1;
 }
 
 int Engine::appendToNetWorkNamespace(const std::string & address, const std::string & service, const std::string & type, const std::string & priority, const std::string & description, const std::string & range, const std::string & clipmode, const std::string & tags)
 {
+    std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+    
     TTAddress           anAddress = toTTAddress(address);
     TTObject            anApplication = accessApplication(anAddress.getDirectory());
     TTNodeDirectoryPtr  aDirectory;
@@ -3458,7 +5285,7 @@ int Engine::appendToNetWorkNamespace(const std::string & address, const std::str
     TTValue             v, out;
     
     // get the application directory
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
+    aDirectory = accessNamespaceDirectory(anAddress);
     
     if (!aDirectory)
         return 0;
@@ -3504,13 +5331,15 @@ int Engine::appendToNetWorkNamespace(const std::string & address, const std::str
 
 int Engine::removeFromNetWorkNamespace(const std::string & address)
 {
+    std::lock_guard<std::recursive_mutex> namespaceLock(m_namespaceMutex);
+    
     TTAddress           anAddress = toTTAddress(address);
     TTNodeDirectoryPtr  aDirectory;
     TTNodePtr           aNode;
     TTObject            anObject;
     
     // get the application directory
-    aDirectory = accessApplicationDirectoryFrom(anAddress);
+    aDirectory = accessNamespaceDirectory(anAddress);
     
     if (!aDirectory)
         return 0;
@@ -3536,6 +5365,10 @@ int Engine::store(std::string filepath)
     
     m_lastProjectFilePath = TTSymbol(filepath);
     
+    // the curves are stored with the sample rates as set, not as lowered for the budget of their device
+    bool adapted = !m_nominalSampleRates.empty();
+    restoreCurveSampleRates();
+    
     // Create a TTXmlHandler
     TTObject aXmlHandler(kTTSym_XmlHandler);
     
@@ -3546,6 +5379,72 @@ int Engine::store(std::string filepath)
     // Write
     TTErr err = aXmlHandler.send(kTTSym_Write, m_lastProjectFilePath, none);
     
+    if (adapted)
+        adaptCurveSampleRates();
+    
+    return err == kTTErrNone;
+}
+
+/** the uri given to a TTXmlHandler to make it write into memory (see Engine::store) */
+#define ENGINE_MEMORY_URI "i-score-memory:project"
+
+// libxml2 output callbacks : the TTXmlHandler writes into the string given to Engine::store
+static std::string *memoryStore = nullptr;
+
+static int memoryStoreMatch(const char *uri)
+{
+    return uri && !strcmp(uri, ENGINE_MEMORY_URI);
+}
+
+static void *memoryStoreOpen(const char *uri)
+{
+    return memoryStore;
+}
+
+static int memoryStoreWrite(void *context, const char *buffer, int len)
+{
+    static_cast<std::string*>(context)->append(buffer, len);
+    return len;
+}
+
+static int memoryStoreClose(void *context)
+{
+    return 0;
+}
+
+int Engine::store(std::string filepath, std::string &xml)
+{
+    static std::once_flag registered;
+    TTValue v, none;
+    
+    // the last registered callbacks are tried first : the default ones have to be registered before
+    std::call_once(registered, [] {
+        xmlRegisterDefaultOutputCallbacks();
+        xmlRegisterOutputCallbacks(memoryStoreMatch, memoryStoreOpen, memoryStoreWrite, memoryStoreClose);
+    });
+    
+    m_lastProjectFilePath = TTSymbol(filepath);
+    
+    // the curves are stored with the sample rates as set, not as lowered for the budget of their device
+    bool adapted = !m_nominalSampleRates.empty();
+    restoreCurveSampleRates();
+    
+    // Create a TTXmlHandler
+    TTObject aXmlHandler(kTTSym_XmlHandler);
+    
+    // Pass the application manager and the main scenario object
+    v = TTValue(m_applicationManager, m_mainScenario);
+    aXmlHandler.set(kTTSym_object, v);
+    
+    // Write into memory
+    xml.clear();
+    memoryStore = &xml;
+    TTErr err = aXmlHandler.send(kTTSym_Write, TTSymbol(ENGINE_MEMORY_URI), none);
+    memoryStore = nullptr;
+    
+    if (adapted)
+        adaptCurveSampleRates();
+    
     return err == kTTErrNone;
 }
 
@@ -3702,26 +5601,20 @@ void Engine::buildEngineCaches(TTObject& scenario, TTAddress& scenarioAddress)
             timeProcess.get("endEvent", endSubScenario);
             
             // retreive the time process with the same end and start events
-            EngineCacheMapIterator it;
-            TTAddress address;
+            TTAddress       address;
+            TimeEventIndex  ctrlPointId;
+            TimeBoxId       ownerId = getTimeEventBoxId(startSubScenario, ctrlPointId);
             
-            for (it = m_timeBoxMap.begin(); it != m_timeBoxMap.end(); ++it)
+            if (ownerId != NO_ID && ctrlPointId == BEGIN_CONTROL_POINT_INDEX)
             {
-                TTObject mainProcess = it->second->object;
-                if (it->second->loop.valid())
-                    mainProcess = it->second->loop;
-                
-                TTObject start, end;
-                
-                mainProcess.get("startEvent", start);
-                mainProcess.get("endEvent", end);
+                TTObject end;
+                getMainProcess(ownerId).get("endEvent", end);
                 
                 // set the scenario as the subScenario related to this time process
-                if (start == startSubScenario && end == endSubScenario)
+                if (end == endSubScenario)
                 {
-                    it->second->subScenario = timeProcess;
-                    address = it->second->address;
-                    break;
+                    m_timeBoxMap[ownerId]->subScenario = timeProcess;
+                    address = m_timeBoxMap[ownerId]->address;
                 }
             }
             
@@ -3837,7 +5730,6 @@ void Engine::print() {
 
 void Engine::printExecutionInLinuxConsole()
 {
-#ifdef TODO_ENGINE
 	std::vector<TimeBoxId> boxesId;
     
 	getBoxesId(boxesId);
@@ -3846,13 +5738,13 @@ void Engine::printExecutionInLinuxConsole()
     
 	while(isPlaying()){
         
-		if ((getCurrentExecutionTime()/60)%2 == 0) {
+		if ((getCurrentExecutionDate()/60)%2 == 0) {
 			if (mustDisplay) {
-				std::system("clear");
+				std::cout << "\033[2J\033[H"; // clear the console
 				for (unsigned int i = 0; i < boxesId.size(); ++i) {
 					unsigned int processPercent;
                     
-					processPercent = getProcessPosition(boxesId[i]);
+					processPercent = getCurrentExecutionPosition(boxesId[i]) * 100;
                     
 					if ((processPercent > 0) && (processPercent < 99)) {
 						std::cout << "[*";
@@ -3865,7 +5757,7 @@ void Engine::printExecutionInLinuxConsole()
 							std::cout << ".";
 						}
                         
-						std::cout << "] -> (" << i << ") (" << processPercent << ")" << std::endl;
+						std::cout << "] -> (" << boxesId[i] << ") (" << processPercent << ")" << std::endl;
 					}
 				}
 				mustDisplay = false;
@@ -3873,9 +5765,8 @@ void Engine::printExecutionInLinuxConsole()
 		} else {
 			mustDisplay = true;
 		}
-		usleep(50);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
 	}
-#endif
 }
 
 #if 0
@@ -4036,7 +5927,163 @@ void NamespaceCallback(const TTValue& baton, const TTValue& value)
         engine->m_NetworkDeviceNamespaceCallback(applicationName);
 }
 
+void TransportDataValueCallback(const TTValue& baton, const TTValue& value)
+{
+    EnginePtr   engine;
+    TTSymbol    transport;
+    TTValue     v;
+	
+	// unpack baton (engine, transport)
+	engine = EnginePtr((TTPtr)baton[0]);
+    transport = baton[1];
+    
+    iscoreEngineDebug
+        TTLogMessage("Transport %s received\n", transport.c_str());
+    
+    if (engine->m_TransportDataValueCallback == nullptr)
+        return;
+    
+    // the Maquette expects an unsigned date and a float speed factor
+    if (transport == TTSymbol("StartPoint") && value.size() == 1 && value[0].type() != kTypeSymbol)
+        v = TTValue(TTUInt32(TTFloat64(value[0])));
+    
+    else if (transport == TTSymbol("Speed") && value.size() == 1 && value[0].type() != kTypeSymbol)
+        v = TTValue(TTFloat32(TTFloat64(value[0])));
+    
+    else
+        v = value;
+    
+    engine->m_TransportDataValueCallback(transport, v);
+}
+
 TTAddress Engine::toTTAddress(string networktreeAddress)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_addressCacheMutex);
+        
+        if (m_addressCacheSize == 0)
+            return convertToTTAddress(networktreeAddress);
+    }
+    
+    return toTTAddress(m_addresses->intern(networktreeAddress), networktreeAddress);
+}
+
+TTAddress Engine::toTTAddress(AddressHandle networktreeAddress)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_addressCacheMutex);
+        
+        EngineAddressesMap::iterator it = m_addressCacheIndex.find(networktreeAddress);
+        
+        if (it != m_addressCacheIndex.end()) {
+            
+            m_addressCache[it->second].referenced = true;
+            return m_addressCache[it->second].address;
+        }
+    }
+    
+    return toTTAddress(networktreeAddress, m_addresses->address(networktreeAddress));
+}
+
+TTAddress Engine::toTTAddress(AddressHandle handle, const std::string & networktreeAddress)
+{
+    TTAddress address;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_addressCacheMutex);
+        
+        EngineAddressesMap::iterator it = m_addressCacheIndex.find(handle);
+        
+        if (it != m_addressCacheIndex.end()) {
+            
+            m_addressCache[it->second].referenced = true;
+            return m_addressCache[it->second].address;
+        }
+    }
+    
+    // convert outside the lock
+    address = convertToTTAddress(networktreeAddress);
+    
+    std::lock_guard<std::mutex> lock(m_addressCacheMutex);
+    
+    if (m_addressCacheSize == 0 || handle == NO_ADDRESS || m_addressCacheIndex.count(handle))
+        return address;
+    
+    m_addresses->retain(handle);
+    
+    if (m_addressCache.size() < m_addressCacheSize) {
+        
+        m_addressCacheIndex[handle] = m_addressCache.size();
+        m_addressCache.push_back(EngineCachedAddress{handle, address, false});
+        return address;
+    }
+    
+    // the clock hand spares the addresses used since its last turn
+    while (m_addressCache[m_addressCacheHand].referenced) {
+        
+        m_addressCache[m_addressCacheHand].referenced = false;
+        m_addressCacheHand = (m_addressCacheHand + 1) % m_addressCache.size();
+    }
+    
+    EngineCachedAddress& evicted = m_addressCache[m_addressCacheHand];
+    
+    m_addressCacheIndex.erase(evicted.networktreeAddress);
+    m_addresses->release(evicted.networktreeAddress);
+    m_addressCacheIndex[handle] = m_addressCacheHand;
+    evicted = EngineCachedAddress{handle, address, false};
+    
+    m_addressCacheHand = (m_addressCacheHand + 1) % m_addressCache.size();
+    
+    return address;
+}
+
+void Engine::forgetCachedAddresses(const std::string & deviceName)
+{
+    AddressHandle device = m_addresses->find(deviceName);
+    
+    std::lock_guard<std::mutex> lock(m_addressCacheMutex);
+    
+    if (device == NO_ADDRESS)
+        return;
+    
+    // the last cached address fills the place of each forgotten one
+    for (unsigned int i = 0; i < m_addressCache.size(); ) {
+        
+        AddressHandle handle = m_addressCache[i].networktreeAddress;
+        
+        if (!m_addresses->isBelow(handle, device)) {
+            i++;
+            continue;
+        }
+        
+        m_addressCacheIndex.erase(handle);
+        m_addresses->release(handle);
+        
+        if (i + 1 < m_addressCache.size()) {
+            m_addressCache[i] = m_addressCache.back();
+            m_addressCacheIndex[m_addressCache[i].networktreeAddress] = i;
+        }
+        m_addressCache.pop_back();
+    }
+    
+    if (m_addressCacheHand >= m_addressCache.size())
+        m_addressCacheHand = 0;
+}
+
+void Engine::setAddressCacheSize(unsigned int size)
+{
+    std::lock_guard<std::mutex> lock(m_addressCacheMutex);
+    
+    for (EngineCachedAddresses::iterator it = m_addressCache.begin(); it != m_addressCache.end(); ++it)
+        m_addresses->release(it->networktreeAddress);
+    
+    m_addressCacheSize = size;
+    m_addressCache.clear();
+    m_addressCacheIndex.clear();
+    m_addressCacheHand = 0;
+}
+
+TTAddress Engine::convertToTTAddress(const std::string & networktreeAddress)
 {
     TTSymbol            temp(networktreeAddress);
     TTAddress           address(temp);
@@ -4063,3 +6110,36 @@ std::string Engine::toNetworkTreeAddress(TTAddress aTTAddress)
     
     return s;
 }
+
+void CachedValueCallback(const TTValue& baton, const TTValue& value)
+{
+    EnginePtr               engine;
+    TTSymbol                deviceName;
+    AddressHandle           address;
+    TTValue                 v = value;
+    TTString                s;
+	
+	// unpack baton (engine, device name, address)
+	engine = EnginePtr((TTPtr)baton[0]);
+    deviceName = baton[1];
+    address = TTUInt32(baton[2]);
+    
+    v.toString();
+    s = TTString(v[0]);
+    
+    // called from the network threads : the entry may have been cleared meanwhile
+    std::lock_guard<std::mutex> lock(engine->m_valueCacheMutex);
+    
+    EngineDevicesValuesMap::iterator device = engine->m_valueCacheMap.find(deviceName.c_str());
+    
+    if (device == engine->m_valueCacheMap.end())
+        return;
+    
+    EngineValuesMap::iterator it = device->second.find(address);
+    
+    if (it != device->second.end()) {
+        
+        it->second->value = s.c_str();
+        it->second->date = std::chrono::steady_clock::now();
+    }
+}
@@ -58,7 +58,9 @@
 #include "Relation.hpp"
 #include "TriggerPoint.hpp"
 #include "ConditionalRelation.hpp"
+#include "UndoCommands.hpp"
 #include <algorithm>
+#include <climits>
 #include <QTextStream>
 #include "AttributesEditor.hpp"
 #include "NetworkTree.hpp"
@@ -83,6 +85,9 @@ typedef map<unsigned int, TriggerPoint*> TrgPntMap;
 
 #define MUTE_GOTO_SCORE
 
+const int Maquette::UNDO_LIMIT = 200;
+const unsigned int Maquette::RESCALE_BATCH = 100;
+
 void
 Maquette::init()
 {
@@ -96,7 +101,7 @@ Maquette::init()
     // note : this is a temporary solution to test new Score framework easily
     delete _engines;
         
-    _engines = new Engine(&triggerPointIsActiveCallback, &boxIsRunningCallback, &transportCallback, &deviceCallback, &deviceConnectionErrorCallback, jamomaFolder);
+    _engines = new Engine(&triggerPointIsActiveCallback, &boxIsRunningCallback, &transportCallback, &deviceCallback, &deviceConnectionErrorCallback, &cachedValueReadCallback, jamomaFolder);
 	
 	connect(this, SIGNAL(boxIsRunningSignal(uint,bool)),
 			this, SLOT(boxIsRunningSlot(uint,bool)), Qt::QueuedConnection);
@@ -118,10 +123,19 @@ Maquette::init()
 
     ParentBox *scenarioBox = new ParentBox(scenarioAb, _scene);
     _boxes[ROOT_BOX_ID] = scenarioBox;
+
+    // commands refer to boxes and relations of the previous score
+    _undoStack->clear();
 }
 
 Maquette::Maquette() : _engines(nullptr)
 {
+    _undoStack = new QUndoStack(this);
+    _undoStack->setUndoLimit(UNDO_LIMIT);
+
+    _messagesComputer = new MessagesComputer(this);
+    connect(_messagesComputer, &MessagesComputer::computed, this, &Maquette::messagesComputed);
+
     QTimer *timer = new QTimer(this);
     connect(timer, SIGNAL(timeout()), this, SLOT(updateNamespaceTree()));
     timer->start(200);
@@ -374,6 +388,11 @@ vector<string> Maquette::requestNetworkSnapShot(const string &address)
   return _engines->requestNetworkSnapShot(address);
 }
 
+map<string, string> Maquette::requestNetworkSnapShot(const vector<string> &addresses)
+{
+  return _engines->requestNetworkSnapShot(addresses);
+}
+
 vector<string>
 Maquette::firstMessagesToSend(unsigned int boxID)
 {
@@ -402,115 +421,136 @@ Maquette::lastMessagesToSend(unsigned int boxID)
 void
 Maquette::updateCurves(unsigned int boxID, const vector<string> &startMsgs, const vector<string> &endMsgs)
 {
-  //QMap<address,value>
-  QMap<string, string> startMessages;
-  QMap<string, string> endMessages;
-  vector<string> curvesAddresses = getCurvesAddresses(boxID);
+  vector<string> curvesToAdd, curvesToRemove;
 
+  MessagesComputer::detectCurves(startMsgs, endMsgs, getCurvesAddresses(boxID), curvesToAdd, curvesToRemove);
+  applyCurvesChanges(boxID, curvesToAdd, curvesToRemove);
+}
+
+void
+Maquette::applyCurvesChanges(unsigned int boxID, const vector<string> &curvesToAdd, const vector<string> &curvesToRemove)
+{
   vector<string>::const_iterator it;
-  string currentMsg;
-  string currentAddress;
-  string currentValue;
-
-  /************  init start messages (QMap)  ************/
-  for (it = startMsgs.begin(); it != startMsgs.end(); ++it) {
-      size_t blankPos;
-      currentMsg = *it;
-      if ((blankPos = it->find_first_of(" ")) != string::npos) {
-          currentAddress = currentMsg.substr(0, blankPos);
-          if (blankPos != currentMsg.size()) {
-              currentValue = currentMsg.substr(blankPos + 1, currentMsg.size());
-            }
-        }
-      startMessages.insert(currentAddress, currentValue);
-    }
 
-  /************  init end messages (QMap)  ************/
-  for (it = endMsgs.begin(); it != endMsgs.end(); ++it) {
-      size_t blankPos;
-      currentMsg = *it;
-      if ((blankPos = it->find_first_of(" ")) != string::npos) {
-          currentAddress = currentMsg.substr(0, blankPos);
-          if (blankPos != currentMsg.size()) {
-              currentValue = currentMsg.substr(blankPos + 1, currentMsg.size());
-            }
-        }
-      endMessages.insert(currentAddress, currentValue);
-      std::cout<<"Insert "<<currentAddress<<std::endl;
-    }
+  /************  addCurve if start and end messages have the same address and different values ************/
+  for (it = curvesToAdd.begin(); it != curvesToAdd.end(); ++it) {
+      _engines->addCurve(boxID, *it);
+      _engines->setCurveSampleRate(boxID, *it, CURVE_SAMPLE_RATE);
 
+      getBox(boxID)->addCurve(*it);
+    }
 
+  for (it = curvesToRemove.begin(); it != curvesToRemove.end(); ++it) {
+      _engines->removeCurve(boxID, *it);
+    }
 
+  /************    Pour le cas open file   ************/
+  vector<string> curvesAddresses = getCurvesAddresses(boxID);
+  for (it = curvesAddresses.begin(); it != curvesAddresses.end(); ++it) {
+      getBox(boxID)->addCurveAddress(*it);
+    }
+}
 
-  /************  addCurve if endAddress contains startAddress && endValue != startValue ************/
-  QList<string> startAddresses = startMessages.keys();
-  QList<string>::iterator startAddressIt;
+bool
+Maquette::setMessagesToSendInBackground(unsigned int boxID, unsigned int controlPoint, NetworkMessages *messages)
+{
+  BasicBox *box = getBox(boxID);
+  if (boxID == NO_ID || box == nullptr) {
+      return false;
+    }
 
-  for (startAddressIt = startAddresses.begin(); startAddressIt != startAddresses.end(); ++startAddressIt) {
-      string address = *startAddressIt;
-      if (endMessages.contains(address)) {
-          if (std::find(curvesAddresses.begin(), curvesAddresses.end(), address) == curvesAddresses.end() && startMessages.value(address) != endMessages.value(address)) {
+  QMap<QTreeWidgetItem *, Message> oldMessages;
+  forgetSortedMessages(boxID, controlPoint);
+  if (controlPoint == BEGIN_CONTROL_POINT_INDEX) {
+      oldMessages = box->startMessages()->getMessages();
+      box->setStartMessages(messages);
+    }
+  else {
+      oldMessages = box->endMessages()->getMessages();
+      box->setEndMessages(messages);
+    }
 
-              _engines->addCurve(boxID, address);
-              _engines->setCurveSampleRate(boxID, address, 40);
-              
-              getBox(boxID)->addCurve(address);
-            }
-        }
-      else {
-          if (std::find(curvesAddresses.begin(), curvesAddresses.end(), address) != curvesAddresses.end()) {
+  if (_recordUndo && oldMessages != messages->getMessages()) {
+      _undoStack->push(new BoxMessagesCommand(boxID, controlPoint, oldMessages, messages->getMessages()));
+    }
 
-              _engines->removeCurve(boxID, address);
+  // the job only gets copies : the items are read here, on the GUI thread
+  MessagesJob job;
+  job.boxID = boxID;
+  job.startMessages = box->startMessages()->getMessages();
+  job.endMessages = box->endMessages()->getMessages();
+  job.curvesAddresses = getCurvesAddresses(boxID);
 
-            }
+  // the unchanged extremity is usually sorted already : the others are kept until the result is delivered
+  unsigned int revision = prioritiesRevision();
+  job.startIsSorted = findSortedMessages(boxID, BEGIN_CONTROL_POINT_INDEX, job.sortedStartMessages);
+  if (!job.startIsSorted) {
+      job.priorities = itemsPriorities(job.startMessages);
+      _sortedMessages[std::make_pair(boxID, BEGIN_CONTROL_POINT_INDEX)] = {vector<string>(), revision, false};
+    }
+  job.endIsSorted = findSortedMessages(boxID, END_CONTROL_POINT_INDEX, job.sortedEndMessages);
+  if (!job.endIsSorted) {
+      QMap<QTreeWidgetItem *, unsigned int> endPriorities = itemsPriorities(job.endMessages);
+      for (QMap<QTreeWidgetItem *, unsigned int>::const_iterator it = endPriorities.begin(); it != endPriorities.end(); ++it) {
+          job.priorities.insert(it.key(), it.value());
         }
+      _sortedMessages[std::make_pair(boxID, END_CONTROL_POINT_INDEX)] = {vector<string>(), revision, false};
     }
 
-  /************  addCurve if startAddress contains endAddress && endValue != startValue ************/
-  QList<string> endAddresses = endMessages.keys();
-  QList<string>::iterator endAddressIt;
+  _messagesComputer->compute(job);
 
-  for (endAddressIt = endAddresses.begin(); endAddressIt != endAddresses.end(); ++endAddressIt) {
-      string address = *endAddressIt;
-      if (startMessages.contains(address)) {
-          if (std::find(curvesAddresses.begin(), curvesAddresses.end(), address) == curvesAddresses.end() && startMessages.value(address) != endMessages.value(address)) {
+  return true;
+}
 
-              _engines->addCurve(boxID, address);
-              _engines->setCurveSampleRate(boxID, address, 40);
-              
-              getBox(boxID)->addCurve(address);
-            }
-        }
-      else {
-          if (std::find(curvesAddresses.begin(), curvesAddresses.end(), address) != curvesAddresses.end()) {
+void
+Maquette::messagesComputed(const MessagesResult &result)
+{
+  if (getBox(result.boxID) == nullptr) {
+      return;
+    }
 
-              _engines->removeCurve(boxID, address);
+  _engines->setCtrlPointMessagesToSend(result.boxID, BEGIN_CONTROL_POINT_INDEX, result.startMessages);
+  _engines->setCtrlPointMessagesToSend(result.boxID, END_CONTROL_POINT_INDEX, result.endMessages);
 
-            }
-        }
+  // a delivered result comes from the last job of the box : it fills the sorts it left pending
+  map<pair<unsigned int, unsigned int>, SortedMessages>::iterator it = _sortedMessages.find(std::make_pair(result.boxID, BEGIN_CONTROL_POINT_INDEX));
+  if (it != _sortedMessages.end() && !it->second.isSorted) {
+      it->second.sorted = result.startMessages;
+      it->second.isSorted = true;
     }
+  it = _sortedMessages.find(std::make_pair(result.boxID, END_CONTROL_POINT_INDEX));
+  if (it != _sortedMessages.end() && !it->second.isSorted) {
+      it->second.sorted = result.endMessages;
+      it->second.isSorted = true;
+    }
+  applyCurvesChanges(result.boxID, result.curvesToAdd, result.curvesToRemove);
 
-  /************    Pour le cas open file   ************/
-  curvesAddresses = getCurvesAddresses(boxID);
-  for (it = curvesAddresses.begin(); it != curvesAddresses.end(); ++it) {
-      currentMsg = *it;
-      getBox(boxID)->addCurveAddress(currentMsg);
-      if (startMessages.contains(currentMsg)) {
-          startMessages.remove(currentMsg);
-        }
-      if (endMessages.contains(currentMsg)) {
-          endMessages.remove(currentMsg);
-        }
+  emit boxMessagesComputed(result.boxID);
+}
+
+void
+Maquette::cancelMessagesComputation(unsigned int boxID, unsigned int controlPoint)
+{
+  if (!_messagesComputer->cancel(boxID)) {
+      return;
     }
 
+  // the abandoned job was going to send the other extremity messages too
+  if (controlPoint == BEGIN_CONTROL_POINT_INDEX) {
+      _engines->setCtrlPointMessagesToSend(boxID, END_CONTROL_POINT_INDEX, sortByPriority(boxID, END_CONTROL_POINT_INDEX, _boxes[boxID]->endMessages()->getMessages()));
+    }
+  else {
+      _engines->setCtrlPointMessagesToSend(boxID, BEGIN_CONTROL_POINT_INDEX, sortByPriority(boxID, BEGIN_CONTROL_POINT_INDEX, _boxes[boxID]->startMessages()->getMessages()));
+    }
 }
 
 bool
 Maquette::setStartMessagesToSend(unsigned int boxID, NetworkMessages *messages, bool sort)
 {
     vector<string> firstMsgs;
+    forgetSortedMessages(boxID, BEGIN_CONTROL_POINT_INDEX);
     if(sort){
-        firstMsgs = sortByPriority(messages);
+        firstMsgs = sortByPriority(boxID, BEGIN_CONTROL_POINT_INDEX, messages->getMessages());
     }
     else
         firstMsgs = messages->computeMessages();
@@ -518,9 +558,17 @@ Maquette::setStartMessagesToSend(unsigned int boxID, NetworkMessages *messages,
   //sortByPriority(firstMsgs);
 
   if (boxID != NO_ID && (getBox(boxID) != nullptr)) {
+      cancelMessagesComputation(boxID, BEGIN_CONTROL_POINT_INDEX);
+
+      QMap<QTreeWidgetItem *, Message> oldMessages = _boxes[boxID]->startMessages()->getMessages();
+
       _engines->setCtrlPointMessagesToSend(boxID, BEGIN_CONTROL_POINT_INDEX, firstMsgs);
       _boxes[boxID]->setStartMessages(messages);
 
+      if (_recordUndo && oldMessages != messages->getMessages()) {
+          _undoStack->push(new BoxMessagesCommand(boxID, BEGIN_CONTROL_POINT_INDEX, oldMessages, messages->getMessages()));
+        }
+
       vector<string> lastMsgs;
       _engines->getCtrlPointMessagesToSend(boxID, END_CONTROL_POINT_INDEX, lastMsgs);
       updateCurves(boxID, firstMsgs, lastMsgs);
@@ -547,60 +595,60 @@ Maquette::getAbsoluteAddress(QTreeWidgetItem *item){
     return _scene->editor()->networkTree()->getAbsoluteAddress(item);
 }
 
-int
-Maquette::compareByPriority(const QPair<QTreeWidgetItem *, std::string> v1, const QPair<QTreeWidgetItem *, std::string> v2)
+QMap<QTreeWidgetItem *, unsigned int>
+Maquette::itemsPriorities(const QMap<QTreeWidgetItem *, Message> &messages) const
 {
-    QString                     name1 = QString::fromStdString(v1.second),
-                                name2 = QString::fromStdString(v2.second);
-    QTreeWidgetItem             *item1 = v1.first,
-                                *item2 = v2.first;
-    unsigned int                priority1,
-                                priority2;
+  NetworkTree *networkTree = _scene->editor()->networkTree();
+
+  // only the items with a priority : the other ones are sent last
+  QMap<QTreeWidgetItem *, unsigned int> priorities;
+  for (QMap<QTreeWidgetItem *, Message>::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+      unsigned int priority = networkTree->priorityKey(it.key());
+      if (priority != UINT_MAX) {
+          priorities.insert(it.key(), priority);
+        }
+    }
 
-    //Gets priority
-    std::istringstream issPriority1(item1->text(NetworkTree::PRIORITY_COLUMN).toStdString());
-    issPriority1 >> priority1;
+  return priorities;
+}
 
-    std::istringstream issPriority2(item2->text(NetworkTree::PRIORITY_COLUMN).toStdString());
-    issPriority2 >> priority2;
+unsigned int
+Maquette::prioritiesRevision() const
+{
+  return _scene->editor()->networkTree()->prioritiesRevision();
+}
 
-    //Begin compare cases
-    if (priority1 == priority2){
-        /// \todo : Gérer le cas où name1==name2. Comparer alors les instances. NH
-        return name1 < name2;
+bool
+Maquette::findSortedMessages(unsigned int boxID, unsigned int controlPoint, vector<string> &sorted)
+{
+  map<pair<unsigned int, unsigned int>, SortedMessages>::const_iterator it = _sortedMessages.find(std::make_pair(boxID, controlPoint));
+  if (it == _sortedMessages.end() || !it->second.isSorted || it->second.prioritiesRevision != prioritiesRevision()) {
+      return false;
     }
 
-    if (priority1 == 0)
-        return 0; //true
-
-    if(priority2 == 0)
-        return 1; //false
+  sorted = it->second.sorted;
+  return true;
+}
 
-    return priority1 < priority2;
+void
+Maquette::forgetSortedMessages(unsigned int boxID, unsigned int controlPoint)
+{
+  _sortedMessages.erase(std::make_pair(boxID, controlPoint));
 }
 
 vector<string>
-Maquette::sortByPriority(NetworkMessages *messages){
-    vector<string>                              sortedMessages;
-    QPair<QTreeWidgetItem *, std::string>       pair; //<item, absoluteAddress>
-    QList<QTreeWidgetItem *>                    itemsList = messages->getItems();
-    QList< QPair<QTreeWidgetItem *,string> >    pairsList;
-
-    //Make pairs list <item, address>
-    for(int i=0 ; i<itemsList.size() ; i++)
-    {
-        pair = qMakePair( itemsList.at(i), messages->computeMessage(messages->getMessage(itemsList.at(i))));
-        pairsList << pair;
-    }
-
-    //Sort list
-    qSort(pairsList.begin(), pairsList.end(), compareByPriority);
+Maquette::sortByPriority(unsigned int boxID, unsigned int controlPoint, const QMap<QTreeWidgetItem *, Message> &messages)
+{
+  vector<string> sorted;
+  if (!findSortedMessages(boxID, controlPoint, sorted)) {
+      sorted = MessagesComputer::sortByPriority(messages, itemsPriorities(messages));
 
-    //convert to vector<string>
-    for(int i=0 ; i<pairsList.size() ; i++)
-        sortedMessages.push_back(pairsList.at(i).second);
+      if (boxID != NO_ID && getBox(boxID) != nullptr) {
+          _sortedMessages[std::make_pair(boxID, controlPoint)] = {sorted, prioritiesRevision(), true};
+        }
+    }
 
-    return sortedMessages;
+  return sorted;
 }
 
 bool
@@ -651,6 +699,7 @@ bool
 Maquette::setStartMessages(unsigned int boxID, NetworkMessages* nm)
 {
   if (boxID != NO_ID && (getBox(boxID) != nullptr)) {
+      forgetSortedMessages(boxID, BEGIN_CONTROL_POINT_INDEX);
       _boxes[boxID]->setStartMessages(nm);
       return true;
     }
@@ -661,6 +710,7 @@ bool
 Maquette::setEndMessages(unsigned int boxID, NetworkMessages* nm)
 {
   if (boxID != NO_ID && (getBox(boxID) != nullptr)) {
+      forgetSortedMessages(boxID, END_CONTROL_POINT_INDEX);
       _boxes[boxID]->setEndMessages(nm);
       return true;
     }
@@ -683,16 +733,25 @@ bool
 Maquette::setEndMessagesToSend(unsigned int boxID, NetworkMessages *messages, bool sort)
 {  
   vector<string> lastMsgs;
+  forgetSortedMessages(boxID, END_CONTROL_POINT_INDEX);
   if(sort){
-      lastMsgs = sortByPriority(messages);
+      lastMsgs = sortByPriority(boxID, END_CONTROL_POINT_INDEX, messages->getMessages());
   }
   else
       lastMsgs = messages->computeMessages();
 
   if (boxID != NO_ID && (getBox(boxID) != nullptr)) {
+      cancelMessagesComputation(boxID, END_CONTROL_POINT_INDEX);
+
+      QMap<QTreeWidgetItem *, Message> oldMessages = _boxes[boxID]->endMessages()->getMessages();
+
       _engines->setCtrlPointMessagesToSend(boxID, END_CONTROL_POINT_INDEX, lastMsgs);
       _boxes[boxID]->setEndMessages(messages);
 
+      if (_recordUndo && oldMessages != messages->getMessages()) {
+          _undoStack->push(new BoxMessagesCommand(boxID, END_CONTROL_POINT_INDEX, oldMessages, messages->getMessages()));
+        }
+
       vector<string> firstMsgs;
       _engines->getCtrlPointMessagesToSend(boxID, BEGIN_CONTROL_POINT_INDEX, firstMsgs);
       updateCurves(boxID, firstMsgs, lastMsgs);
@@ -744,6 +803,10 @@ Maquette::removeBox(unsigned int boxID)
             }
         }
 
+      _messagesComputer->cancel(boxID);
+      forgetSortedMessages(boxID, BEGIN_CONTROL_POINT_INDEX);
+      forgetSortedMessages(boxID, END_CONTROL_POINT_INDEX);
+      _boxesToRescale.erase(boxID);
       _engines->removeBox(boxID);
 
       BoxesMap::iterator it2 = _boxes.find(boxID);
@@ -777,68 +840,61 @@ bool
 Maquette::updateBox(unsigned int boxID, const Coords &coord)
 {
     //  std::cout<<"--- updateBox ---"<<std::endl;
-    bool moveAccepted = false;
-    vector<unsigned int> moved;
-    vector<unsigned int>::iterator it;
-    int boxBeginTime;
-    if (boxID != NO_ID && boxID != ROOT_BOX_ID) {
-        BasicBox *box = _boxes[boxID];
-        
-        if ((moveAccepted = _engines->performBoxEditing(boxID, coord.topLeftX * MaquetteScene::MS_PER_PIXEL,
-                                                       coord.topLeftX * MaquetteScene::MS_PER_PIXEL +
-                                                       coord.sizeX * MaquetteScene::MS_PER_PIXEL, moved))) {
-
-            _engines->setBoxVerticalPosition(boxID, coord.topLeftY);
-            _engines->setBoxVerticalSize(boxID, coord.sizeY);
-            box->setRelativeTopLeft(QPoint((int)coord.topLeftX, (int)coord.topLeftY));
-            box->setSize(QPoint((int)coord.sizeX, (int)coord.sizeY));
-            box->setPos(box->getCenter());
-            box->update();
-        }
-        
-        else {
-            
-            boxBeginTime = (_engines->getBoxBeginTime(boxID) / (float)MaquetteScene::MS_PER_PIXEL);
-            
-            _engines->setBoxVerticalPosition(boxID, box->getTopLeft().y());
-            _engines->setBoxVerticalSize(boxID, box->getSize().y());
-            
-            box->setRelativeTopLeft(QPoint(boxBeginTime, box->getTopLeft().y()));
-            box->setSize(QPoint((_engines->getBoxEndTime(boxID) / (float)MaquetteScene::MS_PER_PIXEL - boxBeginTime), box->getSize().y()));
-            box->setPos(box->getCenter());
-            box->update();
-#ifdef DEBUG
-            std::cerr << "Maquette::updateBox : Move refused by Engines" << std::endl;
-#endif
-        }
+    if (_previewing) {
+        return previewBox(boxID, coord);
     }
 
+    // a single move is a transaction too : only the boxes it moves are read back from the Engines
+    if (!_collectBoxesMove) {
+        beginBoxesMove();
+        bool moveAccepted = updateBox(boxID, coord);
+        return endBoxesMove() && moveAccepted;
+    }
 
-  if (moveAccepted) {
-      for (it = moved.begin(); it != moved.end(); it++) {
-#ifdef DEBUG
-          std::cerr << "Maquette::updateBoxes : box moved : " << *it << std::endl;
-#endif
-          if(_boxes[*it]->ID() != boxID){
-          if ((_boxes[*it]->relativeBeginPos() != _engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL ||
-               (_engines->getBoxEndTime(*it) / MaquetteScene::MS_PER_PIXEL - _engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL) != _boxes[*it]->width()) && _engines->getBoxBeginTime(*it)) {
-
-              boxBeginTime = (_engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL);
-              _boxes[*it]->setRelativeTopLeft(QPoint(boxBeginTime , _boxes[*it]->getTopLeft().y()));
-              _boxes[*it]->setSize(QPoint((_engines->getBoxEndTime(*it) / MaquetteScene::MS_PER_PIXEL -
-                                           boxBeginTime),
-                                          _boxes[*it]->getSize().y()));
-              _boxes[*it]->setPos(_boxes[*it]->getCenter());
-              _boxes[*it]->update();
-
-//              std::cout<<"i-score : BOX"<< _boxes[*it]->ID()<<" "<<boxBeginTime<<" ------ OK"<<std::endl;
-//              std::cout<<"other boxes ("<<_boxes[*it]->ID()<<" "<<_engines->getBoxBeginTime(*it)<<" "<<_engines->getBoxEndTime(*it) - _engines->getBoxBeginTime(*it)<<")"<<std::endl;
-            }
-        }
+    BoxPlacement placement;
+    placement.begin = coord.topLeftX * MaquetteScene::MS_PER_PIXEL;
+    placement.end = coord.topLeftX * MaquetteScene::MS_PER_PIXEL + coord.sizeX * MaquetteScene::MS_PER_PIXEL;
+    placement.topLeftY = coord.topLeftY;
+    placement.sizeY = coord.sizeY;
+
+    if (!updateBox(boxID, placement)) {
+        return false;
+    }
+
+    BasicBox *box = _boxes[boxID];
+    box->setRelativeTopLeft(QPoint((int)coord.topLeftX, (int)coord.topLeftY));
+    box->setSize(QPoint((int)coord.sizeX, (int)coord.sizeY));
+    box->setPos(box->getCenter());
+    box->update();
+
+    return true;
 }
+
+bool
+Maquette::updateBox(unsigned int boxID, const BoxPlacement &placement)
+{
+  BasicBox *box = getBox(boxID);
+  if (box == nullptr || boxID == ROOT_BOX_ID) {
+      return false;
     }
-//  std::cout<<std::endl;
-  return moveAccepted;
+
+  // the Engines keep the dates before the transaction until it is committed
+  recordBoxBefore(boxID, enginesPlacement(boxID));
+
+  vector<unsigned int> moved;
+  if (_engines->performBoxEditing(boxID, placement.begin, placement.end, moved)) {
+      // in a transaction the vertical position is only kept if the whole move is accepted
+      _collectedBoxes[boxID] = placement;
+      return true;
+    }
+
+  TimeValue boxBeginTime = _engines->getBoxBeginTime(boxID);
+  placeBox(box, boxBeginTime, _engines->getBoxEndTime(boxID) - boxBeginTime);
+  box->update();
+#ifdef DEBUG
+  std::cerr << "Maquette::updateBox : Move refused by Engines" << std::endl;
+#endif
+  return false;
 }
 
 bool
@@ -860,12 +916,8 @@ Maquette::updateBoxes(const map<unsigned int, Coords> &boxes)
               curBox->update();
             }
           else {
-              curBox->setRelativeTopLeft(QPoint(_engines->getBoxBeginTime(it->first) / MaquetteScene::MS_PER_PIXEL,
-                                                curBox->getTopLeft().y()));
-              curBox->setSize(QPoint((_engines->getBoxEndTime(it->first) / MaquetteScene::MS_PER_PIXEL -
-                                      _engines->getBoxBeginTime(it->first) / MaquetteScene::MS_PER_PIXEL),
-                                     curBox->getSize().y()));
-              curBox->setPos(curBox->getCenter());
+              TimeValue date = _engines->getBoxBeginTime(it->first);
+              placeBox(curBox, date, _engines->getBoxEndTime(it->first) - date);
               curBox->update();
 #ifdef DEBUG
               std::cerr << "Maquette::updateBoxes : Move refused by Engines" << std::endl;
@@ -879,14 +931,8 @@ Maquette::updateBoxes(const map<unsigned int, Coords> &boxes)
 #ifdef DEBUG
           std::cerr << "Maquette::updateBoxes : box moved : " << *it2 << std::endl;
 #endif
-          if (_boxes[*it2]->relativeBeginPos() != _engines->getBoxBeginTime(*it2) / MaquetteScene::MS_PER_PIXEL ||
-              (_engines->getBoxEndTime(*it2) / MaquetteScene::MS_PER_PIXEL - _engines->getBoxBeginTime(*it2) / MaquetteScene::MS_PER_PIXEL) != _boxes[*it2]->width()) {
-              _boxes[*it2]->setRelativeTopLeft(QPoint(_engines->getBoxBeginTime(*it2) / MaquetteScene::MS_PER_PIXEL,
-                                                      _boxes[*it2]->getTopLeft().y()));
-              _boxes[*it2]->setSize(QPoint((_engines->getBoxEndTime(*it2) / MaquetteScene::MS_PER_PIXEL -
-                                            _engines->getBoxBeginTime(*it2) / MaquetteScene::MS_PER_PIXEL),
-                                           _boxes[*it2]->getSize().y()));
-              _boxes[*it2]->setPos(_boxes[*it2]->getCenter());
+          TimeValue date = _engines->getBoxBeginTime(*it2);
+          if (placeBox(_boxes[*it2], date, _engines->getBoxEndTime(*it2) - date)) {
               _boxes[*it2]->update();
             }
         }
@@ -1105,7 +1151,7 @@ void
 Maquette::addCurve(unsigned int boxID, const string &address)
 {
     _engines->addCurve(boxID, address);
-    _engines->setCurveSampleRate(boxID, address, 40);
+    _engines->setCurveSampleRate(boxID, address, CURVE_SAMPLE_RATE);
 }
 
 void
@@ -1243,18 +1289,15 @@ void
 Maquette::updateBoxesFromEngines(const vector<unsigned int> &movedBoxes)
 {
   vector<unsigned int>::const_iterator it;
-  if (!movedBoxes.empty()) {
-      for (it = movedBoxes.begin(); it != movedBoxes.end(); it++) {
-          if ((_boxes[*it]->relativeBeginPos() != _engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL ||
-               (_engines->getBoxEndTime(*it) / MaquetteScene::MS_PER_PIXEL - _engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL) != _boxes[*it]->width())) {
-              _boxes[*it]->setRelativeTopLeft(QPoint(_engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL,
-                                                     _boxes[*it]->getTopLeft().y()));
-              _boxes[*it]->setSize(QPoint((_engines->getBoxEndTime(*it) / MaquetteScene::MS_PER_PIXEL -
-                                           _engines->getBoxBeginTime(*it) / MaquetteScene::MS_PER_PIXEL),
-                                          _boxes[*it]->getSize().y()));
-              _boxes[*it]->setPos(_boxes[*it]->getCenter());
-              _boxes[*it]->update();
-            }
+  for (it = movedBoxes.begin(); it != movedBoxes.end(); it++) {
+      BasicBox *box = getBox(*it);
+      if (box == nullptr || *it == ROOT_BOX_ID) {
+          continue;
+        }
+
+      TimeValue date = _engines->getBoxBeginTime(*it);
+      if (placeBox(box, date, _engines->getBoxEndTime(*it) - date)) {
+          box->update();
         }
     }
 }
@@ -1268,18 +1311,154 @@ Maquette::updateBoxesFromEngines()
           _scene->view()->resetCachedContent();
       }
       else{
-          it->second->setRelativeTopLeft(QPoint(_engines->getBoxBeginTime(it->first) / MaquetteScene::MS_PER_PIXEL,
-                                                it->second->getTopLeft().y()));
-          it->second->setSize(QPoint((_engines->getBoxEndTime(it->first) / MaquetteScene::MS_PER_PIXEL -
-                                      _engines->getBoxBeginTime(it->first) / MaquetteScene::MS_PER_PIXEL),
-                                     it->second->getSize().y()));
-          it->second->setPos(it->second->getCenter());
+          TimeValue date = _engines->getBoxBeginTime(it->first);
+
+          placeBox(it->second, date, _engines->getBoxEndTime(it->first) - date);
           it->second->centerWidget();
           it->second->update();
       }
     }
 }
 
+bool
+Maquette::placeBox(BasicBox *box, TimeValue date, TimeValue duration)
+{
+  // both ends are rounded the same way : boxes ending and starting at the same date touch
+  int begin = date / MaquetteScene::MS_PER_PIXEL;
+  int end = (date + duration) / MaquetteScene::MS_PER_PIXEL;
+
+  static_cast<AbstractBox*>(box->abstract())->setDates(date, duration);
+  _boxesToRescale.erase(box->ID());
+
+  if (box->relativeBeginPos() == begin && box->width() == end - begin) {
+      return false;
+    }
+
+  box->setRelativeTopLeft(QPoint(begin, box->getTopLeft().y()));
+  box->setSize(QPoint(end - begin, box->getSize().y()));
+  box->setPos(box->getCenter());
+
+  // setRelativeTopLeft and setSize forget the dates
+  static_cast<AbstractBox*>(box->abstract())->setDates(date, duration);
+
+  return true;
+}
+
+void
+Maquette::rescaleBoxes()
+{
+  for (BoxesMap::iterator it = _boxes.begin(); it != _boxes.end(); ++it) {
+      if (it->first != ROOT_BOX_ID) {
+          _boxesToRescale.insert(it->first);
+        }
+    }
+
+  rescaleVisibleBoxes();
+
+  if (!_boxesToRescale.empty() && !_rescaleScheduled) {
+      _rescaleScheduled = true;
+      QTimer::singleShot(0, this, SLOT(rescalePendingBoxes()));
+    }
+}
+
+void
+Maquette::rescaleVisibleBoxes()
+{
+  if (_boxesToRescale.empty()) {
+      return;
+    }
+
+  // a viewport on each side, so that small scrolls show boxes already laid out
+  MaquetteView *view = _scene->view();
+  QRectF visible = view->mapToScene(view->viewport()->rect()).boundingRect();
+  visible.adjust(-visible.width(), 0, visible.width(), 0);
+
+  // the new coordinates are computed from the dates : the boxes are not laid out yet
+  vector<unsigned int> visibleBoxes;
+  std::map<unsigned int, TimeValue> absoluteDates;
+  for (unsigned int boxID : _boxesToRescale) {
+      BasicBox *box = getBox(boxID);
+      if (box == nullptr) {
+          continue;
+        }
+
+      AbstractBox *abBox = static_cast<AbstractBox*>(box->abstract());
+      TimeValue date = abBox->hasDates() ? abBox->date() : _engines->getBoxBeginTime(boxID);
+      TimeValue duration = abBox->hasDates() ? abBox->duration() : _engines->getBoxEndTime(boxID) - date;
+
+      // mothers have lower IDs : their absolute date is computed before, or read from their position if they are laid out
+      TimeValue absoluteDate = date;
+      unsigned int motherID = box->mother();
+      if (motherID != NO_ID && motherID != ROOT_BOX_ID) {
+          std::map<unsigned int, TimeValue>::iterator mother = absoluteDates.find(motherID);
+          if (mother != absoluteDates.end()) {
+              absoluteDate += mother->second;
+            }
+          else if (getBox(motherID) != nullptr) {
+              absoluteDate += getBox(motherID)->beginPos() * MaquetteScene::MS_PER_PIXEL;
+            }
+        }
+      absoluteDates[boxID] = absoluteDate;
+
+      QRectF boxRect = box->sceneBoundingRect();
+      if (absoluteDate / MaquetteScene::MS_PER_PIXEL <= visible.right() && (absoluteDate + duration) / MaquetteScene::MS_PER_PIXEL >= visible.left()
+          && boxRect.top() <= visible.bottom() && boxRect.bottom() >= visible.top()) {
+          visibleBoxes.push_back(boxID);
+        }
+    }
+
+  for (unsigned int boxID : visibleBoxes) {
+      rescaleBox(boxID);
+    }
+}
+
+void
+Maquette::rescalePendingBoxes()
+{
+  _rescaleScheduled = false;
+
+  for (unsigned int i = 0; i < RESCALE_BATCH && !_boxesToRescale.empty(); i++) {
+      rescaleBox(*_boxesToRescale.begin());
+    }
+
+  if (!_boxesToRescale.empty()) {
+      _rescaleScheduled = true;
+      QTimer::singleShot(0, this, SLOT(rescalePendingBoxes()));
+    }
+}
+
+void
+Maquette::flushBoxesRescale()
+{
+  while (!_boxesToRescale.empty()) {
+      rescaleBox(*_boxesToRescale.begin());
+    }
+}
+
+void
+Maquette::rescaleBox(unsigned int boxID)
+{
+  BasicBox *box = getBox(boxID);
+  if (box == nullptr) {
+      _boxesToRescale.erase(boxID);
+      return;
+    }
+
+  AbstractBox *abBox = static_cast<AbstractBox*>(box->abstract());
+  TimeValue date, duration;
+  if (abBox->hasDates()) {
+      date = abBox->date();
+      duration = abBox->duration();
+    }
+  else {
+      date = _engines->getBoxBeginTime(boxID);
+      duration = _engines->getBoxEndTime(boxID) - date;
+    }
+
+  if (placeBox(box, date, duration)) {
+      box->centerWidget();
+    }
+}
 
 int
 Maquette::addRelation(unsigned int ID1, BoxExtremity firstExtremum, unsigned int ID2,
@@ -1397,9 +1576,347 @@ Maquette::changeRelationBounds(unsigned int relID, const float &minBound, const
   if (maxBound != NO_BOUND) {
       maxBoundMS = maxBound * (MaquetteScene::MS_PER_PIXEL * _scene->zoom());
     }  
+
+  // the Engines are edited when the preview ends
+  if (_previewing) {
+      if (!_previewBounds.contains(relID)) {
+          _previewBounds[relID] = qMakePair(_engines->getRelationMinBound(relID), _engines->getRelationMaxBound(relID));
+        }
+      if (_engines->previewTemporalRelationBounds(relID, minBoundMS, maxBoundMS, movedBoxes)) {
+          updateBoxesFromEditing(movedBoxes);
+        }
+      return;
+    }
+
+  int oldMinBoundMS = _engines->getRelationMinBound(relID);
+  int oldMaxBoundMS = _engines->getRelationMaxBound(relID);
+
   _engines->changeTemporalRelationBounds(relID, minBoundMS, maxBoundMS, movedBoxes);
 
   updateBoxesFromEngines(movedBoxes);
+
+  if (_recordUndo && (oldMinBoundMS != minBoundMS || oldMaxBoundMS != maxBoundMS)) {
+      _undoStack->push(new RelationBoundsCommand(relID, oldMinBoundMS, oldMaxBoundMS, minBoundMS, maxBoundMS));
+    }
+}
+
+void
+Maquette::beginBoxesMove()
+{
+  _collectBoxesMove = true;
+  _collectedBoxes.clear();
+  _boxesBeforeMove.clear();
+  _engines->beginEditing();
+}
+
+bool
+Maquette::endBoxesMove()
+{
+  bool moveAccepted = commitBoxesMove();
+
+  // the boxes moved by the constraints are recorded with the ones moved by the user
+  if (_recordUndo) {
+      pushBoxesMove(_boxesBeforeMove);
+    }
+  _boxesBeforeMove.clear();
+
+  return moveAccepted;
+}
+
+bool
+Maquette::commitBoxesMove()
+{
+  _collectBoxesMove = false;
+
+  // constraints are solved once for the whole selection
+  vector<unsigned int> movedBoxes;
+  bool moveAccepted = _engines->commitEditing(movedBoxes);
+
+  // the boxes shifted by the constraints are still displayed where they were
+  for (unsigned int boxID : movedBoxes) {
+      BasicBox *box = getBox(boxID);
+      if (box != nullptr) {
+          recordBoxBefore(boxID, displayedPlacement(box));
+        }
+    }
+
+  for (QMap<unsigned int, BoxPlacement>::const_iterator it = _collectedBoxes.begin(); it != _collectedBoxes.end(); ++it) {
+      BasicBox *box = getBox(it.key());
+      if (box == nullptr) {
+          continue;
+        }
+      if (moveAccepted) {
+          _engines->setBoxVerticalPosition(it.key(), it.value().topLeftY);
+          _engines->setBoxVerticalSize(it.key(), it.value().sizeY);
+        }
+      else {
+          // the boxes go back where the Engines kept them
+          box->setRelativeTopLeft(QPointF(box->relativeBeginPos(), _engines->getBoxVerticalPosition(it.key())));
+          box->setSize(QPointF(box->getSize().x(), _engines->getBoxVerticalSize(it.key())));
+          box->setPos(box->getCenter());
+          box->update();
+          movedBoxes.push_back(it.key());
+        }
+    }
+  _collectedBoxes.clear();
+
+  updateBoxesFromEngines(movedBoxes);
+
+  return moveAccepted;
+}
+
+void
+Maquette::beginBoxesPreview()
+{
+  if (_previewing) {
+      return;
+    }
+  _previewing = true;
+
+  // the solver of the transaction moves the boxes while dragging, and its dates are applied on release
+  beginBoxesMove();
+}
+
+bool
+Maquette::endBoxesPreview()
+{
+  if (!_previewing) {
+      return true;
+    }
+  _previewing = false;
+
+  bool moveAccepted = commitBoxesMove();
+
+  if (_recordUndo) {
+      vector<RelationBoundsCommand*> boundsCommands;
+      for (QMap<unsigned int, QPair<int, int> >::const_iterator it = _previewBounds.begin(); it != _previewBounds.end(); ++it) {
+          if (getRelation(it.key()) == nullptr) {
+              continue;
+            }
+          int minBoundMS = _engines->getRelationMinBound(it.key());
+          int maxBoundMS = _engines->getRelationMaxBound(it.key());
+          if (minBoundMS != it.value().first || maxBoundMS != it.value().second) {
+              boundsCommands.push_back(new RelationBoundsCommand(it.key(), it.value().first, it.value().second, minBoundMS, maxBoundMS));
+            }
+        }
+
+      // the bounds are pushed first : undoing puts the boxes back before the bounds
+      bool macro = !boundsCommands.empty();
+      if (macro) {
+          _undoStack->beginMacro(QObject::tr("Edit relations and boxes"));
+        }
+      for (RelationBoundsCommand *command : boundsCommands) {
+          _undoStack->push(command);
+        }
+      pushBoxesMove(_boxesBeforeMove);
+      if (macro) {
+          _undoStack->endMacro();
+        }
+    }
+  _boxesBeforeMove.clear();
+  _previewBounds.clear();
+
+  return moveAccepted;
+}
+
+bool
+Maquette::previewBox(unsigned int boxID, const Coords &coord)
+{
+  BasicBox *box = getBox(boxID);
+  if (box == nullptr || boxID == ROOT_BOX_ID) {
+      return false;
+    }
+
+  vector<unsigned int> movedBoxes;
+  int begin = coord.topLeftX * MaquetteScene::MS_PER_PIXEL;
+  int end = begin + coord.sizeX * MaquetteScene::MS_PER_PIXEL;
+
+  recordBoxBefore(boxID, enginesPlacement(boxID));
+
+  bool moveAccepted = _engines->previewBoxEditing(boxID, begin, end, movedBoxes);
+  if (moveAccepted) {
+      // the vertical position is applied with the dates on release
+      BoxPlacement &placement = _collectedBoxes[boxID];
+      placement.begin = begin;
+      placement.end = end;
+      placement.topLeftY = coord.topLeftY;
+      placement.sizeY = coord.sizeY;
+
+      box->setRelativeTopLeft(QPoint((int)coord.topLeftX, (int)coord.topLeftY));
+      box->setSize(QPoint((int)coord.sizeX, (int)coord.sizeY));
+      box->setPos(box->getCenter());
+      box->update();
+    }
+  else {
+      // back to its last allowed dates
+      movedBoxes.push_back(boxID);
+    }
+
+  updateBoxesFromEditing(movedBoxes);
+
+  return moveAccepted;
+}
+
+void
+Maquette::updateBoxesFromEditing(const vector<unsigned int> &movedBoxes)
+{
+  for (unsigned int boxID : movedBoxes) {
+      BasicBox *box = getBox(boxID);
+      if (box == nullptr) {
+          continue;
+        }
+      recordBoxBefore(boxID, enginesPlacement(boxID));
+
+      TimeValue begin, end;
+      _engines->getEditedBoxDates(boxID, begin, end);
+      if (placeBox(box, begin, end - begin)) {
+          box->update();
+        }
+    }
+}
+
+BoxPlacement
+Maquette::enginesPlacement(unsigned int boxID)
+{
+  BoxPlacement placement;
+  placement.begin = _engines->getBoxBeginTime(boxID);
+  placement.end = _engines->getBoxEndTime(boxID);
+  placement.topLeftY = _engines->getBoxVerticalPosition(boxID);
+  placement.sizeY = _engines->getBoxVerticalSize(boxID);
+
+  return placement;
+}
+
+BoxPlacement
+Maquette::displayedPlacement(BasicBox *box) const
+{
+  BoxPlacement placement;
+  AbstractBox *abstract = static_cast<AbstractBox*>(box->abstract());
+  if (abstract->hasDates()) {
+      placement.begin = abstract->date();
+      placement.end = abstract->date() + abstract->duration();
+    }
+  else {
+      placement.begin = box->relativeBeginPos() * MaquetteScene::MS_PER_PIXEL;
+      placement.end = placement.begin + box->getSize().x() * MaquetteScene::MS_PER_PIXEL;
+    }
+  placement.topLeftY = box->getTopLeft().y();
+  placement.sizeY = box->getSize().y();
+
+  return placement;
+}
+
+void
+Maquette::recordBoxBefore(unsigned int boxID, const BoxPlacement &placement)
+{
+  if (_recordUndo && !_boxesBeforeMove.contains(boxID)) {
+      _boxesBeforeMove[boxID] = placement;
+    }
+}
+
+void
+Maquette::pushBoxesMove(const QMap<unsigned int, BoxPlacement> &before)
+{
+  QVector<BoxMoveRecord> records;
+  for (QMap<unsigned int, BoxPlacement>::const_iterator it = before.begin(); it != before.end(); ++it) {
+      if (getBox(it.key()) == nullptr) {
+          continue;
+        }
+      BoxPlacement after = enginesPlacement(it.key());
+      if (it->begin != after.begin || it->end != after.end ||
+          it->topLeftY != after.topLeftY || it->sizeY != after.sizeY) {
+          BoxMoveRecord record;
+          record.boxID = it.key();
+          record.before = it.value();
+          record.after = after;
+          records.push_back(record);
+        }
+    }
+
+  if (!records.isEmpty()) {
+      _undoStack->push(new BoxesMoveCommand(records));
+    }
+}
+
+void
+Maquette::restoreBoxes(const QMap<unsigned int, BoxPlacement> &placements)
+{
+  _recordUndo = false;
+  beginBoxesMove();
+  for (QMap<unsigned int, BoxPlacement>::const_iterator it = placements.begin(); it != placements.end(); ++it) {
+      BasicBox *box = getBox(it.key());
+      if (box == nullptr || !updateBox(it.key(), it.value())) {
+          continue;
+        }
+      // placed from the dates : the pixels of the current zoom
+      box->setRelativeTopLeft(QPointF(box->relativeBeginPos(), it->topLeftY));
+      box->setSize(QPointF(box->getSize().x(), it->sizeY));
+      placeBox(box, it->begin, it->end - it->begin);
+      box->setPos(box->getCenter());
+      box->update();
+    }
+  endBoxesMove();
+  _recordUndo = true;
+
+  _scene->update();
+  _scene->setModified(true);
+}
+
+void
+Maquette::restoreRelationBounds(unsigned int relID, int minBoundMS, int maxBoundMS)
+{
+  if (getRelation(relID) == nullptr) {
+      return;
+    }
+
+  // the scene expects bounds in pixels
+  float minBound = NO_BOUND;
+  if (minBoundMS != NO_BOUND) {
+      minBound = minBoundMS / (MaquetteScene::MS_PER_PIXEL * _scene->zoom());
+    }
+  float maxBound = NO_BOUND;
+  if (maxBoundMS != NO_BOUND) {
+      maxBound = maxBoundMS / (MaquetteScene::MS_PER_PIXEL * _scene->zoom());
+    }
+
+  _recordUndo = false;
+  _scene->changeRelationBounds(relID, NO_LENGTH, minBound, maxBound);
+  _recordUndo = true;
+
+  _scene->update();
+  _scene->setModified(true);
+}
+
+void
+Maquette::restoreMessages(unsigned int boxID, unsigned int controlPoint, const QMap<QString, Message> &messages)
+{
+  BasicBox *box = getBox(boxID);
+  if (box == nullptr) {
+      return;
+    }
+
+  // the items are found as when loading : the ones of the command may have been deleted by a refresh of the tree
+  vector<string> addresses;
+  for (const Message &message : messages) {
+      addresses.push_back(NetworkMessages::computeMessage(message));
+    }
+  NetworkMessages networkMessages;
+  networkMessages.setMessages(_scene->editor()->networkTree()->getItemsFromMsg(addresses));
+
+  _recordUndo = false;
+  if (controlPoint == BEGIN_CONTROL_POINT_INDEX) {
+      setStartMessagesToSend(boxID, &networkMessages);
+    }
+  else {
+      setEndMessagesToSend(boxID, &networkMessages);
+    }
+  _recordUndo = true;
+
+  // refresh the namespace tree if it displays this box
+  if (box->isSelected()) {
+      _scene->editor()->networkTree()->displayBoxContent(static_cast<AbstractBox*>(box->abstract()));
+    }
+  _scene->setModified(true);
 }
 
 int
@@ -1744,10 +2261,10 @@ Maquette::getNetworkHost()
   return _devices.at(_currentDevice).networkHost;
 }
 
-void
-Maquette::save(const string &fileName)
+bool
+Maquette::save(const string &fileName, string &content)
 {
-  _engines->store(fileName);
+  return _engines->store(fileName, content);
 }
 
 void
@@ -1764,6 +2281,7 @@ Maquette::load(const string &fileName)
     
     // Build the engine structure from the Xml file
     _engines->load(fileName);
+    _undoStack->clear();
     
     // Reload networkTree
     _scene->editor()->networkTree()->load();
@@ -2093,11 +2611,12 @@ transportCallback(TTSymbol& transport, const TTValue& value)
 
 	if (scene != nullptr) {
 
+		// called from a network thread : the scene is only reached through queued signals
 		if (transport == TTSymbol("Play"))
-			scene->playOrResume();
+			emit Maquette::getInstance()->playOrResumeSignal();
 
 		else if (transport == TTSymbol("Stop"))
-			scene->stopOrPause();
+			emit Maquette::getInstance()->stopOrPauseSignal();
 
 		else if (transport == TTSymbol("Pause"))
 			;
@@ -2116,7 +2635,7 @@ transportCallback(TTSymbol& transport, const TTValue& value)
 				emit Maquette::getInstance()->changeSpeedSignal(value[0]);
 		}
 
-		scene->view()->emitPlayModeChanged();
+		QMetaObject::invokeMethod(scene->view(), "emitPlayModeChanged", Qt::QueuedConnection);
 	}
 #ifdef DEBUG
 	else {
@@ -2138,6 +2657,13 @@ deviceConnectionErrorCallback(TTSymbol& deviceName, TTSymbol& errorInfo)
 	emit Maquette::getInstance()->deviceConnectionFailed(QString(deviceName.c_str()), QString(errorInfo.c_str()));
 }
 
+void
+cachedValueReadCallback(const std::string& address, const std::string& value)
+{
+    // emitted from the value reader thread : the receivers are queued
+    emit Maquette::getInstance()->valueRead(QString::fromStdString(address), QString::fromStdString(value));
+}
+
 void
 Maquette::setStartMessageToSend(unsigned int boxID, QTreeWidgetItem *item, QString address)
 {
@@ -2155,6 +2681,18 @@ Maquette::requestObjectAttribruteValue(const std::string &address, const std::st
     return _engines->requestObjectAttributeValue(address,attributeName,value);
 }
 
+bool
+Maquette::peekCachedValue(const std::string &address, std::string &value)
+{
+  return _engines->peekCachedValue(address, value);
+}
+
+void
+Maquette::prefetchValues(const std::vector<std::string> &addresses)
+{
+  _engines->prefetchCachedValues(addresses);
+}
+
 int
 Maquette::getRangeBounds(const std::string& address, std::vector<float>& rangeBounds){
     std::vector<std::string>    values;
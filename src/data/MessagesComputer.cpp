@@ -0,0 +1,232 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "MessagesComputer.hpp"
+#include "Engine.h"
+
+#include <algorithm>
+#include <climits>
+#include <set>
+
+using std::string;
+using std::vector;
+
+MessagesComputer::MessagesComputer(QObject *parent)
+  : QObject(parent), _running(NO_ID), _stop(false)
+{
+  _thread = std::thread(&MessagesComputer::run, this);
+}
+
+MessagesComputer::~MessagesComputer()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+    _jobs.clear();
+  }
+  _condition.notify_one();
+  _thread.join();
+}
+
+void
+MessagesComputer::compute(MessagesJob job)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    job.generation = ++_generations[job.boxID];
+    _jobs[job.boxID] = job;
+  }
+  _condition.notify_one();
+}
+
+bool
+MessagesComputer::cancel(unsigned int boxID)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  bool pending = _jobs.erase(boxID) > 0 || _running == boxID
+      || std::find_if(_results.begin(), _results.end(), [boxID] (const MessagesResult &result)
+                      { return result.boxID == boxID; }) != _results.end();
+
+  // the running job and the undelivered results of this box are superseded
+  ++_generations[boxID];
+
+  return pending;
+}
+
+bool
+MessagesComputer::isSuperseded(const MessagesJob &job)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return _stop || _generations[job.boxID] != job.generation;
+}
+
+void
+MessagesComputer::run()
+{
+  while (true) {
+      MessagesJob job;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this] { return _stop || !_jobs.empty(); });
+
+        if (_stop) {
+            return;
+          }
+
+        job = _jobs.begin()->second;
+        _jobs.erase(_jobs.begin());
+        _running = job.boxID;
+      }
+
+      MessagesResult result;
+      result.boxID = job.boxID;
+      result.generation = job.generation;
+
+      // each step can be long for big boxes : stop as soon as the job is superseded
+      bool superseded = false;
+      if (!(superseded = isSuperseded(job))) {
+          result.startMessages = job.startIsSorted ? job.sortedStartMessages : sortByPriority(job.startMessages, job.priorities);
+        }
+      if (!superseded && !(superseded = isSuperseded(job))) {
+          result.endMessages = job.endIsSorted ? job.sortedEndMessages : sortByPriority(job.endMessages, job.priorities);
+        }
+      if (!superseded && !(superseded = isSuperseded(job))) {
+          detectCurves(result.startMessages, result.endMessages, job.curvesAddresses, result.curvesToAdd, result.curvesToRemove);
+        }
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      _running = NO_ID;
+
+      if (!superseded) {
+          _results.push_back(result);
+          QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+        }
+    }
+}
+
+void
+MessagesComputer::deliver()
+{
+  vector<MessagesResult> results;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    results.swap(_results);
+
+    // drop the results superseded while they were waiting
+    results.erase(std::remove_if(results.begin(), results.end(), [this] (const MessagesResult &result)
+                                 { return _generations[result.boxID] != result.generation; }),
+                  results.end());
+  }
+
+  for (const auto &result : results) {
+      emit computed(result);
+    }
+}
+
+vector<string>
+MessagesComputer::sortByPriority(const QMap<QTreeWidgetItem *, Message> &messages,
+                                 const QMap<QTreeWidgetItem *, unsigned int> &priorities)
+{
+  // the messages without priority are sent last
+  typedef std::pair<unsigned int, string> SortKey;
+  vector<SortKey> keys;
+  keys.reserve(messages.size());
+
+  for (QMap<QTreeWidgetItem *, Message>::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+      keys.push_back(SortKey(priorities.value(it.key(), UINT_MAX), NetworkMessages::computeMessage(it.value())));
+    }
+
+  std::stable_sort(keys.begin(), keys.end());
+
+  vector<string> sortedMessages;
+  sortedMessages.reserve(keys.size());
+  for (const auto &key : keys) {
+      sortedMessages.push_back(key.second);
+    }
+
+  return sortedMessages;
+}
+
+static void
+messagesValues(const vector<string> &msgs, std::map<string, string> &values)
+{
+  for (const auto &msg : msgs) {
+      size_t blankPos = msg.find_first_of(" ");
+      if (blankPos != string::npos) {
+          values[msg.substr(0, blankPos)] = msg.substr(blankPos + 1);
+        }
+      else {
+          values[msg] = string();
+        }
+    }
+}
+
+void
+MessagesComputer::detectCurves(const vector<string> &startMsgs, const vector<string> &endMsgs,
+                               const vector<string> &curvesAddresses,
+                               vector<string> &curvesToAdd, vector<string> &curvesToRemove)
+{
+  std::map<string, string> startValues, endValues;
+  messagesValues(startMsgs, startValues);
+  messagesValues(endMsgs, endValues);
+
+  std::set<string> curves(curvesAddresses.begin(), curvesAddresses.end());
+
+  // a curve for each address at start and end with different values
+  for (const auto &start : startValues) {
+      std::map<string, string>::const_iterator end = endValues.find(start.first);
+      if (end != endValues.end()) {
+          if (curves.find(start.first) == curves.end() && start.second != end->second) {
+              curvesToAdd.push_back(start.first);
+            }
+        }
+      else if (curves.find(start.first) != curves.end()) {
+          curvesToRemove.push_back(start.first);
+        }
+    }
+
+  for (const auto &end : endValues) {
+      if (startValues.find(end.first) == startValues.end() && curves.find(end.first) != curves.end()) {
+          curvesToRemove.push_back(end.first);
+        }
+    }
+}
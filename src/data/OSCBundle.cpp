@@ -0,0 +1,154 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "OSCBundle.hpp"
+
+using std::string;
+using std::vector;
+
+// OSC data is big endian and aligned on 4 bytes
+static void
+appendInt32(vector<char> &data, uint32_t value)
+{
+  data.push_back(value >> 24);
+  data.push_back(value >> 16);
+  data.push_back(value >> 8);
+  data.push_back(value);
+}
+
+static void
+appendString(vector<char> &data, const string &value)
+{
+  data.insert(data.end(), value.begin(), value.end());
+  data.resize(data.size() + 4 - value.size() % 4, '\0');
+}
+
+OSCMessage::OSCMessage(const string &address)
+  : _address(address), _types(",")
+{
+}
+
+void
+OSCMessage::addInt(int32_t value)
+{
+  _types += 'i';
+  appendInt32(_arguments, value);
+}
+
+void
+OSCMessage::addFloat(float value)
+{
+  union { float f; uint32_t i; } bits;
+  bits.f = value;
+
+  _types += 'f';
+  appendInt32(_arguments, bits.i);
+}
+
+void
+OSCMessage::addString(const string &value)
+{
+  _types += 's';
+  appendString(_arguments, value);
+}
+
+vector<char>
+OSCMessage::data() const
+{
+  vector<char> result;
+  result.reserve(_address.size() + _types.size() + _arguments.size() + 8);
+
+  appendString(result, _address);
+  appendString(result, _types);
+  result.insert(result.end(), _arguments.begin(), _arguments.end());
+
+  return result;
+}
+
+OSCBundle::OSCBundle(uint64_t timeTag)
+{
+  clear(timeTag);
+}
+
+uint64_t
+OSCBundle::timeTag(std::chrono::system_clock::time_point date)
+{
+  // from 1900 (NTP) to 1970 (unix time)
+  static const uint64_t NTP_OFFSET = 2208988800ull;
+
+  uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(date.time_since_epoch()).count();
+  uint64_t seconds = micros / 1000000 + NTP_OFFSET;
+  uint64_t fraction = ((micros % 1000000) << 32) / 1000000;
+
+  return (seconds << 32) | fraction;
+}
+
+void
+OSCBundle::clear(uint64_t timeTag)
+{
+  _data.clear();
+  _size = 0;
+
+  appendString(_data, "#bundle");
+  appendInt32(_data, timeTag >> 32);
+  appendInt32(_data, timeTag);
+}
+
+void
+OSCBundle::add(const OSCMessage &message)
+{
+  vector<char> data = message.data();
+
+  appendInt32(_data, data.size());
+  _data.insert(_data.end(), data.begin(), data.end());
+  _size++;
+}
+
+unsigned int
+OSCBundle::size() const
+{
+  return _size;
+}
+
+const vector<char> &
+OSCBundle::data() const
+{
+  return _data;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "ProjectWriter.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <iostream>
+
+const int ProjectWriter::MAX_BACKUPS = 20;
+
+ProjectWriter::ProjectWriter(QObject *parent) : QObject(parent), _success(true)
+{
+}
+
+ProjectWriter::~ProjectWriter()
+{
+  waitForFinished();
+}
+
+void
+ProjectWriter::write(const QByteArray &content, const QString &fileName)
+{
+  // saves are written in order
+  waitForFinished();
+
+  _thread = std::thread(&ProjectWriter::writeProject, this, content, fileName);
+}
+
+bool
+ProjectWriter::waitForFinished()
+{
+  if (_thread.joinable()) {
+      _thread.join();
+    }
+
+  return _success;
+}
+
+void
+ProjectWriter::writeProject(const QByteArray &content, const QString &fileName)
+{
+  backupProject(fileName);
+
+  // QSaveFile writes into a temporary file and renames it on commit
+  QSaveFile project(fileName);
+  _success = project.open(QIODevice::WriteOnly)
+             && project.write(content) == content.size()
+             && project.commit();
+
+  if (!_success) {
+      std::cerr << "ProjectWriter::writeProject : can't write " << fileName.toStdString() << std::endl;
+    }
+
+  emit written(fileName, _success);
+}
+
+void
+ProjectWriter::backupProject(const QString &fileName)
+{
+  QFile project(fileName);
+  if (!project.open(QIODevice::ReadOnly)) {
+      // first save : nothing to keep
+      return;
+    }
+  QByteArray content = project.readAll();
+  project.close();
+
+  QFileInfo projectInfo(fileName);
+  QDir backupsDir(projectInfo.absolutePath());
+  QString backupsFolder = projectInfo.fileName() + ".backups";
+  if (!backupsDir.mkpath(backupsFolder) || !backupsDir.cd(backupsFolder)) {
+      std::cerr << "ProjectWriter::backupProject : can't create " << backupsFolder.toStdString() << std::endl;
+      return;
+    }
+
+  // versions are named after their content : an unchanged project is stored once
+  QString hash = QCryptographicHash::hash(content, QCryptographicHash::Sha1).toHex();
+  QString backupName = backupsDir.filePath(hash + ".score");
+
+  if (!QFile::exists(backupName)) {
+      QSaveFile backup(backupName);
+      if (!backup.open(QIODevice::WriteOnly) || backup.write(content) != content.size() || !backup.commit()) {
+          std::cerr << "ProjectWriter::backupProject : can't write " << backupName.toStdString() << std::endl;
+          return;
+        }
+    }
+
+  // the history tells which version was replaced when
+  QFile history(backupsDir.filePath("history.txt"));
+  if (!history.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+      std::cerr << "ProjectWriter::backupProject : can't write the history of " << fileName.toStdString() << std::endl;
+      return;
+    }
+  QTextStream stream(&history);
+  stream << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << hash << endl;
+  history.close();
+
+  // forget the versions the last entries of the history don't refer to
+  // (a version reused by this save is the last entry : it is always kept)
+  if (!history.open(QIODevice::ReadOnly | QIODevice::Text)) {
+      return;
+    }
+  QStringList entries = QString(history.readAll()).split('\n', QString::SkipEmptyParts);
+  history.close();
+
+  QSet<QString> kept;
+  for (int i = entries.size() - 1; i >= 0 && kept.size() < MAX_BACKUPS; i--) {
+      kept.insert(entries[i].section(' ', 1, 1));
+    }
+
+  QFileInfoList backups = backupsDir.entryInfoList(QStringList("*.score"), QDir::Files);
+  for (int i = 0; i < backups.size(); i++) {
+      if (!kept.contains(backups[i].completeBaseName())) {
+          QFile::remove(backups[i].absoluteFilePath());
+        }
+    }
+}
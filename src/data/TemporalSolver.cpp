@@ -0,0 +1,473 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "TemporalSolver.hpp"
+#include "Engine.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+using std::map;
+using std::pair;
+using std::vector;
+
+const long long TemporalSolver::UNBOUNDED = std::numeric_limits<long long>::max() / 2;
+
+void
+TemporalSolver::clear()
+{
+  _boxes.clear();
+  _relations.clear();
+}
+
+bool
+TemporalSolver::isEmpty() const
+{
+  return _boxes.empty();
+}
+
+void
+TemporalSolver::setBox(unsigned int boxID, unsigned int begin, unsigned int end)
+{
+  Box &box = _boxes[boxID];
+  box.begin = begin;
+  box.end = end;
+}
+
+void
+TemporalSolver::setRelation(unsigned int relID, unsigned int firstBoxID, unsigned int firstControlPoint,
+                            unsigned int secondBoxID, unsigned int secondControlPoint, int minBound, int maxBound)
+{
+  if (_boxes.find(firstBoxID) == _boxes.end() || _boxes.find(secondBoxID) == _boxes.end()) {
+      return;
+    }
+
+  if (_relations.find(relID) == _relations.end()) {
+      _boxes[firstBoxID].relations.push_back(relID);
+      _boxes[secondBoxID].relations.push_back(relID);
+    }
+
+  Relation &relation = _relations[relID];
+  relation.firstBoxID = firstBoxID;
+  relation.firstControlPoint = firstControlPoint;
+  relation.secondBoxID = secondBoxID;
+  relation.secondControlPoint = secondControlPoint;
+
+  setRelationBounds(relID, minBound, maxBound);
+}
+
+bool
+TemporalSolver::setRelationBounds(unsigned int relID, int minBound, int maxBound)
+{
+  map<unsigned int, Relation>::iterator it = _relations.find(relID);
+  if (it == _relations.end()) {
+      return false;
+    }
+
+  // as Engine::changeTemporalRelationBounds : the Engines read a 0 max bound as no max bound
+  it->second.minBound = minBound == NO_BOUND ? 0 : std::abs(minBound);
+  it->second.maxBound = (maxBound == NO_BOUND || maxBound == 0) ? UNBOUNDED : std::abs(maxBound);
+  return true;
+}
+
+void
+TemporalSolver::removeBox(unsigned int boxID)
+{
+  map<unsigned int, Box>::iterator it = _boxes.find(boxID);
+  if (it == _boxes.end()) {
+      return;
+    }
+
+  vector<unsigned int> relations = it->second.relations;
+  for (unsigned int relID : relations) {
+      removeRelation(relID);
+    }
+  _boxes.erase(boxID);
+}
+
+void
+TemporalSolver::removeRelation(unsigned int relID)
+{
+  map<unsigned int, Relation>::iterator it = _relations.find(relID);
+  if (it == _relations.end()) {
+      return;
+    }
+
+  for (unsigned int boxID : {it->second.firstBoxID, it->second.secondBoxID}) {
+      vector<unsigned int> &relations = _boxes[boxID].relations;
+      relations.erase(std::remove(relations.begin(), relations.end(), relID), relations.end());
+    }
+  _relations.erase(it);
+}
+
+bool
+TemporalSolver::moveBox(unsigned int boxID, int begin, int end, vector<unsigned int> &movedBoxes)
+{
+  map<unsigned int, pair<int, int> > dates;
+  dates[boxID] = std::make_pair(begin, end);
+
+  return moveBoxes(dates, movedBoxes);
+}
+
+bool
+TemporalSolver::moveBoxes(const map<unsigned int, pair<int, int> > &dates, vector<unsigned int> &movedBoxes)
+{
+  map<unsigned int, pair<long long, long long> > pinnedBoxes;
+  for (const auto &boxDates : dates) {
+      if (_boxes.find(boxDates.first) == _boxes.end() || boxDates.second.first < 0 || boxDates.second.second < boxDates.second.first) {
+          return false;
+        }
+      pinnedBoxes[boxDates.first] = std::make_pair(boxDates.second.first, boxDates.second.second);
+    }
+
+  return solve(pinnedBoxes, movedBoxes);
+}
+
+bool
+TemporalSolver::changeRelationBounds(unsigned int relID, int minBound, int maxBound, vector<unsigned int> &movedBoxes)
+{
+  return changeRelationBounds(relID, minBound, maxBound, map<unsigned int, pair<int, int> >(), movedBoxes);
+}
+
+bool
+TemporalSolver::changeRelationBounds(unsigned int relID, int minBound, int maxBound,
+                                     const map<unsigned int, pair<int, int> > &dates, vector<unsigned int> &movedBoxes)
+{
+  map<unsigned int, Relation>::iterator it = _relations.find(relID);
+  if (it == _relations.end()) {
+      return false;
+    }
+
+  map<unsigned int, pair<long long, long long> > pinnedBoxes;
+  for (const auto &boxDates : dates) {
+      if (_boxes.find(boxDates.first) == _boxes.end() || boxDates.second.first < 0 || boxDates.second.second < boxDates.second.first) {
+          return false;
+        }
+      pinnedBoxes[boxDates.first] = std::make_pair(boxDates.second.first, boxDates.second.second);
+    }
+
+  // the first box stays where it is
+  if (pinnedBoxes.empty()) {
+      const Box &firstBox = _boxes[it->second.firstBoxID];
+      pinnedBoxes[it->second.firstBoxID] = std::make_pair(firstBox.begin, firstBox.end);
+    }
+  vector<unsigned int> linkedBoxes(1, it->second.firstBoxID);
+
+  Relation previousRelation = it->second;
+  setRelation(relID, previousRelation.firstBoxID, previousRelation.firstControlPoint,
+              previousRelation.secondBoxID, previousRelation.secondControlPoint, minBound, maxBound);
+
+  if (!solve(pinnedBoxes, movedBoxes, linkedBoxes)) {
+      it->second = previousRelation;
+      return false;
+    }
+
+  return true;
+}
+
+bool
+TemporalSolver::boxDates(unsigned int boxID, unsigned int &begin, unsigned int &end) const
+{
+  map<unsigned int, Box>::const_iterator it = _boxes.find(boxID);
+  if (it == _boxes.end()) {
+      return false;
+    }
+
+  begin = it->second.begin;
+  end = it->second.end;
+  return true;
+}
+
+vector<unsigned int>
+TemporalSolver::boxes() const
+{
+  vector<unsigned int> boxesID;
+  for (const auto &box : _boxes) {
+      boxesID.push_back(box.first);
+    }
+
+  return boxesID;
+}
+
+bool
+TemporalSolver::solve(const map<unsigned int, pair<long long, long long> > &pinnedBoxes, vector<unsigned int> &movedBoxes,
+                      const vector<unsigned int> &linkedBoxes)
+{
+  // the boxes linked to the pinned ones, in the order they are reached : the others can't move
+  // node 0 is the date 0, then each box has a node for its begin date followed by one for its end date
+  vector<unsigned int> component;
+  map<unsigned int, unsigned int> beginNodes;
+  for (const auto &pinned : pinnedBoxes) {
+      beginNodes[pinned.first] = 1 + 2 * component.size();
+      component.push_back(pinned.first);
+    }
+  for (unsigned int boxID : linkedBoxes) {
+      if (beginNodes.insert(std::make_pair(boxID, 1 + 2 * component.size())).second) {
+          component.push_back(boxID);
+        }
+    }
+  for (size_t i = 0; i < component.size(); i++) {
+      for (unsigned int relID : _boxes[component[i]].relations) {
+          const Relation &relation = _relations[relID];
+          for (unsigned int boxID : {relation.firstBoxID, relation.secondBoxID}) {
+              if (beginNodes.insert(std::make_pair(boxID, 1 + 2 * component.size())).second) {
+                  component.push_back(boxID);
+                }
+            }
+        }
+    }
+
+  const unsigned int nbNodes = 1 + 2 * component.size();
+  vector<Edge> edges;
+  for (size_t i = 0; i < component.size(); i++) {
+      unsigned int beginNode = 1 + 2 * i, endNode = beginNode + 1;
+      map<unsigned int, pair<long long, long long> >::const_iterator pinned = pinnedBoxes.find(component[i]);
+
+      // no box before 0
+      edges.push_back(Edge{beginNode, 0, 0});
+
+      if (pinned != pinnedBoxes.end()) {
+          edges.push_back(Edge{0, beginNode, pinned->second.first});
+          edges.push_back(Edge{beginNode, 0, -pinned->second.first});
+          edges.push_back(Edge{0, endNode, pinned->second.second});
+          edges.push_back(Edge{endNode, 0, -pinned->second.second});
+        }
+      else {
+          // the other boxes keep their duration
+          const Box &box = _boxes[component[i]];
+          edges.push_back(Edge{beginNode, endNode, box.end - box.begin});
+          edges.push_back(Edge{endNode, beginNode, box.begin - box.end});
+        }
+    }
+  // only the relations of the component : each one is listed by its two boxes, it is taken from its first box
+  for (size_t i = 0; i < component.size(); i++) {
+      for (unsigned int relID : _boxes[component[i]].relations) {
+          const Relation &relation = _relations[relID];
+          if (relation.firstBoxID != component[i]) {
+              continue;
+            }
+          unsigned int firstNode = 1 + 2 * i + (relation.firstControlPoint == BEGIN_CONTROL_POINT_INDEX ? 0 : 1);
+          unsigned int secondNode = beginNodes[relation.secondBoxID] + (relation.secondControlPoint == BEGIN_CONTROL_POINT_INDEX ? 0 : 1);
+
+          if (relation.maxBound < UNBOUNDED) {
+              edges.push_back(Edge{firstNode, secondNode, relation.maxBound});
+            }
+          edges.push_back(Edge{secondNode, firstNode, -relation.minBound});
+        }
+    }
+
+  // the current dates keep all the constraints but the pinned ones : Bellman-Ford only propagates from the pinned boxes
+  // contradictory constraints make a negative cycle
+  vector<long long> potential(nbNodes, 0);
+  for (size_t i = 0; i < component.size(); i++) {
+      const Box &box = _boxes[component[i]];
+      potential[1 + 2 * i] = box.begin;
+      potential[2 + 2 * i] = box.end;
+    }
+  if (!bellmanFord(nbNodes, edges, potential)) {
+      return false;
+    }
+
+  Adjacency forward(nbNodes), backward(nbNodes);
+  for (const Edge &edge : edges) {
+      long long weight = edge.weight + potential[edge.from] - potential[edge.to];
+      forward[edge.from].push_back(std::make_pair(edge.to, weight));
+      backward[edge.to].push_back(std::make_pair(edge.from, weight));
+    }
+
+  // a date is at most its distance from node 0, and at least minus its distance to node 0
+  vector<long long> fromOrigin = distances(forward, potential, 0, false);
+  vector<long long> toOrigin = distances(backward, potential, 0, true);
+
+  vector<pair<long long, long long> > dates(component.size());
+  for (size_t i = 0; i < component.size(); i++) {
+      unsigned int beginNode = 1 + 2 * i;
+      map<unsigned int, pair<long long, long long> >::const_iterator pinned = pinnedBoxes.find(component[i]);
+
+      if (pinned != pinnedBoxes.end()) {
+          dates[i] = pinned->second;
+          continue;
+        }
+
+      const Box &box = _boxes[component[i]];
+      long long lower = -toOrigin[beginNode], upper = fromOrigin[beginNode];
+      if (lower > upper) {
+          return false;
+        }
+      long long begin = std::max(lower, std::min(upper, box.begin));
+      dates[i] = std::make_pair(begin, begin + box.end - box.begin);
+
+      // the box is now pinned too : the dates allowed to the next boxes are narrowed by the paths through it
+      narrow(forward, potential, beginNode, begin, false, fromOrigin);
+      narrow(backward, potential, beginNode, -begin, true, toOrigin);
+    }
+
+  for (size_t i = 0; i < component.size(); i++) {
+      Box &box = _boxes[component[i]];
+      if (box.begin == dates[i].first && box.end == dates[i].second) {
+          continue;
+        }
+      box.begin = dates[i].first;
+      box.end = dates[i].second;
+      if (pinnedBoxes.find(component[i]) == pinnedBoxes.end()) {
+          movedBoxes.push_back(component[i]);
+        }
+    }
+
+  return true;
+}
+
+bool
+TemporalSolver::bellmanFord(unsigned int nbNodes, const vector<Edge> &edges, vector<long long> &potential)
+{
+  vector<vector<const Edge *> > outEdges(nbNodes);
+  for (const Edge &edge : edges) {
+      outEdges[edge.from].push_back(&edge);
+    }
+
+  // as if a virtual node was linked to every node by an edge weighting its starting potential
+  // a shortest path with more edges than nodes goes through a negative cycle
+  vector<unsigned int> pathLength(nbNodes, 1);
+  vector<bool> queued(nbNodes, true);
+  std::deque<unsigned int> queue;
+  for (unsigned int node = 0; node < nbNodes; node++) {
+      queue.push_back(node);
+    }
+
+  while (!queue.empty()) {
+      unsigned int node = queue.front();
+      queue.pop_front();
+      queued[node] = false;
+
+      for (const Edge *edge : outEdges[node]) {
+          if (potential[node] + edge->weight < potential[edge->to]) {
+              potential[edge->to] = potential[node] + edge->weight;
+              pathLength[edge->to] = pathLength[node] + 1;
+              if (pathLength[edge->to] > nbNodes) {
+                  return false;
+                }
+              if (!queued[edge->to]) {
+                  queued[edge->to] = true;
+                  queue.push_back(edge->to);
+                }
+            }
+        }
+    }
+
+  return true;
+}
+
+vector<long long>
+TemporalSolver::distances(const Adjacency &adjacency, const vector<long long> &potential, unsigned int source, bool reversed)
+{
+  typedef pair<long long, unsigned int> QueuedNode;
+  vector<long long> reweighted(adjacency.size(), UNBOUNDED);
+  std::priority_queue<QueuedNode, vector<QueuedNode>, std::greater<QueuedNode> > queue;
+
+  reweighted[source] = 0;
+  queue.push(QueuedNode(0, source));
+  while (!queue.empty()) {
+      QueuedNode current = queue.top();
+      queue.pop();
+      if (current.first > reweighted[current.second]) {
+          continue;
+        }
+      for (const auto &next : adjacency[current.second]) {
+          long long distance = current.first + next.second;
+          if (distance < reweighted[next.first]) {
+              reweighted[next.first] = distance;
+              queue.push(QueuedNode(distance, next.first));
+            }
+        }
+    }
+
+  // back to the weights of the network
+  vector<long long> result(adjacency.size(), UNBOUNDED);
+  for (unsigned int node = 0; node < adjacency.size(); node++) {
+      if (reweighted[node] < UNBOUNDED) {
+          result[node] = reversed ? reweighted[node] - potential[node] + potential[source]
+                                  : reweighted[node] - potential[source] + potential[node];
+        }
+    }
+
+  return result;
+}
+
+void
+TemporalSolver::narrow(const Adjacency &adjacency, const vector<long long> &potential, unsigned int source, long long date,
+                       bool reversed, vector<long long> &bounds)
+{
+  typedef pair<long long, unsigned int> QueuedNode;
+  std::unordered_map<unsigned int, long long> reweighted;
+  std::priority_queue<QueuedNode, vector<QueuedNode>, std::greater<QueuedNode> > queue;
+
+  // Dijkstra from the source, stopped at the nodes whose bound isn't narrowed :
+  // the bounds keep the triangle inequality, so the nodes after them can't be narrowed through them either
+  reweighted[source] = 0;
+  queue.push(QueuedNode(0, source));
+  while (!queue.empty()) {
+      QueuedNode current = queue.top();
+      queue.pop();
+      if (current.first > reweighted[current.second]) {
+          continue;
+        }
+
+      long long distance = reversed ? current.first - potential[current.second] + potential[source]
+                                    : current.first - potential[source] + potential[current.second];
+      if (date + distance >= bounds[current.second]) {
+          continue;
+        }
+      bounds[current.second] = date + distance;
+
+      for (const auto &next : adjacency[current.second]) {
+          long long nextDistance = current.first + next.second;
+          std::unordered_map<unsigned int, long long>::iterator known = reweighted.find(next.first);
+          if (known == reweighted.end() || nextDistance < known->second) {
+              reweighted[next.first] = nextDistance;
+              queue.push(QueuedNode(nextDistance, next.first));
+            }
+        }
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright: LaBRI / SCRIME / L'Arboretum
+ *
+ * Authors: Pascal Baltazar, Nicolas Hincker, Luc Vercellin and Myriam Desainte-Catherine (as of 16/03/2014)
+ *
+ * iscore.contact@gmail.com
+ *
+ * This software is an interactive intermedia sequencer.
+ * It allows the precise and flexible scripting of interactive scenarios.
+ * In contrast to most sequencers, i-score doesn’t produce any media, 
+ * but controls other environments’ parameters, by creating snapshots 
+ * and automations, and organizing them in time in a multi-linear way.
+ * More about i-score on http://www.i-score.org
+ *
+ * This software is governed by the CeCILL license under French law and
+ * abiding by the rules of distribution of free software.  You can  use,
+ * modify and/ or redistribute the software under the terms of the CeCILL
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info".
+ *
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability.
+ *
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or
+ * data to be ensured and,  more generally, to use and operate it in the
+ * same conditions as regards security.
+ *
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL license and that you accept its terms.
+ */
+#include "UndoCommands.hpp"
+
+#include <QObject>
+
+//! Commands with the same id can be merged by the QUndoStack.
+static const int RELATION_BOUNDS_COMMAND_ID = 1;
+
+BoxesMoveCommand::BoxesMoveCommand(const QVector<BoxMoveRecord> &records, QUndoCommand *parent)
+  : QUndoCommand(parent), _records(records), _firstRedo(true)
+{
+  if (_records.size() == 1) {
+      setText(QObject::tr("Move box"));
+    }
+  else {
+      setText(QObject::tr("Move %1 boxes").arg(_records.size()));
+    }
+}
+
+void
+BoxesMoveCommand::undo()
+{
+  QMap<unsigned int, BoxPlacement> placements;
+  for (const BoxMoveRecord &record : _records) {
+      placements[record.boxID] = record.before;
+    }
+
+  Maquette::getInstance()->restoreBoxes(placements);
+}
+
+void
+BoxesMoveCommand::redo()
+{
+  if (_firstRedo) {
+      _firstRedo = false;
+      return;
+    }
+
+  QMap<unsigned int, BoxPlacement> placements;
+  for (const BoxMoveRecord &record : _records) {
+      placements[record.boxID] = record.after;
+    }
+
+  Maquette::getInstance()->restoreBoxes(placements);
+}
+
+RelationBoundsCommand::RelationBoundsCommand(unsigned int relID, int oldMin, int oldMax, int newMin, int newMax, QUndoCommand *parent)
+  : QUndoCommand(parent), _relID(relID), _oldMin(oldMin), _oldMax(oldMax), _newMin(newMin), _newMax(newMax), _firstRedo(true)
+{
+  setText(QObject::tr("Change relation bounds"));
+}
+
+void
+RelationBoundsCommand::undo()
+{
+  Maquette::getInstance()->restoreRelationBounds(_relID, _oldMin, _oldMax);
+}
+
+void
+RelationBoundsCommand::redo()
+{
+  if (_firstRedo) {
+      _firstRedo = false;
+      return;
+    }
+
+  Maquette::getInstance()->restoreRelationBounds(_relID, _newMin, _newMax);
+}
+
+int
+RelationBoundsCommand::id() const
+{
+  return RELATION_BOUNDS_COMMAND_ID;
+}
+
+bool
+RelationBoundsCommand::mergeWith(const QUndoCommand *other)
+{
+  const RelationBoundsCommand *command = static_cast<const RelationBoundsCommand*>(other);
+
+  if (command->_relID != _relID) {
+      return false;
+    }
+
+  _newMin = command->_newMin;
+  _newMax = command->_newMax;
+
+  return true;
+}
+
+BoxMessagesCommand::BoxMessagesCommand(unsigned int boxID, unsigned int controlPoint,
+                                       const QMap<QTreeWidgetItem *, Message> &oldMessages,
+                                       const QMap<QTreeWidgetItem *, Message> &newMessages,
+                                       QUndoCommand *parent)
+  : QUndoCommand(parent), _boxID(boxID), _controlPoint(controlPoint),
+  _oldMessages(messagesByAddress(oldMessages)), _newMessages(messagesByAddress(newMessages)), _firstRedo(true)
+{
+  if (_controlPoint == BEGIN_CONTROL_POINT_INDEX) {
+      setText(QObject::tr("Change start messages"));
+    }
+  else {
+      setText(QObject::tr("Change end messages"));
+    }
+}
+
+void
+BoxMessagesCommand::undo()
+{
+  Maquette::getInstance()->restoreMessages(_boxID, _controlPoint, _oldMessages);
+}
+
+void
+BoxMessagesCommand::redo()
+{
+  if (_firstRedo) {
+      _firstRedo = false;
+      return;
+    }
+
+  Maquette::getInstance()->restoreMessages(_boxID, _controlPoint, _newMessages);
+}
+
+QMap<QString, Message>
+BoxMessagesCommand::messagesByAddress(const QMap<QTreeWidgetItem *, Message> &messages)
+{
+  QMap<QString, Message> addressMessages;
+  for (const Message &message : messages) {
+      addressMessages.insert(message.device + message.message, message);
+    }
+
+  return addressMessages;
+}
@@ -0,0 +1,78 @@
+/*
+ * Headless i-score : plays a project without the graphical interface.
+ *
+ * Transport is controlled over OSC on the OSC_INPUT_PORT of i-score (13580) :
+ *   /Transport/Play, /Transport/Stop, /Transport/Pause, /Transport/Rewind,
+ *   /Transport/StartPoint <ms>, /Transport/Speed <factor>
+ *
+ * With --compiled, the score is compiled into a playback plan until its first trigger point,
+ * and played by a dedicated thread instead of the scenario (Pause and Speed are then ignored).
+ * With --lookahead, the compiled messages of the OSC devices are sent in advance, in time tagged bundles.
+ * With --budget, each device gets at most this many messages by second : the curves sample rates are lowered.
+ * With --tick, the curve samples of an address are coalesced during this time and only the latest is sent.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QTimer>
+#include <iostream>
+
+#include "HeadlessRunner.hpp"
+
+int
+main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  app.setOrganizationName("SCRIME");
+  app.setApplicationName("i-score-headless");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Plays an i-score project without the graphical interface.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("project", "The project file to load.");
+
+  QCommandLineOption playOption(QStringList() << "p" << "play", "Start playing once the project is loaded.");
+  QCommandLineOption quitOption(QStringList() << "q" << "quit-at-end", "Quit when the main scenario ends.");
+  QCommandLineOption printOption("print", "Print the running boxes in the console during execution.");
+  QCommandLineOption jamomaOption("jamoma", "The folder where the jamoma framework is.", "path");
+  QCommandLineOption compiledOption("compiled", "Play a compiled plan of the score (until its first trigger point) instead of the scenario.");
+  parser.addOption(playOption);
+  parser.addOption(quitOption);
+  parser.addOption(printOption);
+  parser.addOption(jamomaOption);
+  QCommandLineOption lookaheadOption("lookahead", "With --compiled, send the messages of the OSC devices this long before their date, in time tagged bundles.", "ms", "0");
+  QCommandLineOption budgetOption("budget", "The messages by second each device accepts (0 for no limit).", "N", "0");
+  QCommandLineOption tickOption("tick", "How long the curve samples are coalesced before being sent.", "ms", "0");
+  parser.addOption(compiledOption);
+  parser.addOption(lookaheadOption);
+  parser.addOption(budgetOption);
+  parser.addOption(tickOption);
+  parser.process(app);
+
+  if (parser.positionalArguments().size() != 1) {
+      parser.showHelp(1);
+    }
+
+  // same lookup as the Maquette : the jamoma framework may be bundled with the application
+  QString jamomaFolder = parser.value(jamomaOption);
+  if (jamomaFolder.isEmpty()) {
+      jamomaFolder = QCoreApplication::applicationDirPath() + "/../Frameworks/jamoma";
+      if (!QDir(jamomaFolder).exists())
+        jamomaFolder = "";
+    }
+
+  HeadlessRunner runner(jamomaFolder, parser.isSet(quitOption), parser.isSet(printOption), parser.isSet(compiledOption));
+
+  if (!runner.load(parser.positionalArguments().first()))
+    return 1;
+
+  runner.setLookahead(parser.value(lookaheadOption).toUInt());
+  runner.setMessageBudget(parser.value(budgetOption).toUInt(), parser.value(tickOption).toUInt());
+
+  if (parser.isSet(playOption))
+    QTimer::singleShot(0, &runner, SLOT(play()));
+
+  return app.exec();
+}